@@ -0,0 +1,678 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "dirlist.h"
+#include "strvec.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifndef LIBCONFIG_WINDOWS_OS
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <stdint.h>
+#include <sys/syscall.h>
+#endif
+
+#ifndef O_DIRECTORY
+#define O_DIRECTORY 0
+#endif
+
+#ifndef O_CLOEXEC
+#define O_CLOEXEC 0
+#endif
+
+#define GETDENTS_BUF_SIZE 65536
+#define NAMES_CHUNK_SIZE 32
+
+static const char *err_bad_include_dir = "cannot read include directory";
+
+/* ------------------------------------------------------------------------- */
+
+/* What identifies a directory's contents at the time it was listed. */
+struct dir_stamp
+{
+  dev_t dev;
+  ino_t ino;
+  off_t size;
+  time_t mtime;
+  long mtime_nsec;
+};
+
+struct dir_listing
+{
+  char *path;
+  struct dir_stamp stamp;
+  int racy; /* modified in the second it was listed; can't be reused */
+  char **names; /* the regular files in the directory, sorted */
+  size_t count;
+  size_t capacity;
+  struct dir_listing *next;
+};
+
+struct config_dir_cache_t
+{
+  struct dir_listing *listings;
+};
+
+/* ------------------------------------------------------------------------- */
+
+static int __is_separator(char c)
+{
+#ifdef LIBCONFIG_WINDOWS_OS
+  return((c == '/') || (c == '\\'));
+#else
+  return(c == '/');
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const char *__last_separator(const char *path)
+{
+  const char *p, *sep = NULL;
+
+  for(p = path; *p; ++p)
+  {
+    if(__is_separator(*p))
+      sep = p;
+  }
+
+  return(sep);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Matches the character c against the bracket expression at p, which starts
+ * with '['. Returns a pointer just past the expression and sets *match, or
+ * returns NULL if the expression is unterminated, in which case the '[' is
+ * an ordinary character.
+ */
+static const char *__match_class(const char *p, unsigned char c, int *match)
+{
+  int negate = 0, found = 0, first = 1;
+  unsigned char lo, hi;
+
+  ++p;
+  if((*p == '!') || (*p == '^'))
+  {
+    negate = 1;
+    ++p;
+  }
+
+  /* A ']' right after the opening bracket is an ordinary character. */
+  while(*p && ((*p != ']') || first))
+  {
+    lo = hi = (unsigned char)*(p++);
+    if((*p == '-') && p[1] && (p[1] != ']'))
+    {
+      hi = (unsigned char)p[1];
+      p += 2;
+    }
+
+    if((c >= lo) && (c <= hi))
+      found = 1;
+
+    first = 0;
+  }
+
+  if(*p != ']')
+    return(NULL);
+
+  *match = (found != negate);
+  return(p + 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Matches a file name against a pattern with the wildcards '*', '?' and
+ * bracket expressions. As in the shell, a leading '.' must be matched
+ * explicitly.
+ */
+static int __glob_match(const char *pattern, const char *name)
+{
+  const char *p = pattern, *s = name, *star_p = NULL, *star_s = NULL, *q;
+  int match;
+
+  if((*name == '.') && (*pattern != '.'))
+    return(0);
+
+  while(*s)
+  {
+    if(*p == '*')
+    {
+      star_p = ++p;
+      star_s = s;
+      continue;
+    }
+
+    if(*p == '?')
+    {
+      ++p;
+      ++s;
+      continue;
+    }
+
+    if((*p == '[') && ((q = __match_class(p, (unsigned char)*s, &match))
+                       != NULL))
+    {
+      if(match)
+      {
+        p = q;
+        ++s;
+        continue;
+      }
+    }
+    else if(*p == *s)
+    {
+      ++p;
+      ++s;
+      continue;
+    }
+
+    /* Backtrack: let the last '*' absorb one more character. */
+    if(! star_p)
+      return(0);
+
+    p = star_p;
+    s = ++star_s;
+  }
+
+  while(*p == '*')
+    ++p;
+
+  return(*p == '\0');
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __listing_add(struct dir_listing *listing, const char *name)
+{
+  if(listing->count == listing->capacity)
+  {
+    listing->capacity += NAMES_CHUNK_SIZE + listing->capacity / 2;
+    listing->names = (char **)libconfig_realloc(
+      listing->names, listing->capacity * sizeof(char *));
+  }
+
+  listing->names[(listing->count)++] = strdup(name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __listing_clear(struct dir_listing *listing)
+{
+  size_t i;
+
+  for(i = 0; i < listing->count; ++i)
+    __delete(listing->names[i]);
+
+  __delete(listing->names);
+  listing->names = NULL;
+  listing->count = listing->capacity = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __listing_delete(struct dir_listing *listing)
+{
+  __listing_clear(listing);
+  __delete(listing->path);
+  __delete(listing);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __stamp_equal(const struct dir_stamp *a, const struct dir_stamp *b)
+{
+  return((a->dev == b->dev) && (a->ino == b->ino) && (a->size == b->size)
+         && (a->mtime == b->mtime) && (a->mtime_nsec == b->mtime_nsec));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __compare_names(const void *a, const void *b)
+{
+  return(strcmp(*(const char * const *)a, *(const char * const *)b));
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef LIBCONFIG_WINDOWS_OS
+
+/* Opens the directory at 'path' and records its stamp. Returns 0 on success,
+ * or an errno value.
+ */
+static int __dir_open(const char *path, int *fd, struct dir_stamp *stamp)
+{
+  struct stat st;
+
+  if(stat(path, &st) != 0)
+    return(errno);
+
+  if(! S_ISDIR(st.st_mode))
+    return(ENOTDIR);
+
+  *fd = -1;
+  memset(stamp, 0, sizeof(*stamp));
+  stamp->size = st.st_size;
+  stamp->mtime = st.st_mtime;
+
+  return(0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __dir_close(int fd)
+{
+  (void)fd;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Lists the regular files in the directory, and closes it. */
+static int __dir_read(int fd, const char *path, struct dir_listing *listing)
+{
+  WIN32_FIND_DATAA data;
+  HANDLE h;
+  char *pattern = (char *)libconfig_malloc(strlen(path) + 3);
+
+  (void)fd;
+
+  strcpy(pattern, path);
+  strcat(pattern, "\\*");
+  h = FindFirstFileA(pattern, &data);
+  __delete(pattern);
+
+  if(h == INVALID_HANDLE_VALUE)
+    return(GetLastError() == ERROR_FILE_NOT_FOUND);
+
+  do
+  {
+    if(! (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      __listing_add(listing, data.cFileName);
+  }
+  while(FindNextFileA(h, &data));
+
+  FindClose(h);
+  return(1);
+}
+
+#else /* ! LIBCONFIG_WINDOWS_OS */
+
+static int __dir_open(const char *path, int *fd, struct dir_stamp *stamp)
+{
+  struct stat st;
+
+  *fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if(*fd < 0)
+    return(errno);
+
+  if(fstat(*fd, &st) != 0)
+  {
+    int err = errno;
+    close(*fd);
+    return(err);
+  }
+
+  if(! S_ISDIR(st.st_mode))
+  {
+    close(*fd);
+    return(ENOTDIR);
+  }
+
+  memset(stamp, 0, sizeof(*stamp));
+  stamp->dev = st.st_dev;
+  stamp->ino = st.st_ino;
+  stamp->size = st.st_size;
+  stamp->mtime = st.st_mtime;
+#if defined(__linux__)
+  stamp->mtime_nsec = st.st_mtim.tv_nsec;
+#elif defined(__APPLE__)
+  stamp->mtime_nsec = st.st_mtimespec.tv_nsec;
+#endif
+
+  return(0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __dir_close(int fd)
+{
+  close(fd);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Adds the entry to the listing if it is a regular file, or a link to one.
+ * Other entries are only stat'ed if the directory doesn't record their type.
+ */
+static void __dir_add_entry(int fd, struct dir_listing *listing,
+                            const char *name, int type)
+{
+  struct stat st;
+
+  if(! strcmp(name, ".") || ! strcmp(name, ".."))
+    return;
+
+#ifdef DT_UNKNOWN
+  if(type == DT_REG)
+  {
+    __listing_add(listing, name);
+    return;
+  }
+
+  if((type != DT_LNK) && (type != DT_UNKNOWN))
+    return;
+#endif
+
+  if((fstatat(fd, name, &st, 0) == 0) && S_ISREG(st.st_mode))
+    __listing_add(listing, name);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef __linux__
+
+struct linux_dirent64
+{
+  uint64_t d_ino;
+  int64_t d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[1];
+};
+
+/* Lists the regular files in the directory, and closes it. Reading the
+ * entries directly, many at a time, avoids the copying done by readdir().
+ */
+static int __dir_read(int fd, const char *path, struct dir_listing *listing)
+{
+  char *buf = (char *)libconfig_malloc(GETDENTS_BUF_SIZE);
+  const struct linux_dirent64 *entry;
+  long n, off;
+  int ok = 1;
+
+  (void)path;
+
+  for(;;)
+  {
+    n = syscall(SYS_getdents64, fd, buf, GETDENTS_BUF_SIZE);
+    if(n <= 0)
+    {
+      ok = (n == 0);
+      break;
+    }
+
+    for(off = 0; off < n; off += entry->d_reclen)
+    {
+      entry = (const struct linux_dirent64 *)(buf + off);
+      __dir_add_entry(fd, listing, entry->d_name, entry->d_type);
+    }
+  }
+
+  __delete(buf);
+  close(fd);
+
+  return(ok);
+}
+
+#else /* ! __linux__ */
+
+static int __dir_read(int fd, const char *path, struct dir_listing *listing)
+{
+  DIR *dp = fdopendir(fd);
+  struct dirent *entry;
+
+  (void)path;
+
+  if(! dp)
+  {
+    close(fd);
+    return(0);
+  }
+
+  while((entry = readdir(dp)) != NULL)
+  {
+#ifdef DT_UNKNOWN
+    __dir_add_entry(dirfd(dp), listing, entry->d_name, entry->d_type);
+#else
+    __dir_add_entry(dirfd(dp), listing, entry->d_name, 0);
+#endif
+  }
+
+  closedir(dp);
+  return(1);
+}
+
+#endif /* __linux__ */
+
+#endif /* LIBCONFIG_WINDOWS_OS */
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the listing of the directory at 'path', from the cache if it is
+ * enabled and the directory has not changed since it was cached. If the
+ * listing is not cached, sets *owned. Returns NULL and sets *err to an errno
+ * value if the directory can't be read.
+ */
+static struct dir_listing *__get_listing(config_t *config, const char *path,
+                                         int *owned, int *err)
+{
+  struct dir_listing *listing = NULL;
+  struct dir_stamp stamp;
+  int fd, use_cache = config_get_option(
+    config, CONFIG_OPTION_CACHE_INCLUDE_LISTINGS);
+  time_t now;
+
+  *owned = 0;
+
+  if((*err = __dir_open(path, &fd, &stamp)) != 0)
+    return(NULL);
+
+  if(use_cache)
+  {
+    if(! config->dir_cache)
+      config->dir_cache = __new(struct config_dir_cache_t);
+
+    for(listing = config->dir_cache->listings; listing;
+        listing = listing->next)
+    {
+      if(! strcmp(listing->path, path))
+        break;
+    }
+
+    if(listing && ! listing->racy && __stamp_equal(&(listing->stamp), &stamp))
+    {
+      __dir_close(fd);
+      return(listing);
+    }
+  }
+
+  if(listing)
+    __listing_clear(listing);
+  else
+  {
+    listing = __new(struct dir_listing);
+    listing->path = strdup(path);
+
+    if(use_cache)
+    {
+      listing->next = config->dir_cache->listings;
+      config->dir_cache->listings = listing;
+    }
+    else
+      *owned = 1;
+  }
+
+  /* A change made later in the same second as the listing might not change
+   * the directory's time stamp, so such a listing is not reused.
+   */
+  now = time(NULL);
+  listing->stamp = stamp;
+  listing->racy = (now <= stamp.mtime);
+
+  if(! __dir_read(fd, path, listing))
+  {
+    __listing_clear(listing);
+    listing->racy = 1;
+    if(*owned)
+      __listing_delete(listing);
+
+    *err = EIO;
+    return(NULL);
+  }
+
+  if(listing->count > 1)
+    qsort(listing->names, listing->count, sizeof(char *), __compare_names);
+
+  return(listing);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int libconfig_is_glob_include(const char *path)
+{
+  const char *sep = __last_separator(path);
+  const char *name = sep ? sep + 1 : path;
+
+  if(sep && ! *name)
+    return(1);
+
+  return(strpbrk(name, "*?[") != NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const char **libconfig_glob_include(config_t *config, const char *include_dir,
+                                    const char *path, const char **error)
+{
+  const char *sep = __last_separator(path);
+  const char *pattern = sep ? sep + 1 : path;
+  size_t dir_len = sep ? (sep == path ? 1 : (size_t)(sep - path)) : 0;
+  size_t prefix_len, i;
+  strvec_t files;
+  struct dir_listing *listing;
+  char *dir, *file;
+  const char **result;
+  int owned, err;
+
+  *error = NULL;
+
+  if(! *pattern) /* a directory */
+    pattern = "*";
+
+  /* The directory to list, and the prefix for the files found in it. */
+  if(include_dir && IS_RELATIVE_PATH(path))
+  {
+    dir = (char *)libconfig_malloc(strlen(include_dir) + dir_len + 2);
+    strcpy(dir, include_dir);
+    if(dir_len > 0)
+    {
+      strcat(dir, FILE_SEPARATOR);
+      strncat(dir, path, dir_len);
+    }
+  }
+  else
+  {
+    dir = (char *)libconfig_malloc(dir_len + 1);
+    memcpy(dir, path, dir_len);
+    dir[dir_len] = '\0';
+  }
+
+  prefix_len = strlen(dir);
+  if((prefix_len > 0) && ! __is_separator(dir[prefix_len - 1]))
+    ++prefix_len;
+
+  listing = __get_listing(config, *dir ? dir : ".", &owned, &err);
+
+  __zero(&files);
+
+  if(listing)
+  {
+    for(i = 0; i < listing->count; ++i)
+    {
+      const char *name = listing->names[i];
+
+      if(! __glob_match(pattern, name))
+        continue;
+
+      file = (char *)libconfig_malloc(prefix_len + strlen(name) + 1);
+      strcpy(file, dir);
+      if(prefix_len > strlen(dir))
+        strcat(file, FILE_SEPARATOR);
+      strcat(file, name);
+      libconfig_strvec_append(&files, file);
+    }
+
+    if(owned)
+      __listing_delete(listing);
+  }
+  else if((err != ENOENT) && (err != ENOTDIR))
+    *error = err_bad_include_dir;
+
+  __delete(dir);
+
+  if(*error)
+  {
+    libconfig_strvec_delete(libconfig_strvec_release(&files));
+    return(NULL);
+  }
+
+  /* A pattern that matches nothing includes nothing. */
+  result = libconfig_strvec_release(&files);
+  if(! result)
+    result = (const char **)libconfig_calloc(1, sizeof(const char *));
+
+  return(result);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_dircache_destroy(struct config_dir_cache_t *cache)
+{
+  struct dir_listing *listing, *next;
+
+  if(! cache)
+    return;
+
+  for(listing = cache->listings; listing; listing = next)
+  {
+    next = listing->next;
+    __listing_delete(listing);
+  }
+
+  __delete(cache);
+}
+
+/* ------------------------------------------------------------------------- */
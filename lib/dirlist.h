@@ -0,0 +1,54 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#ifndef __libconfig_dirlist_h
+#define __libconfig_dirlist_h
+
+#include "libconfig.h"
+
+/*
+ * Wildcard and directory includes, for the default include function when
+ * CONFIG_OPTION_GLOB_INCLUDES is set.
+ */
+
+/*
+ * Returns non-zero if the @include path names more than one file: if its last
+ * component contains a wildcard ('*', '?' or '['), or if it ends with a path
+ * separator.
+ */
+extern int libconfig_is_glob_include(const char *path);
+
+/*
+ * Expands the @include path into the sorted list of regular files in its
+ * directory that match its last component, as for
+ * config_default_include_func(). Directory listings are cached in the
+ * configuration if CONFIG_OPTION_CACHE_INCLUDE_LISTINGS is set.
+ */
+extern const char **libconfig_glob_include(config_t *config,
+                                           const char *include_dir,
+                                           const char *path,
+                                           const char **error);
+
+extern void libconfig_dircache_destroy(struct config_dir_cache_t *cache);
+
+#endif /* __libconfig_dirlist_h */
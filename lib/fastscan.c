@@ -0,0 +1,1088 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#include "fastscan.h"
+#include "parsectx.h"
+#include "grammar.h"
+#include "wincompat.h"
+#include "util.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) \
+  || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define LIBCONFIG_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * The rules implemented here mirror those in scanner.l, and must be kept in
+ * sync with them. In particular, where more than one rule matches, the
+ * longest match wins, and ties go to the rule that appears first in
+ * scanner.l.
+ */
+
+#define STATE_INITIAL             0
+#define STATE_SINGLE_LINE_COMMENT 1
+#define STATE_MULTI_LINE_COMMENT  2
+#define STATE_STRING              3
+#define STATE_INCLUDE             4
+
+#define NUM_NONE  0
+#define NUM_FLOAT 1
+#define NUM_INT   2
+#define NUM_INT64 3
+#define NUM_BIN   4
+#define NUM_OCT   5
+#define NUM_HEX   6
+
+#define READ_CHUNK_SIZE 16384
+
+/* The scanner looks at most this many bytes past the end of a token to decide
+ * where it ends, as in "1e+5" versus "1e+x".
+ */
+#define MAX_LOOKAHEAD 3
+
+#define IS_DIGIT(C) (((C) >= '0') && ((C) <= '9'))
+#define IS_ALPHA(C) ((((C) | 0x20) >= 'a') && (((C) | 0x20) <= 'z'))
+#define IS_XDIGIT(C) (IS_DIGIT(C) || ((((C) | 0x20) >= 'a') \
+                                      && (((C) | 0x20) <= 'f')))
+#define IS_NAME_START(C) (IS_ALPHA(C) || ((C) == '*'))
+#define IS_NAME_CHAR(C) (IS_NAME_START(C) || IS_DIGIT(C) \
+                         || ((C) == '-') || ((C) == '_'))
+
+/* ------------------------------------------------------------------------- */
+
+static int __count_newlines(const char *p, const char *end)
+{
+  int n = 0;
+
+#ifdef LIBCONFIG_SSE2
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  __m128i sum = zero;
+
+  for(; (end - p) >= 16; p += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(v, newline), one);
+    sum = _mm_add_epi64(sum, _mm_sad_epu8(hits, zero));
+  }
+
+  n = _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#endif
+
+  for(; p < end; ++p)
+    n += (*p == '\n');
+
+  return(n);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns a pointer to the first '"' or '\\' in [p, end), or end if there is
+ * none, and adds the number of newlines skipped over to *lines.
+ */
+static const char *__find_string_delim(const char *p, const char *end,
+                                       int *lines)
+{
+#ifdef LIBCONFIG_SSE2
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i newline = _mm_set1_epi8('\n');
+
+  for(; (end - p) >= 16; p += 16)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)p);
+    int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                              _mm_cmpeq_epi8(v, backslash)));
+    if(mask)
+      break; /* finish this block below */
+
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, newline));
+    for(; mask; mask &= mask - 1)
+      ++*lines;
+  }
+#endif
+
+  for(; p < end; ++p)
+  {
+    if((*p == '"') || (*p == '\\'))
+      break;
+
+    if(*p == '\n')
+      ++*lines;
+  }
+
+  return(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static struct fastscan_buffer *__buffer_create(const char *str, size_t len,
+                                               char *storage)
+{
+  struct fastscan_buffer *buf = __new(struct fastscan_buffer);
+
+  buf->start = buf->pos = str;
+  buf->end = str + len;
+  buf->storage = storage;
+  buf->lineno = 1;
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static struct fastscan_buffer *__buffer_from_stream(FILE *stream)
+{
+  size_t capacity = READ_CHUNK_SIZE, len = 0, n;
+  char *data = (char *)libconfig_malloc(capacity);
+
+  while((n = fread(data + len, 1, capacity - len, stream)) > 0)
+  {
+    len += n;
+    if(len == capacity)
+    {
+      capacity *= 2;
+      data = (char *)libconfig_realloc(data, capacity);
+    }
+  }
+
+  return(__buffer_create(data, len, data));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __buffer_delete(struct fastscan *scanner,
+                            struct fastscan_buffer *buf)
+{
+  if(buf)
+  {
+    scanner->ctx->bytes_scanned += (size_t)(buf->pos - buf->start);
+    __delete(buf->storage);
+    __delete(buf);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __set_text(struct fastscan *scanner, const char *p, size_t len)
+{
+  scanner->text.length = 0;
+  libconfig_strbuf_append_chars(&(scanner->text), p, len);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Compares len characters of s against the lowercase word w, ignoring case. */
+static int __equals_nocase(const char *s, const char *w, size_t len)
+{
+  for(; len > 0; --len, ++s, ++w)
+  {
+    if((*s | 0x20) != *w)
+      return(0);
+  }
+
+  return(1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const char *__scan_exponent(const char *p, const char *end)
+{
+  const char *q = p;
+
+  if((q < end) && ((*q == 'e') || (*q == 'E')))
+  {
+    ++q;
+    if((q < end) && ((*q == '-') || (*q == '+')))
+      ++q;
+
+    if((q < end) && IS_DIGIT(*q))
+    {
+      while((q < end) && IS_DIGIT(*q))
+        ++q;
+
+      return(q);
+    }
+  }
+
+  return(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const char *__scan_long_suffix(const char *p, const char *end)
+{
+  if((p < end) && (*p == 'L'))
+  {
+    ++p;
+    if((p < end) && (*p == 'L'))
+      ++p;
+  }
+
+  return(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Matches the {float}, {integer}, {integer64}, {bin}, {oct} and {hex}
+ * patterns at p, returning the length of the longest match (or 0) and
+ * storing its kind in *kind.
+ */
+static size_t __scan_number(const char *p, const char *end, int *kind)
+{
+  const char *q = p, *digits;
+  size_t len = 0;
+
+  *kind = NUM_NONE;
+
+  if((*q == '-') || (*q == '+'))
+    ++q;
+
+  digits = q;
+  while((q < end) && IS_DIGIT(*q))
+    ++q;
+
+  if((q < end) && (*q == '.'))
+  {
+    const char *r = q + 1;
+
+    while((r < end) && IS_DIGIT(*r))
+      ++r;
+
+    r = __scan_exponent(r, end);
+    len = (size_t)(r - p);
+    *kind = NUM_FLOAT;
+  }
+  else if(q > digits)
+  {
+    const char *r = __scan_exponent(q, end);
+
+    if(r > q)
+    {
+      len = (size_t)(r - p);
+      *kind = NUM_FLOAT;
+    }
+    else
+    {
+      r = __scan_long_suffix(q, end);
+      len = (size_t)(r - p);
+      *kind = (r > q) ? NUM_INT64 : NUM_INT;
+    }
+  }
+
+  if((*p == '0') && ((p + 1) < end))
+  {
+    int base = 0, max_digits = 0, radix_kind = NUM_NONE, n = 0;
+    const char *r = p + 2;
+
+    switch(p[1])
+    {
+      case 'b': case 'B':
+        base = 2;
+        max_digits = 64;
+        radix_kind = NUM_BIN;
+        break;
+
+      case 'o': case 'O': case 'q': case 'Q':
+        base = 8;
+        max_digits = 21;
+        radix_kind = NUM_OCT;
+        break;
+
+      case 'x': case 'X':
+        base = 16;
+        max_digits = 16;
+        radix_kind = NUM_HEX;
+        break;
+
+      default:
+        break;
+    }
+
+    while(base && (r < end) && (n < max_digits)
+          && (((base == 2) && ((*r == '0') || (*r == '1')))
+              || ((base == 8) && (*r >= '0') && (*r <= '7'))
+              || ((base == 16) && IS_XDIGIT(*r))))
+    {
+      ++r;
+      ++n;
+    }
+
+    if(n > 0)
+    {
+      r = __scan_long_suffix(r, end);
+      if((size_t)(r - p) > len)
+      {
+        len = (size_t)(r - p);
+        *kind = radix_kind;
+      }
+    }
+  }
+
+  return(len);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Matches the {include_open} pattern at p, which must be at the beginning of
+ * a line. Returns the length of the match, or 0; in the latter case, sets
+ * *incomplete if the input ended before the pattern could be ruled out.
+ */
+static size_t __match_include(const char *p, const char *end,
+                              int *incomplete)
+{
+  static const char directive[] = "@include";
+  const size_t directive_len = sizeof(directive) - 1;
+  const char *q = p, *r;
+
+  *incomplete = 0;
+
+  while((q < end) && ((*q == ' ') || (*q == '\t')))
+    ++q;
+
+  if((size_t)(end - q) < directive_len)
+  {
+    *incomplete = !memcmp(q, directive, (size_t)(end - q));
+    return(0);
+  }
+
+  if(memcmp(q, directive, directive_len))
+    return(0);
+
+  q += directive_len;
+  r = q;
+
+  while((q < end) && ((*q == ' ') || (*q == '\t')))
+    ++q;
+
+  if(q == end)
+  {
+    *incomplete = 1;
+    return(0);
+  }
+
+  if((q == r) || (*q != '"'))
+    return(0);
+
+  return((size_t)(q + 1 - p));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __number_token(struct fastscan *scanner, union YYSTYPE *lval,
+                          int kind)
+{
+  const char *text = scanner->text.string;
+  long long llval;
+  int is_long, base = 10;
+
+  switch(kind)
+  {
+    case NUM_FLOAT:
+      lval->fval = libconfig_parse_double(text);
+      return(TOK_FLOAT);
+
+    case NUM_INT64:
+      if(!libconfig_parse_integer(text, 10, &(lval->llval), &is_long))
+        return(TOK_ERROR);
+
+      return(TOK_INTEGER64);
+
+    case NUM_BIN:
+      base = 2;
+      break;
+
+    case NUM_OCT:
+      base = 8;
+      break;
+
+    case NUM_HEX:
+      base = 16;
+      break;
+
+    default:
+      break;
+  }
+
+  if(!libconfig_parse_integer((base == 10) ? text : text + 2, base, &llval,
+                              &is_long))
+    return(TOK_ERROR);
+
+  if(is_long)
+  {
+    lval->llval = llval;
+    switch(kind)
+    {
+      case NUM_BIN: return(TOK_BIN64);
+      case NUM_OCT: return(TOK_OCT64);
+      case NUM_HEX: return(TOK_HEX64);
+      default:      return(TOK_INTEGER64);
+    }
+  }
+  else
+  {
+    lval->ival = (int)llval;
+    switch(kind)
+    {
+      case NUM_BIN: return(TOK_BIN);
+      case NUM_OCT: return(TOK_OCT);
+      case NUM_HEX: return(TOK_HEX);
+      default:      return(TOK_INTEGER);
+    }
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __set_error(struct fastscan *scanner, const char *error)
+{
+  config_t *config = scanner->ctx->config;
+
+  config->error_text = error;
+  config->error_file = libconfig_scanctx_current_filename(scanner->ctx);
+  config->error_line = scanner->buffer->lineno;
+  scanner->failed = 1;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* In push mode, records the current position in the top-level buffer as the
+ * point to rewind to if the input runs out.
+ */
+static void __mark(struct fastscan *scanner)
+{
+  if(scanner->partial && (scanner->ctx->stack_depth == 0))
+  {
+    scanner->mark.pos = scanner->buffer->pos;
+    scanner->mark.lineno = scanner->buffer->lineno;
+    scanner->mark.state = scanner->state;
+    scanner->mark.string_len = scanner->ctx->string.length;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __rewind(struct fastscan *scanner)
+{
+  strbuf_t *string = &(scanner->ctx->string);
+
+  scanner->buffer->pos = scanner->mark.pos;
+  scanner->buffer->lineno = scanner->mark.lineno;
+  scanner->state = scanner->mark.state;
+
+  if(string->length > scanner->mark.string_len)
+  {
+    string->length = scanner->mark.string_len;
+    string->string[string->length] = '\0';
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Handles the end of the current buffer, as the <<EOF>> rule does. Returns
+ * -1 if scanning should continue in a new buffer, otherwise the token to
+ * return.
+ */
+static int __end_of_buffer(struct fastscan *scanner)
+{
+  const char *error = NULL;
+  struct fastscan_buffer *buf;
+  char *data;
+  size_t len;
+
+  if(scanner->partial && (scanner->ctx->stack_depth == 0))
+    return(FASTSCAN_MORE);
+
+  data = libconfig_scanctx_next_include_file(scanner->ctx, &len, &error);
+  if(data)
+  {
+    __buffer_delete(scanner, scanner->buffer);
+    scanner->buffer = __buffer_create(data, len, data);
+    return(-1);
+  }
+  else if(error)
+  {
+    __set_error(scanner, error);
+    return(TOK_ERROR);
+  }
+
+  /* No more files in the current include list. */
+  buf = (struct fastscan_buffer *)libconfig_scanctx_pop_include(scanner->ctx);
+  if(buf)
+  {
+    __buffer_delete(scanner, scanner->buffer);
+    scanner->buffer = buf;
+    __mark(scanner); /* the include can't be undone */
+    return(-1);
+  }
+
+  return(0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Handles the closing quote of an @include directive. Returns -1 if scanning
+ * should continue, otherwise the token to return.
+ */
+static int __include(struct fastscan *scanner)
+{
+  const char *error = NULL;
+  const char *path = libconfig_scanctx_take_string(scanner->ctx);
+  size_t len;
+  char *data = libconfig_scanctx_push_include(scanner->ctx,
+                                              (void *)scanner->buffer, path,
+                                              &len, &error);
+  __delete(path);
+
+  scanner->state = STATE_INITIAL;
+
+  if(data)
+    scanner->buffer = __buffer_create(data, len, data);
+  else if(error)
+  {
+    __set_error(scanner, error);
+    return(TOK_ERROR);
+  }
+  else
+    __mark(scanner); /* the include can't be undone */
+
+  return(-1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_init(struct fastscan *scanner,
+                             struct scan_context *ctx)
+{
+  __zero(scanner);
+  scanner->ctx = ctx;
+  ctx->fast = scanner;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_cleanup(struct fastscan *scanner)
+{
+  struct fastscan_buffer *buf;
+
+  /* Unwind the include stack, if the parse was aborted. */
+  while((buf = (struct fastscan_buffer *)libconfig_scanctx_pop_include(
+           scanner->ctx)) != NULL)
+    __buffer_delete(scanner, buf);
+
+  __buffer_delete(scanner, scanner->buffer);
+  __delete(libconfig_strbuf_release(&(scanner->text)));
+  scanner->ctx->fast = NULL;
+  __zero(scanner);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_set_stream(struct fastscan *scanner, FILE *stream)
+{
+  __buffer_delete(scanner, scanner->buffer);
+  scanner->buffer = __buffer_from_stream(stream);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_set_string(struct fastscan *scanner, const char *str,
+                                   size_t len)
+{
+  __buffer_delete(scanner, scanner->buffer);
+  scanner->buffer = __buffer_create(str, len, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_set_partial(struct fastscan *scanner)
+{
+  __buffer_delete(scanner, scanner->buffer);
+  scanner->capacity = READ_CHUNK_SIZE;
+  scanner->buffer = __buffer_create(NULL, 0, (char *)libconfig_malloc(
+                                      scanner->capacity));
+  scanner->buffer->start = scanner->buffer->pos = scanner->buffer->end
+    = scanner->buffer->storage;
+  scanner->partial = 1;
+  scanner->retry_len = 0;
+  __mark(scanner);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_append(struct fastscan *scanner, const char *data,
+                               size_t len)
+{
+  struct fastscan_buffer *buf = scanner->buffer;
+  size_t discard, used;
+
+  /* Input is only appended after the scanner has run out of it, at which
+   * point it has rewound to the start of a token in the top-level buffer.
+   * Everything before that, except for the last byte, which tells whether
+   * the token is at the beginning of a line, can be discarded.
+   */
+  discard = (buf->pos > buf->storage) ? (size_t)(buf->pos - buf->storage) - 1
+    : 0;
+  used = (size_t)(buf->end - buf->storage) - discard;
+
+  if(discard >= used)
+  {
+    scanner->ctx->bytes_scanned += discard;
+    memmove(buf->storage, buf->storage + discard, used);
+    buf->pos -= discard;
+    buf->end -= discard;
+    buf->start = buf->storage;
+    scanner->mark.pos -= discard;
+    discard = 0;
+  }
+
+  if(used + discard + len > scanner->capacity)
+  {
+    char *storage = buf->storage;
+
+    while(used + discard + len > scanner->capacity)
+      scanner->capacity *= 2;
+
+    buf->storage = (char *)libconfig_realloc(storage, scanner->capacity);
+    buf->start = buf->storage + (buf->start - storage);
+    buf->pos = buf->storage + (buf->pos - storage);
+    buf->end = buf->storage + (buf->end - storage);
+    scanner->mark.pos = buf->storage + (scanner->mark.pos - storage);
+  }
+
+  memcpy((char *)buf->end, data, len);
+  buf->end += len;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_end_input(struct fastscan *scanner)
+{
+  scanner->partial = 0;
+  scanner->retry_len = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int libconfig_fastscan_lineno(const struct fastscan *scanner)
+{
+  return(scanner->buffer ? scanner->buffer->lineno : 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_set_lineno(struct fastscan *scanner, int lineno)
+{
+  if(scanner->buffer)
+    scanner->buffer->lineno = lineno;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_fastscan_token_span(const struct fastscan *scanner,
+                                   size_t *start, size_t *end)
+{
+  const struct fastscan_buffer *buf = scanner->buffer;
+
+  if(! buf)
+  {
+    *start = *end = 0;
+    return;
+  }
+
+  *end = (size_t)(buf->pos - buf->start);
+
+  /* The end of the input, or a token from a buffer that has been left. */
+  if(! scanner->token || (scanner->token < buf->start)
+     || (scanner->token > buf->pos))
+    *start = *end;
+  else
+    *start = (size_t)(scanner->token - buf->start);
+}
+
+/* ------------------------------------------------------------------------- */
+
+size_t libconfig_fastscan_consumed(const struct fastscan *scanner)
+{
+  const struct fastscan_buffer *buf = scanner->buffer;
+
+  /* While an included file is being scanned, the top-level buffer is saved
+   * in the bottom frame of the include stack.
+   */
+  if(scanner->ctx->stack_depth > 0)
+    buf = (const struct fastscan_buffer *)
+      scanner->ctx->include_stack[0].parent_buffer;
+
+  return(buf ? (size_t)(buf->pos - buf->start) : 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __lex(union YYSTYPE *lval, struct fastscan *scanner)
+{
+  for(;;)
+  {
+    struct fastscan_buffer *buf = scanner->buffer;
+    const char *p = buf->pos;
+    const char *end = buf->end;
+    const char *q;
+    int r;
+
+    if(p == end)
+    {
+      if((r = __end_of_buffer(scanner)) != -1)
+        return(r);
+
+      continue;
+    }
+
+    switch(scanner->state)
+    {
+      case STATE_SINGLE_LINE_COMMENT:
+        q = (const char *)memchr(p, '\n', (size_t)(end - p));
+        if(q)
+        {
+          ++(buf->lineno);
+          scanner->state = STATE_INITIAL;
+          buf->pos = q + 1;
+        }
+        else
+          buf->pos = end;
+
+        continue;
+
+      case STATE_MULTI_LINE_COMMENT:
+        q = (const char *)memchr(p, '*', (size_t)(end - p));
+        if(! q)
+          q = end;
+        else if(((q + 1) < end) && (q[1] == '/'))
+        {
+          buf->lineno += __count_newlines(p, q);
+          scanner->state = STATE_INITIAL;
+          buf->pos = q + 2;
+          continue;
+        }
+        else
+          ++q;
+
+        buf->lineno += __count_newlines(p, q);
+        buf->pos = q;
+        continue;
+
+      case STATE_STRING:
+        q = __find_string_delim(p, end, &(buf->lineno));
+        if(q > p)
+          libconfig_scanctx_append_chars(scanner->ctx, p, (size_t)(q - p));
+
+        p = q;
+        if(p == end)
+        {
+          buf->pos = p;
+          continue;
+        }
+
+        if(*p == '"')
+        {
+          buf->pos = p + 1;
+          scanner->state = STATE_INITIAL;
+          lval->sval = libconfig_scanctx_take_string(scanner->ctx);
+          return(TOK_STRING);
+        }
+
+        /* Backslash escape. */
+        if((p + 1) < end)
+        {
+          char c = 0;
+
+          switch(p[1])
+          {
+            case 'a':  c = '\a'; break;
+            case 'b':  c = '\b'; break;
+            case 'n':  c = '\n'; break;
+            case 'r':  c = '\r'; break;
+            case 't':  c = '\t'; break;
+            case 'v':  c = '\v'; break;
+            case 'f':  c = '\f'; break;
+            case '\\': c = '\\'; break;
+            case '"':  c = '"';  break;
+
+            case 'x': case 'X':
+              if(((p + 3) < end) && IS_XDIGIT(p[2]) && IS_XDIGIT(p[3]))
+              {
+                char hex[3] = { p[2], p[3], '\0' };
+                libconfig_scanctx_append_char(
+                  scanner->ctx, (char)(strtol(hex, NULL, 16) & 0xFF));
+                buf->pos = p + 4;
+                continue;
+              }
+              break;
+
+            default:
+              break;
+          }
+
+          if(c)
+          {
+            libconfig_scanctx_append_char(scanner->ctx, c);
+            buf->pos = p + 2;
+            continue;
+          }
+        }
+
+        /* A backslash that doesn't start a recognized escape sequence. */
+        libconfig_scanctx_append_char(scanner->ctx, '\\');
+        buf->pos = p + 1;
+        continue;
+
+      case STATE_INCLUDE:
+        for(q = p; (q < end) && (*q != '"') && (*q != '\\'); ++q)
+          buf->lineno += (*q == '\n');
+
+        if(q > p)
+          libconfig_scanctx_append_chars(scanner->ctx, p, (size_t)(q - p));
+
+        p = q;
+        if(p == end)
+        {
+          buf->pos = p;
+          continue;
+        }
+
+        if(*p == '"')
+        {
+          buf->pos = p + 1;
+          if((r = __include(scanner)) != -1)
+            return(r);
+
+          continue;
+        }
+
+        if(((p + 1) < end) && ((p[1] == '\\') || (p[1] == '"')))
+        {
+          libconfig_scanctx_append_char(scanner->ctx, p[1]);
+          buf->pos = p + 2;
+        }
+        else
+          buf->pos = p + 1; /* unmatched; discarded */
+
+        continue;
+
+      case STATE_INITIAL:
+      default:
+        break;
+    }
+
+    /* INITIAL state. */
+
+    if(((p == buf->start) || (p[-1] == '\n'))
+       && ((*p == ' ') || (*p == '\t') || (*p == '@')))
+    {
+      int incomplete;
+      size_t len = __match_include(p, end, &incomplete);
+      if(len > 0)
+      {
+        buf->pos = p + len;
+        scanner->state = STATE_INCLUDE;
+        continue;
+      }
+
+      if(incomplete && scanner->partial && (scanner->ctx->stack_depth == 0))
+        return(FASTSCAN_MORE);
+    }
+
+    scanner->token = p;
+
+    switch(*p)
+    {
+      case '#':
+        buf->pos = p + 1;
+        scanner->state = STATE_SINGLE_LINE_COMMENT;
+        continue;
+
+      case '/':
+        if(((p + 1) < end) && (p[1] == '/'))
+        {
+          buf->pos = p + 2;
+          scanner->state = STATE_SINGLE_LINE_COMMENT;
+          continue;
+        }
+        else if(((p + 1) < end) && (p[1] == '*'))
+        {
+          buf->pos = p + 2;
+          scanner->state = STATE_MULTI_LINE_COMMENT;
+          continue;
+        }
+
+        buf->pos = p + 1;
+        return(TOK_GARBAGE);
+
+      case '"':
+        buf->pos = p + 1;
+        scanner->state = STATE_STRING;
+        continue;
+
+      case '\n':
+        ++(buf->lineno);
+        /* fall through */
+
+      case '\r': case '\f': case '\a': case '\b': case '\v':
+        buf->pos = p + 1;
+        continue;
+
+      case ' ': case '\t':
+        for(++p; (p < end) && ((*p == ' ') || (*p == '\t')); ++p) ;
+        buf->pos = p;
+        continue;
+
+      case '=': case ':':
+        buf->pos = p + 1;
+        return(TOK_EQUALS);
+
+      case ',':
+        buf->pos = p + 1;
+        return(TOK_COMMA);
+
+      case '{':
+        buf->pos = p + 1;
+        return(TOK_GROUP_START);
+
+      case '}':
+        buf->pos = p + 1;
+        return(TOK_GROUP_END);
+
+      case '[':
+        buf->pos = p + 1;
+        return(TOK_ARRAY_START);
+
+      case ']':
+        buf->pos = p + 1;
+        return(TOK_ARRAY_END);
+
+      case '(':
+        buf->pos = p + 1;
+        return(TOK_LIST_START);
+
+      case ')':
+        buf->pos = p + 1;
+        return(TOK_LIST_END);
+
+      case ';':
+        buf->pos = p + 1;
+        return(TOK_SEMICOLON);
+
+      default:
+        break;
+    }
+
+    if(IS_NAME_START(*p))
+    {
+      size_t len;
+
+      for(q = p + 1; (q < end) && IS_NAME_CHAR(*q); ++q) ;
+      len = (size_t)(q - p);
+      buf->pos = q;
+
+      if((len == 4) && __equals_nocase(p, "true", 4))
+      {
+        lval->ival = 1;
+        return(TOK_BOOLEAN);
+      }
+      else if((len == 5) && __equals_nocase(p, "false", 5))
+      {
+        lval->ival = 0;
+        return(TOK_BOOLEAN);
+      }
+
+      __set_text(scanner, p, len);
+      lval->sval = scanner->text.string;
+      return(TOK_NAME);
+    }
+
+    if(IS_DIGIT(*p) || (*p == '-') || (*p == '+') || (*p == '.'))
+    {
+      int kind;
+      size_t len = __scan_number(p, end, &kind);
+
+      if(len > 0)
+      {
+        __set_text(scanner, p, len);
+        buf->pos = p + len;
+        return(__number_token(scanner, lval, kind));
+      }
+    }
+
+    buf->pos = p + 1;
+    return(TOK_GARBAGE);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+int libconfig_fastscan_lex(union YYSTYPE *lval, struct fastscan *scanner)
+{
+  struct fastscan_buffer *buf;
+  int token;
+
+  if(! scanner->partial)
+    return(__lex(lval, scanner));
+
+  /* Rescanning an incomplete token each time a little more input arrives
+   * would take quadratic time, so wait until the unscanned input has doubled.
+   */
+  buf = scanner->buffer;
+  if(scanner->ctx->stack_depth == 0)
+  {
+    if((size_t)(buf->end - buf->pos) < scanner->retry_len)
+      return(FASTSCAN_MORE);
+
+    __mark(scanner);
+  }
+
+  token = __lex(lval, scanner);
+
+  /* A token that ends too close to the end of the input may be the prefix of
+   * a longer one. String tokens end at their closing quote, and errors that
+   * have been reported can't be taken back.
+   */
+  buf = scanner->buffer;
+  if((token > 0) && (token != TOK_STRING) && ! scanner->failed
+     && (scanner->ctx->stack_depth == 0)
+     && ((size_t)(buf->end - buf->pos) < MAX_LOOKAHEAD))
+    token = FASTSCAN_MORE;
+
+  if(token == FASTSCAN_MORE)
+  {
+    __rewind(scanner);
+    scanner->retry_len = (size_t)(buf->end - buf->pos) * 2 + 1;
+  }
+  else
+    scanner->retry_len = 0;
+
+  return(token);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#ifndef __libconfig_fastscan_h
+#define __libconfig_fastscan_h
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "scanctx.h"
+#include "strbuf.h"
+
+/*
+ * A hand-written replacement for the flex scanner in scanner.l. It produces
+ * exactly the same token stream for grammar.y, but scans input that is held
+ * entirely in memory, which lets it use vectorized searches for string
+ * delimiters, newlines and comment terminators.
+ */
+
+struct fastscan_buffer
+{
+  const char *start;
+  const char *pos;
+  const char *end;
+  char *storage; /* owned copy of the input, if it was read from a stream */
+  int lineno;
+};
+
+/*
+ * In push mode, the point to rewind to if the input runs out before the next
+ * token is complete.
+ */
+struct fastscan_mark
+{
+  const char *pos;
+  int lineno;
+  int state;
+  size_t string_len;
+};
+
+struct fastscan
+{
+  struct scan_context *ctx;
+  struct fastscan_buffer *buffer;
+  int state;
+  int failed; /* an error has been reported through the config */
+  const char *token; /* start of the last token, in the current buffer */
+  strbuf_t text; /* NUL-terminated copy of the current token's text */
+  /* Push mode, in which the top-level buffer grows as input arrives. */
+  int partial; /* more input may follow the top-level buffer */
+  size_t capacity; /* of the top-level buffer's storage */
+  size_t retry_len; /* unscanned input needed before trying again */
+  struct fastscan_mark mark;
+};
+
+/* Returned by libconfig_fastscan_lex() in push mode when the next token
+ * cannot be scanned until more input has been appended.
+ */
+#define FASTSCAN_MORE (-2)
+
+union YYSTYPE; /* fwd decl */
+
+/*
+ * Initializes the scanner and attaches it to the scan context, so that the
+ * parser will pull its tokens from it rather than from the flex scanner.
+ */
+extern void libconfig_fastscan_init(struct fastscan *scanner,
+                                    struct scan_context *ctx);
+extern void libconfig_fastscan_cleanup(struct fastscan *scanner);
+
+/*
+ * Sets the top-level input. A stream is read into memory in its entirety; a
+ * string is scanned in place and must remain valid until the parse is done.
+ */
+extern void libconfig_fastscan_set_stream(struct fastscan *scanner,
+                                          FILE *stream);
+extern void libconfig_fastscan_set_string(struct fastscan *scanner,
+                                          const char *str, size_t len);
+
+/*
+ * Puts the scanner in push mode, with an empty top-level input to which
+ * input is appended as it arrives, until the end of the input is signaled.
+ */
+extern void libconfig_fastscan_set_partial(struct fastscan *scanner);
+extern void libconfig_fastscan_append(struct fastscan *scanner,
+                                      const char *data, size_t len);
+extern void libconfig_fastscan_end_input(struct fastscan *scanner);
+
+extern int libconfig_fastscan_lex(union YYSTYPE *lval,
+                                  struct fastscan *scanner);
+
+extern int libconfig_fastscan_lineno(const struct fastscan *scanner);
+
+/*
+ * Sets the number of the current line of the top-level input, which is
+ * scanned from line 1 by default.
+ */
+extern void libconfig_fastscan_set_lineno(struct fastscan *scanner,
+                                          int lineno);
+
+/*
+ * Returns the offsets of the start and end of the last token returned, in the
+ * buffer it was scanned from.
+ */
+extern void libconfig_fastscan_token_span(const struct fastscan *scanner,
+                                          size_t *start, size_t *end);
+
+/*
+ * Returns the number of bytes of the top-level input scanned so far.
+ */
+extern size_t libconfig_fastscan_consumed(const struct fastscan *scanner);
+
+#endif /* __libconfig_fastscan_h */
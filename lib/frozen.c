@@ -0,0 +1,385 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "frozen.h"
+#include "strbuf.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Paths longer than this are left out of the table, along with the paths
+ * of all the settings below them.
+ */
+#define FROZEN_MAX_PATH 256
+
+/* The average number of keys per bucket. */
+#define FROZEN_BUCKET_KEYS 4
+
+/* A displacement with this bit set gives the slot directly. */
+#define FROZEN_DIRECT 0x80000000U
+
+#define FROZEN_MAX_DISPLACEMENT (1U << 20)
+
+/* ------------------------------------------------------------------------- */
+
+struct frozen_slot
+{
+  config_setting_t *setting;
+  size_t offset; /* of the path in the pool */
+  size_t length;
+};
+
+/*
+ * The keys are hashed into buckets, and each bucket has a displacement that,
+ * mixed into the hashes of its keys, sends them to distinct free slots
+ * ("hash and displace"). There are as many slots as keys.
+ */
+struct config_frozen_t
+{
+  unsigned int num_slots;
+  unsigned int num_buckets;
+  unsigned int *displacements;
+  struct frozen_slot *slots;
+  char *pool;
+};
+
+struct frozen_key
+{
+  unsigned long long hash;
+  unsigned int bucket;
+  struct frozen_slot slot;
+};
+
+/* The state of the walk that collects the paths. */
+struct frozen_builder
+{
+  char path[FROZEN_MAX_PATH + 1];
+  size_t lengths[FROZEN_MAX_PATH / 2 + 2]; /* of the path at each depth */
+  unsigned int indices[FROZEN_MAX_PATH / 2 + 2]; /* of the next element */
+  strbuf_t pool;
+  struct frozen_key *keys;
+  unsigned int num_keys;
+  unsigned int capacity;
+};
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned long long __frozen_mix(unsigned long long h)
+{
+  h ^= h >> 31;
+  h *= 0x7FB5D329728EA185ULL;
+  h ^= h >> 27;
+  h *= 0x81DADEF4BC2DD44DULL;
+  h ^= h >> 33;
+
+  return(h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned long long __frozen_hash(const char *s, size_t len)
+{
+  unsigned long long h = 0x9E3779B97F4A7C15ULL ^ len, w;
+
+  for(; len >= sizeof(w); s += sizeof(w), len -= sizeof(w))
+  {
+    memcpy(&w, s, sizeof(w));
+    h = __frozen_mix(h ^ w);
+  }
+
+  if(len > 0)
+  {
+    w = 0;
+    memcpy(&w, s, len);
+    h = __frozen_mix(h ^ w);
+  }
+
+  return(h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned int __frozen_slot(unsigned long long hash,
+                                  unsigned int displacement,
+                                  unsigned int num_slots)
+{
+  if(displacement & FROZEN_DIRECT)
+    return(displacement & ~FROZEN_DIRECT);
+
+  return((unsigned int)(__frozen_mix(hash ^ (displacement
+                                             * 0xC2B2AE3D27D4EB4FULL))
+                        % num_slots));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __frozen_collect(config_setting_t *setting, unsigned int depth,
+                            void *user)
+{
+  struct frozen_builder *builder = (struct frozen_builder *)user;
+  size_t len;
+
+  if(depth > 0)
+  {
+    char elem[16];
+    const char *name = setting->name;
+    size_t name_len;
+
+    len = builder->lengths[depth - 1];
+
+    if(setting->parent->type != CONFIG_TYPE_GROUP)
+    {
+      sprintf(elem, "[%u]", builder->indices[depth]++);
+      name = elem;
+    }
+
+    name_len = strlen(name);
+    if(len + (len > 0) + name_len > FROZEN_MAX_PATH)
+      return(CONFIG_WALK_SKIP);
+
+    if(len > 0)
+      builder->path[len++] = '.';
+
+    memcpy(builder->path + len, name, name_len);
+    len += name_len;
+
+    if(builder->num_keys == builder->capacity)
+    {
+      builder->capacity = builder->capacity ? builder->capacity * 2 : 64;
+      builder->keys = (struct frozen_key *)libconfig_realloc(
+        builder->keys, builder->capacity * sizeof(struct frozen_key));
+    }
+
+    builder->keys[builder->num_keys].hash = __frozen_hash(builder->path,
+                                                          len);
+    builder->keys[builder->num_keys].slot.setting = setting;
+    builder->keys[builder->num_keys].slot.offset = builder->pool.length;
+    builder->keys[builder->num_keys].slot.length = len;
+    ++(builder->num_keys);
+
+    libconfig_strbuf_append_chars(&(builder->pool), builder->path, len);
+  }
+  else
+    len = 0;
+
+  builder->lengths[depth] = len;
+  builder->indices[depth + 1] = 0;
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Finds a displacement for each bucket, starting with the largest buckets,
+ * while there is the most room for them. Once only buckets with a single key
+ * are left, each is given a free slot directly.
+ */
+static int __frozen_place(struct config_frozen_t *frozen,
+                          struct frozen_key *keys, unsigned int num_keys)
+{
+  unsigned int *starts, *order, *sizes, *placed;
+  unsigned char *taken;
+  unsigned int i, b, next_free = 0, max_size = 0;
+  int ok = CONFIG_TRUE;
+
+  starts = (unsigned int *)libconfig_calloc(frozen->num_buckets + 1,
+                                            sizeof(unsigned int));
+  order = (unsigned int *)libconfig_malloc(num_keys * sizeof(unsigned int));
+  taken = (unsigned char *)libconfig_calloc(frozen->num_slots, 1);
+  placed = (unsigned int *)libconfig_malloc(num_keys * sizeof(unsigned int));
+
+  /* Sort the keys by bucket. */
+  for(i = 0; i < num_keys; ++i)
+    ++starts[keys[i].bucket + 1];
+
+  for(b = 0; b < frozen->num_buckets; ++b)
+  {
+    if(starts[b + 1] > max_size)
+      max_size = starts[b + 1];
+
+    starts[b + 1] += starts[b];
+  }
+
+  sizes = (unsigned int *)libconfig_calloc(frozen->num_buckets,
+                                           sizeof(unsigned int));
+  for(i = 0; i < num_keys; ++i)
+    order[starts[keys[i].bucket] + sizes[keys[i].bucket]++] = i;
+
+  for(; (max_size > 0) && ok; --max_size)
+  {
+    for(b = 0; (b < frozen->num_buckets) && ok; ++b)
+    {
+      unsigned int d, n = sizes[b];
+      const unsigned int *members = order + starts[b];
+
+      if(n != max_size)
+        continue;
+
+      if(n == 1)
+      {
+        while(taken[next_free])
+          ++next_free;
+
+        taken[next_free] = 1;
+        frozen->displacements[b] = FROZEN_DIRECT | next_free;
+        placed[members[0]] = next_free;
+        continue;
+      }
+
+      for(d = 0; d < FROZEN_MAX_DISPLACEMENT; ++d)
+      {
+        unsigned int j;
+
+        for(j = 0; j < n; ++j)
+        {
+          unsigned int slot = __frozen_slot(keys[members[j]].hash, d,
+                                            frozen->num_slots);
+
+          if(taken[slot])
+            break;
+
+          taken[slot] = 1;
+          placed[members[j]] = slot;
+        }
+
+        if(j == n)
+          break;
+
+        /* Free the slots taken so far, and try the next displacement. */
+        while(j-- > 0)
+          taken[placed[members[j]]] = 0;
+      }
+
+      if(d == FROZEN_MAX_DISPLACEMENT)
+        ok = CONFIG_FALSE;
+      else
+        frozen->displacements[b] = d;
+    }
+  }
+
+  if(ok)
+  {
+    for(i = 0; i < num_keys; ++i)
+      frozen->slots[placed[i]] = keys[i].slot;
+  }
+
+  __delete(starts);
+  __delete(order);
+  __delete(sizes);
+  __delete(taken);
+  __delete(placed);
+
+  return(ok);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Builds the table for all of the settings in the configuration whose paths
+ * aren't too long. Returns NULL if no perfect hash could be found.
+ */
+static struct config_frozen_t *__frozen_build(const config_t *config)
+{
+  struct frozen_builder *builder = __new(struct frozen_builder);
+  struct config_frozen_t *frozen = __new(struct config_frozen_t);
+  unsigned int i;
+
+  config_walk(config->root, __frozen_collect, NULL, builder);
+
+  frozen->num_slots = builder->num_keys;
+  frozen->num_buckets = (builder->num_keys + FROZEN_BUCKET_KEYS - 1)
+    / FROZEN_BUCKET_KEYS;
+  frozen->displacements = (unsigned int *)libconfig_calloc(
+    frozen->num_buckets + 1, sizeof(unsigned int));
+  frozen->slots = (struct frozen_slot *)libconfig_calloc(
+    frozen->num_slots + 1, sizeof(struct frozen_slot));
+  frozen->pool = libconfig_strbuf_release(&(builder->pool));
+
+  for(i = 0; i < builder->num_keys; ++i)
+    builder->keys[i].bucket = (unsigned int)(builder->keys[i].hash
+                                             % frozen->num_buckets);
+
+  if((builder->num_keys > 0)
+     && ! __frozen_place(frozen, builder->keys, builder->num_keys))
+  {
+    libconfig_frozen_destroy(frozen);
+    frozen = NULL;
+  }
+
+  __delete(builder->keys);
+  __delete(builder);
+
+  return(frozen);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_freeze(config_t *config)
+{
+  if(! config)
+    return(CONFIG_FALSE);
+
+  libconfig_frozen_destroy(config->frozen);
+  config->frozen = __frozen_build(config);
+
+  return(config->frozen ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_frozen_destroy(struct config_frozen_t *frozen)
+{
+  if(! frozen)
+    return;
+
+  __delete(frozen->displacements);
+  __delete(frozen->slots);
+  __delete(frozen->pool);
+  __delete(frozen);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *libconfig_frozen_lookup(
+  const struct config_frozen_t *frozen, const char *path, size_t len)
+{
+  unsigned long long hash;
+  const struct frozen_slot *slot;
+
+  if(frozen->num_slots == 0)
+    return(NULL);
+
+  hash = __frozen_hash(path, len);
+  slot = frozen->slots
+    + __frozen_slot(hash, frozen->displacements[hash % frozen->num_buckets],
+                    frozen->num_slots);
+
+  if((slot->length == len) && !memcmp(frozen->pool + slot->offset, path, len))
+    return(slot->setting);
+
+  return(NULL);
+}
+
+/* ------------------------------------------------------------------------- */
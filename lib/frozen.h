@@ -0,0 +1,48 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#ifndef __libconfig_frozen_h
+#define __libconfig_frozen_h
+
+#include <stddef.h>
+
+#include "libconfig.h"
+
+/*
+ * A table of the settings of a configuration that won't change, by their
+ * full paths, such as "servers.[0].port". The paths are mapped to the table
+ * with a minimal perfect hash, so that looking one up takes a single probe
+ * and a comparison.
+ */
+
+/* The table is built by config_freeze(). */
+extern void libconfig_frozen_destroy(struct config_frozen_t *frozen);
+
+/*
+ * Returns the setting with the given full path, or NULL if the table
+ * doesn't have it; it may then still be found by walking the path.
+ */
+extern config_setting_t *libconfig_frozen_lookup(
+  const struct config_frozen_t *frozen, const char *path, size_t len);
+
+#endif /* __libconfig_frozen_h */
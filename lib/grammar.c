@@ -58,7 +58,7 @@
 #define YYPURE 1
 
 /* Push parsers.  */
-#define YYPUSH 0
+#define YYPUSH 1
 
 /* Pull parsers.  */
 #define YYPULL 1
@@ -66,13 +66,19 @@
 
 /* Substitute the variable and function names.  */
 #define yyparse         libconfig_yyparse
+#define yypush_parse    libconfig_yypush_parse
+#define yypull_parse    libconfig_yypull_parse
+#define yypstate_new    libconfig_yypstate_new
+#define yypstate_clear  libconfig_yypstate_clear
+#define yypstate_delete libconfig_yypstate_delete
+#define yypstate        libconfig_yypstate
 #define yylex           libconfig_yylex
 #define yyerror         libconfig_yyerror
 #define yydebug         libconfig_yydebug
 #define yynerrs         libconfig_yynerrs
 
 /* First part of user prologue.  */
-#line 32 "grammar.y"
+#line 47 "grammar.y"
 
 #include <string.h>
 #include <stdlib.h>
@@ -80,6 +86,7 @@
 #include "libconfig.h"
 #include "parsectx.h"
 #include "scanctx.h"
+#include "fastscan.h"
 #include "util.h"
 #include "wincompat.h"
 
@@ -97,26 +104,25 @@ static const char *err_duplicate_setting = "duplicate setting name";
 #define IN_LIST() \
   (ctx->parent && (ctx->parent->type == CONFIG_TYPE_LIST))
 
+/* Tokens come from the hand-written scanner if one is attached to the scan
+ * context, and from the flex scanner otherwise.
+ */
+#define SCANNER_LINENO() \
+  (scan_ctx->fast ? libconfig_fastscan_lineno(scan_ctx->fast) \
+   : libconfig_yyget_lineno(scanner))
+
 static void capture_parse_pos(void *scanner, struct scan_context *scan_ctx,
                               config_setting_t *setting)
 {
-  setting->line = (unsigned int)libconfig_yyget_lineno(scanner);
+  setting->line = (unsigned int)SCANNER_LINENO();
   setting->file = libconfig_scanctx_current_filename(scan_ctx);
 }
 
 #define CAPTURE_PARSE_POS(S) \
   capture_parse_pos(scanner, scan_ctx, (S))
 
-void libconfig_yyerror(void *scanner, struct parse_context *ctx,
-                       struct scan_context *scan_ctx, char const *s)
-{
-  if(ctx->config->error_text) return;
-  ctx->config->error_line = libconfig_yyget_lineno(scanner);
-  ctx->config->error_text = s;
-}
 
-
-#line 120 "grammar.c"
+#line 126 "grammar.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -150,6 +156,19 @@ void libconfig_yyerror(void *scanner, struct parse_context *ctx,
 #if YYDEBUG
 extern int libconfig_yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 36 "grammar.y"
+
+#include <stddef.h>
+
+/* Byte offsets of the start and end of a symbol in the top-level input. */
+struct parse_location
+{
+  size_t first;
+  size_t last;
+};
+
+#line 172 "grammar.c"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -221,14 +240,14 @@ extern int libconfig_yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 77 "grammar.y"
+#line 92 "grammar.y"
 
   int ival;
   long long llval;
   double fval;
   char *sval;
 
-#line 232 "grammar.c"
+#line 251 "grammar.c"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -236,10 +255,26 @@ typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+/* Location type.  */
+typedef struct parse_location YYLTYPE;
+
+
+
+
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
 
+typedef struct libconfig_yypstate libconfig_yypstate;
 
 
 int libconfig_yyparse (void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+int libconfig_yypush_parse (libconfig_yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, YYLTYPE *pushed_loc, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+int libconfig_yypull_parse (libconfig_yypstate *ps, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+libconfig_yypstate *libconfig_yypstate_new (void);
+void libconfig_yypstate_delete (libconfig_yypstate *ps);
 
 
 #endif /* !YY_LIBCONFIG_YY_GRAMMAR_H_INCLUDED  */
@@ -299,12 +334,68 @@ typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 /* Second part of user prologue.  */
-#line 84 "grammar.y"
+#line 99 "grammar.y"
+
+/* An empty symbol is located at the end of the one before it. */
+#define YYLLOC_DEFAULT(C, R, N)                   \
+  do                                              \
+  {                                               \
+    if(N)                                         \
+    {                                             \
+      (C).first = YYRHSLOC(R, 1).first;           \
+      (C).last = YYRHSLOC(R, N).last;             \
+    }                                             \
+    else                                          \
+      (C).first = (C).last = YYRHSLOC(R, 0).last; \
+  } while(0)
+
+void libconfig_yyerror(struct parse_location *loc, void *scanner,
+                       struct parse_context *ctx,
+                       struct scan_context *scan_ctx, char const *s)
+{
+  if(ctx->config->error_text) return;
+  ctx->config->error_line = SCANNER_LINENO();
+  ctx->config->error_text = s;
+}
 
 /* These declarations are provided to suppress compiler warnings. */
 extern int libconfig_yylex(YYSTYPE *, void *);
 
-#line 308 "grammar.c"
+static int scan_token(YYSTYPE *lval, struct parse_location *loc,
+                      void *scanner, struct scan_context *scan_ctx, int spans)
+{
+  int token;
+  unsigned long long start = 0;
+
+  if(scan_ctx->timing)
+    start = libconfig_time_ns();
+
+  if(scan_ctx->fast)
+    token = libconfig_fastscan_lex(lval, scan_ctx->fast);
+  else
+    token = libconfig_yylex(lval, scanner);
+
+  /* Token offsets are only needed when recording a source map. */
+  if(spans && scan_ctx->fast)
+    libconfig_fastscan_token_span(scan_ctx->fast, &(loc->first),
+                                  &(loc->last));
+  else
+    loc->first = loc->last = 0;
+
+  if(scan_ctx->timing)
+    scan_ctx->scan_ns += libconfig_time_ns() - start;
+
+  if(token > 0)
+    ++(scan_ctx->tokens);
+
+  return(token);
+}
+
+#undef yylex
+#define yylex(L, P, S) scan_token((L), (P), (S), scan_ctx, \
+                                  ctx->srcmap != NULL)
+
+#line 399 "grammar.c"
 
 
 #ifdef short
@@ -502,30 +593,6 @@ typedef int yy_state_fast_t;
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
-# ifdef YYSTACK_USE_ALLOCA
-#  if YYSTACK_USE_ALLOCA
-#   ifdef __GNUC__
-#    define YYSTACK_ALLOC __builtin_alloca
-#   elif defined __BUILTIN_VA_ARG_INCR
-#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
-#   elif defined _AIX
-#    define YYSTACK_ALLOC __alloca
-#   elif defined _MSC_VER
-#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
-#    define alloca _alloca
-#   else
-#    define YYSTACK_ALLOC alloca
-#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
-#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
-      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
-#     ifndef EXIT_SUCCESS
-#      define EXIT_SUCCESS 0
-#     endif
-#    endif
-#   endif
-#  endif
-# endif
-
 # ifdef YYSTACK_ALLOC
    /* Pacify GCC's 'empty if-body' warning.  */
 #  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
@@ -567,13 +634,15 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
   yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
@@ -582,8 +651,9 @@ union yyalloc
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
-      + YYSTACK_GAP_MAXIMUM)
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
 
@@ -689,11 +759,11 @@ static const yytype_int8 yytranslate[] =
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,    99,    99,   101,   105,   106,   109,   111,   114,   116,
-     117,   122,   121,   141,   140,   164,   163,   186,   187,   188,
-     189,   193,   194,   198,   218,   240,   262,   284,   306,   328,
-     350,   372,   394,   412,   440,   441,   442,   445,   447,   451,
-     452,   453,   456,   458,   463,   462
+       0,   170,   170,   172,   176,   177,   180,   182,   185,   187,
+     188,   193,   192,   223,   222,   252,   251,   280,   281,   282,
+     283,   287,   288,   292,   315,   340,   365,   390,   415,   440,
+     465,   490,   515,   536,   567,   568,   572,   578,   580,   584,
+     585,   589,   595,   597,   602,   601
 };
 #endif
 
@@ -859,7 +929,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (scanner, ctx, scan_ctx, YY_("syntax error: cannot back up")); \
+        yyerror (&yylloc, scanner, ctx, scan_ctx, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -868,6 +938,32 @@ enum { YYENOMEM = -2 };
    Use YYerror or YYUNDEF. */
 #define YYERRCODE YYUNDEF
 
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -884,6 +980,63 @@ do {                                            \
 } while (0)
 
 
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
 # define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
@@ -892,7 +1045,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value, scanner, ctx, scan_ctx); \
+                  Kind, Value, Location, scanner, ctx, scan_ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -904,10 +1057,11 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (yylocationp);
   YY_USE (scanner);
   YY_USE (ctx);
   YY_USE (scan_ctx);
@@ -925,12 +1079,14 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep, scanner, ctx, scan_ctx);
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, scanner, ctx, scan_ctx);
   YYFPRINTF (yyo, ")");
 }
 
@@ -963,7 +1119,7 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
                  int yyrule, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
 {
   int yylno = yyrline[yyrule];
@@ -977,7 +1133,8 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)], scanner, ctx, scan_ctx);
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), scanner, ctx, scan_ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -985,7 +1142,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule, scanner, ctx, scan_ctx); \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule, scanner, ctx, scan_ctx); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -1014,6 +1171,40 @@ int yydebug;
 #ifndef YYMAXDEPTH
 # define YYMAXDEPTH 10000
 #endif
+/* Parser data structure.  */
+struct yypstate
+  {
+    /* Number of syntax errors so far.  */
+    int yynerrs;
+
+    yy_state_fast_t yystate;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+    yy_state_t *yyssp;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+    YYSTYPE *yyvsp;
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls;
+    YYLTYPE *yylsp;
+    /* Whether this instance has not started parsing yet.
+     * If 2, it corresponds to a finished parsing.  */
+    int yynew;
+  };
 
 
 
@@ -1026,9 +1217,10 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
 {
   YY_USE (yyvaluep);
+  YY_USE (yylocationp);
   YY_USE (scanner);
   YY_USE (ctx);
   YY_USE (scan_ctx);
@@ -1040,9 +1232,9 @@ yydestruct (const char *yymsg,
   switch (yykind)
     {
     case YYSYMBOL_TOK_STRING: /* TOK_STRING  */
-#line 95 "grammar.y"
+#line 166 "grammar.y"
             { free(((*yyvaluep).sval)); }
-#line 1046 "grammar.c"
+#line 1238 "grammar.c"
         break;
 
       default:
@@ -1055,13 +1247,117 @@ yydestruct (const char *yymsg,
 
 
 
+int
+yyparse (void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+{
+  yypstate *yyps = yypstate_new ();
+  if (!yyps)
+    {
+      static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+      YYLTYPE yylloc = yyloc_default;
+      yyerror (&yylloc, scanner, ctx, scan_ctx, YY_("memory exhausted"));
+      return 2;
+    }
+  int yystatus = yypull_parse (yyps, scanner, ctx, scan_ctx);
+  yypstate_delete (yyps);
+  return yystatus;
+}
+
+int
+yypull_parse (yypstate *yyps, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+{
+  YY_ASSERT (yyps);
+  static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+  YYLTYPE yylloc = yyloc_default;
+  int yystatus;
+  do {
+    YYSTYPE yylval;
+    int yychar = yylex (&yylval, &yylloc, scanner);
+    yystatus = yypush_parse (yyps, yychar, &yylval, &yylloc, scanner, ctx, scan_ctx);
+  } while (yystatus == YYPUSH_MORE);
+  return yystatus;
+}
+
+#define libconfig_yynerrs yyps->libconfig_yynerrs
+#define yystate yyps->yystate
+#define yyerrstatus yyps->yyerrstatus
+#define yyssa yyps->yyssa
+#define yyss yyps->yyss
+#define yyssp yyps->yyssp
+#define yyvsa yyps->yyvsa
+#define yyvs yyps->yyvs
+#define yyvsp yyps->yyvsp
+#define yylsa yyps->yylsa
+#define yyls yyps->yyls
+#define yylsp yyps->yylsp
+#define yystacksize yyps->yystacksize
+
+/* Initialize the parser data structure.  */
+static void
+yypstate_clear (yypstate *yyps)
+{
+  yynerrs = 0;
+  yystate = 0;
+  yyerrstatus = 0;
+
+  yyssp = yyss;
+  yyvsp = yyvs;
+  yylsp = yyls;
+
+  /* Initialize the state stack, in case yypcontext_expected_tokens is
+     called before the first call to yyparse. */
+  *yyssp = 0;
+  yyps->yynew = 1;
+}
+
+/* Initialize the parser data structure.  */
+yypstate *
+yypstate_new (void)
+{
+  yypstate *yyps;
+  yyps = YY_CAST (yypstate *, YYMALLOC (sizeof *yyps));
+  if (!yyps)
+    return YY_NULLPTR;
+  yystacksize = YYINITDEPTH;
+  yyss = yyssa;
+  yyvs = yyvsa;
+  yyls = yylsa;
+  yypstate_clear (yyps);
+  return yyps;
+}
+
+void
+yypstate_delete (yypstate *yyps)
+{
+  if (yyps)
+    {
+#ifndef yyoverflow
+      /* If the stack was reallocated but the parse did not complete, then the
+         stack still needs to be freed.  */
+      if (yyss != yyssa)
+        YYSTACK_FREE (yyss);
+#endif
+      YYFREE (yyps);
+    }
+}
+
+
 
-/*----------.
-| yyparse.  |
-`----------*/
+/*---------------.
+| yypush_parse.  |
+`---------------*/
 
 int
-yyparse (void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
+yypush_parse (yypstate *yyps,
+              int yypushed_char, YYSTYPE const *yypushed_val, YYLTYPE *yypushed_loc, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx)
 {
 /* Lookahead token kind.  */
 int yychar;
@@ -1073,28 +1369,13 @@ int yychar;
 YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
 YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 
-    /* Number of syntax errors so far.  */
-    int yynerrs = 0;
-
-    yy_state_fast_t yystate = 0;
-    /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus = 0;
-
-    /* Refer to the stacks through separate pointers, to allow yyoverflow
-       to reallocate them elsewhere.  */
-
-    /* Their size.  */
-    YYPTRDIFF_T yystacksize = YYINITDEPTH;
-
-    /* The state stack: array, bottom, top.  */
-    yy_state_t yyssa[YYINITDEPTH];
-    yy_state_t *yyss = yyssa;
-    yy_state_t *yyssp = yyss;
-
-    /* The semantic value stack: array, bottom, top.  */
-    YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs = yyvsa;
-    YYSTYPE *yyvsp = yyvs;
+/* Location data for the lookahead symbol.  */
+static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+YYLTYPE yylloc = yyloc_default;
 
   int yyn;
   /* The return value of yyparse.  */
@@ -1104,19 +1385,38 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
+  YYLTYPE yyloc;
 
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
 
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
+  switch (yyps->yynew)
+    {
+    case 0:
+      yyn = yypact[yystate];
+      goto yyread_pushed_token;
+
+    case 2:
+      yypstate_clear (yyps);
+      break;
+
+    default:
+      break;
+    }
+
   YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
+  yylsp[0] = *yypushed_loc;
   goto yysetstate;
 
 
@@ -1155,6 +1455,7 @@ yysetstate:
            memory.  */
         yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
@@ -1163,9 +1464,11 @@ yysetstate:
         yyoverflow (YY_("memory exhausted"),
                     &yyss1, yysize * YYSIZEOF (*yyssp),
                     &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
@@ -1184,6 +1487,7 @@ yysetstate:
           YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
 #  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
@@ -1192,6 +1496,7 @@ yysetstate:
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
 
       YY_IGNORE_USELESS_CAST_BEGIN
       YYDPRINTF ((stderr, "Stack size increased to %ld\n",
@@ -1227,8 +1532,20 @@ yybackup:
   /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
+      if (!yyps->yynew)
+        {
+          YYDPRINTF ((stderr, "Return for a new token:\n"));
+          yyresult = YYPUSH_MORE;
+          goto yypushreturn;
+        }
+      yyps->yynew = 0;
+yyread_pushed_token:
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex (&yylval, scanner);
+      yychar = yypushed_char;
+      if (yypushed_val)
+        yylval = *yypushed_val;
+      if (yypushed_loc)
+        yylloc = *yypushed_loc;
     }
 
   if (yychar <= YYEOF)
@@ -1245,6 +1562,7 @@ yybackup:
          loop in error recovery. */
       yychar = YYUNDEF;
       yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
       goto yyerrlab1;
     }
   else
@@ -1278,6 +1596,7 @@ yybackup:
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
 
   /* Discard the shifted token.  */
   yychar = YYEMPTY;
@@ -1311,96 +1630,126 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
   case 11: /* $@1: %empty  */
-#line 122 "grammar.y"
+#line 193 "grammar.y"
   {
-    ctx->setting = config_setting_add(ctx->parent, (yyvsp[0].sval), CONFIG_TYPE_NONE);
+    ctx->setting = libconfig_parsectx_add_member(ctx, (yyvsp[0].sval));
 
     if(ctx->setting == NULL)
     {
-      libconfig_yyerror(scanner, ctx, scan_ctx, err_duplicate_setting);
+      libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_duplicate_setting);
       YYABORT;
     }
     else
     {
       CAPTURE_PARSE_POS(ctx->setting);
+      libconfig_parsectx_begin_span(ctx, ctx->setting, (yylsp[0]).first);
     }
   }
-#line 1334 "grammar.c"
+#line 1656 "grammar.c"
+    break;
+
+  case 12: /* setting: TOK_NAME $@1 TOK_EQUALS value setting_terminator  */
+#line 209 "grammar.y"
+  {
+    libconfig_parsectx_end_member(ctx);
+
+    /* A scalar merged into the member it overrides leaves none to count. */
+    if(ctx->setting)
+      libconfig_parsectx_count(ctx, ctx->setting);
+
+    libconfig_parsectx_end_span(ctx, ctx->setting, (yylsp[-1]).first, (yylsp[-1]).last,
+                                (yylsp[0]).last);
+  }
+#line 1671 "grammar.c"
     break;
 
   case 13: /* $@2: %empty  */
-#line 141 "grammar.y"
+#line 223 "grammar.y"
   {
     if(IN_LIST())
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_ARRAY);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, (yylsp[0]).first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_ARRAY;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_ARRAY);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, (yylsp[0]).first, (yylsp[0]).last);
   }
-#line 1352 "grammar.c"
+#line 1692 "grammar.c"
     break;
 
   case 14: /* array: TOK_ARRAY_START $@2 simple_value_list_optional TOK_ARRAY_END  */
-#line 156 "grammar.y"
+#line 241 "grammar.y"
   {
+    libconfig_parsectx_close_span(ctx, ctx->parent, (yylsp[0]).last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
-#line 1361 "grammar.c"
+#line 1704 "grammar.c"
     break;
 
   case 15: /* $@3: %empty  */
-#line 164 "grammar.y"
+#line 252 "grammar.y"
   {
     if(IN_LIST())
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_LIST);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, (yylsp[0]).first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_LIST;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_LIST);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, (yylsp[0]).first, (yylsp[0]).last);
   }
-#line 1379 "grammar.c"
+#line 1725 "grammar.c"
     break;
 
   case 16: /* list: TOK_LIST_START $@3 value_list_optional TOK_LIST_END  */
-#line 179 "grammar.y"
+#line 270 "grammar.y"
   {
+    libconfig_parsectx_close_span(ctx, ctx->parent, (yylsp[0]).last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
-#line 1388 "grammar.c"
+#line 1737 "grammar.c"
     break;
 
   case 21: /* string: TOK_STRING  */
-#line 193 "grammar.y"
+#line 287 "grammar.y"
              { libconfig_parsectx_append_string(ctx, (yyvsp[0].sval)); free((yyvsp[0].sval)); }
-#line 1394 "grammar.c"
+#line 1743 "grammar.c"
     break;
 
   case 22: /* string: string TOK_STRING  */
-#line 194 "grammar.y"
+#line 288 "grammar.y"
                       { libconfig_parsectx_append_string(ctx, (yyvsp[0].sval)); free((yyvsp[0].sval)); }
-#line 1400 "grammar.c"
+#line 1749 "grammar.c"
     break;
 
   case 23: /* simple_value: TOK_BOOLEAN  */
-#line 199 "grammar.y"
+#line 293 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
@@ -1409,35 +1758,41 @@ yyreduce:
 
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
       config_setting_set_bool(ctx->setting, (int)(yyvsp[0].ival));
   }
-#line 1424 "grammar.c"
+#line 1776 "grammar.c"
     break;
 
   case 24: /* simple_value: TOK_INTEGER  */
-#line 219 "grammar.y"
+#line 316 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, (yyvsp[0].ival));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_DEFAULT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1446,24 +1801,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_DEFAULT);
     }
   }
-#line 1450 "grammar.c"
+#line 1805 "grammar.c"
     break;
 
   case 25: /* simple_value: TOK_INTEGER64  */
-#line 241 "grammar.y"
+#line 341 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, (yyvsp[0].llval));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_DEFAULT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1472,24 +1830,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_DEFAULT);
     }
   }
-#line 1476 "grammar.c"
+#line 1834 "grammar.c"
     break;
 
   case 26: /* simple_value: TOK_HEX  */
-#line 263 "grammar.y"
+#line 366 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, (yyvsp[0].ival));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_HEX);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1498,24 +1859,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_HEX);
     }
   }
-#line 1502 "grammar.c"
+#line 1863 "grammar.c"
     break;
 
   case 27: /* simple_value: TOK_HEX64  */
-#line 285 "grammar.y"
+#line 391 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, (yyvsp[0].llval));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_HEX);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1524,24 +1888,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_HEX);
     }
   }
-#line 1528 "grammar.c"
+#line 1892 "grammar.c"
     break;
 
   case 28: /* simple_value: TOK_BIN  */
-#line 307 "grammar.y"
+#line 416 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, (yyvsp[0].ival));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_BIN);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1550,24 +1917,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_BIN);
     }
   }
-#line 1554 "grammar.c"
+#line 1921 "grammar.c"
     break;
 
   case 29: /* simple_value: TOK_BIN64  */
-#line 329 "grammar.y"
+#line 441 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, (yyvsp[0].llval));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_BIN);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1576,24 +1946,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_BIN);
     }
   }
-#line 1580 "grammar.c"
+#line 1950 "grammar.c"
     break;
 
   case 30: /* simple_value: TOK_OCT  */
-#line 351 "grammar.y"
+#line 466 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, (yyvsp[0].ival));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_OCT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1602,24 +1975,27 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_OCT);
     }
   }
-#line 1606 "grammar.c"
+#line 1979 "grammar.c"
     break;
 
   case 31: /* simple_value: TOK_OCT64  */
-#line 373 "grammar.y"
+#line 491 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, (yyvsp[0].llval));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_OCT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1628,33 +2004,36 @@ yyreduce:
       config_setting_set_format(ctx->setting, CONFIG_FORMAT_OCT);
     }
   }
-#line 1632 "grammar.c"
+#line 2008 "grammar.c"
     break;
 
   case 32: /* simple_value: TOK_FLOAT  */
-#line 395 "grammar.y"
+#line 516 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
       config_setting_t *e = config_setting_set_float_elem(ctx->parent, -1, (yyvsp[0].fval));
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
       config_setting_set_float(ctx->setting, (yyvsp[0].fval));
   }
-#line 1654 "grammar.c"
+#line 2033 "grammar.c"
     break;
 
   case 33: /* simple_value: string  */
-#line 413 "grammar.y"
+#line 537 "grammar.y"
   {
     if(IN_ARRAY() || IN_LIST())
     {
@@ -1664,12 +2043,15 @@ yyreduce:
 
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, (yylsp[0]).first);
+        libconfig_parsectx_end_span(ctx, e, (yylsp[0]).first, (yylsp[0]).last, (yylsp[0]).last);
       }
     }
     else
@@ -1679,38 +2061,78 @@ yyreduce:
       __delete(s);
     }
   }
-#line 1683 "grammar.c"
+#line 2065 "grammar.c"
+    break;
+
+  case 35: /* value_list: value_list TOK_COMMA value  */
+#line 569 "grammar.y"
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_TRUE, (yylsp[-1]).last);
+  }
+#line 2073 "grammar.c"
+    break;
+
+  case 36: /* value_list: value_list TOK_COMMA  */
+#line 573 "grammar.y"
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_FALSE, (yylsp[0]).last);
+  }
+#line 2081 "grammar.c"
+    break;
+
+  case 40: /* simple_value_list: simple_value_list TOK_COMMA simple_value  */
+#line 586 "grammar.y"
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_TRUE, (yylsp[-1]).last);
+  }
+#line 2089 "grammar.c"
+    break;
+
+  case 41: /* simple_value_list: simple_value_list TOK_COMMA  */
+#line 590 "grammar.y"
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_FALSE, (yylsp[0]).last);
+  }
+#line 2097 "grammar.c"
     break;
 
   case 44: /* $@4: %empty  */
-#line 463 "grammar.y"
+#line 602 "grammar.y"
   {
     if(IN_LIST())
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_GROUP);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, (yylsp[0]).first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_GROUP;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_GROUP);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, (yylsp[0]).first, (yylsp[0]).last);
+    libconfig_parsectx_push_group(ctx);
   }
-#line 1701 "grammar.c"
+#line 2119 "grammar.c"
     break;
 
   case 45: /* group: TOK_GROUP_START $@4 setting_list_optional TOK_GROUP_END  */
-#line 478 "grammar.y"
+#line 621 "grammar.y"
   {
+    libconfig_parsectx_pop_group(ctx);
+    libconfig_parsectx_close_span(ctx, ctx->parent, (yylsp[0]).last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
-#line 1710 "grammar.c"
+#line 2132 "grammar.c"
     break;
 
 
-#line 1714 "grammar.c"
+#line 2136 "grammar.c"
 
       default: break;
     }
@@ -1731,6 +2153,7 @@ yyreduce:
   yylen = 0;
 
   *++yyvsp = yyval;
+  *++yylsp = yyloc;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
@@ -1757,9 +2180,10 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (scanner, ctx, scan_ctx, YY_("syntax error"));
+      yyerror (&yylloc, scanner, ctx, scan_ctx, YY_("syntax error"));
     }
 
+  yyerror_range[1] = yylloc;
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1774,7 +2198,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval, scanner, ctx, scan_ctx);
+                      yytoken, &yylval, &yylloc, scanner, ctx, scan_ctx);
           yychar = YYEMPTY;
         }
     }
@@ -1828,9 +2252,9 @@ yyerrlab1:
       if (yyssp == yyss)
         YYABORT;
 
-
+      yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp, scanner, ctx, scan_ctx);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, scanner, ctx, scan_ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1840,6 +2264,9 @@ yyerrlab1:
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
   YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
@@ -1868,7 +2295,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (scanner, ctx, scan_ctx, YY_("memory exhausted"));
+  yyerror (&yylloc, scanner, ctx, scan_ctx, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -1883,7 +2310,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval, scanner, ctx, scan_ctx);
+                  yytoken, &yylval, &yylloc, scanner, ctx, scan_ctx);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -1892,16 +2319,32 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, scanner, ctx, scan_ctx);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, scanner, ctx, scan_ctx);
       YYPOPSTACK (1);
     }
-#ifndef yyoverflow
-  if (yyss != yyssa)
-    YYSTACK_FREE (yyss);
-#endif
+  yyps->yynew = 2;
+  goto yypushreturn;
+
+
+/*-------------------------.
+| yypushreturn -- return.  |
+`-------------------------*/
+yypushreturn:
 
   return yyresult;
 }
-
-#line 484 "grammar.y"
+#undef libconfig_yynerrs
+#undef yystate
+#undef yyerrstatus
+#undef yyssa
+#undef yyss
+#undef yyssp
+#undef yyvsa
+#undef yyvs
+#undef yyvsp
+#undef yylsa
+#undef yyls
+#undef yylsp
+#undef yystacksize
+#line 631 "grammar.y"
 
@@ -44,6 +44,19 @@
 #if YYDEBUG
 extern int libconfig_yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 36 "grammar.y"
+
+#include <stddef.h>
+
+/* Byte offsets of the start and end of a symbol in the top-level input. */
+struct parse_location
+{
+  size_t first;
+  size_t last;
+};
+
+#line 60 "grammar.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -115,14 +128,14 @@ extern int libconfig_yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 77 "grammar.y"
+#line 92 "grammar.y"
 
   int ival;
   long long llval;
   double fval;
   char *sval;
 
-#line 126 "grammar.h"
+#line 139 "grammar.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -130,10 +143,26 @@ typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+/* Location type.  */
+typedef struct parse_location YYLTYPE;
+
+
+
+
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
 
+typedef struct libconfig_yypstate libconfig_yypstate;
 
 
 int libconfig_yyparse (void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+int libconfig_yypush_parse (libconfig_yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, YYLTYPE *pushed_loc, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+int libconfig_yypull_parse (libconfig_yypstate *ps, void *scanner, struct parse_context *ctx, struct scan_context *scan_ctx);
+libconfig_yypstate *libconfig_yypstate_new (void);
+void libconfig_yypstate_delete (libconfig_yypstate *ps);
 
 
 #endif /* !YY_LIBCONFIG_YY_GRAMMAR_H_INCLUDED  */
@@ -24,11 +24,26 @@
 %defines
 %output "y.tab.c"
 %pure-parser
+%locations
+%define api.push-pull both
+%define api.location.type {struct parse_location}
 %lex-param{void *scanner}
 %parse-param{void *scanner}
 %parse-param{struct parse_context *ctx}
 %parse-param{struct scan_context *scan_ctx}
 
+%code requires
+{
+#include <stddef.h>
+
+/* Byte offsets of the start and end of a symbol in the top-level input. */
+struct parse_location
+{
+  size_t first;
+  size_t last;
+};
+}
+
 %{
 #include <string.h>
 #include <stdlib.h>
@@ -36,6 +51,7 @@
 #include "libconfig.h"
 #include "parsectx.h"
 #include "scanctx.h"
+#include "fastscan.h"
 #include "util.h"
 #include "wincompat.h"
 
@@ -53,24 +69,23 @@ static const char *err_duplicate_setting = "duplicate setting name";
 #define IN_LIST() \
   (ctx->parent && (ctx->parent->type == CONFIG_TYPE_LIST))
 
+/* Tokens come from the hand-written scanner if one is attached to the scan
+ * context, and from the flex scanner otherwise.
+ */
+#define SCANNER_LINENO() \
+  (scan_ctx->fast ? libconfig_fastscan_lineno(scan_ctx->fast) \
+   : libconfig_yyget_lineno(scanner))
+
 static void capture_parse_pos(void *scanner, struct scan_context *scan_ctx,
                               config_setting_t *setting)
 {
-  setting->line = (unsigned int)libconfig_yyget_lineno(scanner);
+  setting->line = (unsigned int)SCANNER_LINENO();
   setting->file = libconfig_scanctx_current_filename(scan_ctx);
 }
 
 #define CAPTURE_PARSE_POS(S) \
   capture_parse_pos(scanner, scan_ctx, (S))
 
-void libconfig_yyerror(void *scanner, struct parse_context *ctx,
-                       struct scan_context *scan_ctx, char const *s)
-{
-  if(ctx->config->error_text) return;
-  ctx->config->error_line = libconfig_yyget_lineno(scanner);
-  ctx->config->error_text = s;
-}
-
 %}
 
 %union
@@ -82,8 +97,64 @@ void libconfig_yyerror(void *scanner, struct parse_context *ctx,
 }
 
 %{
+/* An empty symbol is located at the end of the one before it. */
+#define YYLLOC_DEFAULT(C, R, N)                   \
+  do                                              \
+  {                                               \
+    if(N)                                         \
+    {                                             \
+      (C).first = YYRHSLOC(R, 1).first;           \
+      (C).last = YYRHSLOC(R, N).last;             \
+    }                                             \
+    else                                          \
+      (C).first = (C).last = YYRHSLOC(R, 0).last; \
+  } while(0)
+
+void libconfig_yyerror(struct parse_location *loc, void *scanner,
+                       struct parse_context *ctx,
+                       struct scan_context *scan_ctx, char const *s)
+{
+  if(ctx->config->error_text) return;
+  ctx->config->error_line = SCANNER_LINENO();
+  ctx->config->error_text = s;
+}
+
 /* These declarations are provided to suppress compiler warnings. */
 extern int libconfig_yylex(YYSTYPE *, void *);
+
+static int scan_token(YYSTYPE *lval, struct parse_location *loc,
+                      void *scanner, struct scan_context *scan_ctx, int spans)
+{
+  int token;
+  unsigned long long start = 0;
+
+  if(scan_ctx->timing)
+    start = libconfig_time_ns();
+
+  if(scan_ctx->fast)
+    token = libconfig_fastscan_lex(lval, scan_ctx->fast);
+  else
+    token = libconfig_yylex(lval, scanner);
+
+  /* Token offsets are only needed when recording a source map. */
+  if(spans && scan_ctx->fast)
+    libconfig_fastscan_token_span(scan_ctx->fast, &(loc->first),
+                                  &(loc->last));
+  else
+    loc->first = loc->last = 0;
+
+  if(scan_ctx->timing)
+    scan_ctx->scan_ns += libconfig_time_ns() - start;
+
+  if(token > 0)
+    ++(scan_ctx->tokens);
+
+  return(token);
+}
+
+#undef yylex
+#define yylex(L, P, S) scan_token((L), (P), (S), scan_ctx, \
+                                  ctx->srcmap != NULL)
 %}
 
 %token <ival> TOK_BOOLEAN TOK_INTEGER TOK_HEX TOK_BIN TOK_OCT
@@ -120,20 +191,31 @@ setting_terminator:
 setting:
   TOK_NAME
   {
-    ctx->setting = config_setting_add(ctx->parent, $1, CONFIG_TYPE_NONE);
+    ctx->setting = libconfig_parsectx_add_member(ctx, $1);
 
     if(ctx->setting == NULL)
     {
-      libconfig_yyerror(scanner, ctx, scan_ctx, err_duplicate_setting);
+      libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_duplicate_setting);
       YYABORT;
     }
     else
     {
       CAPTURE_PARSE_POS(ctx->setting);
+      libconfig_parsectx_begin_span(ctx, ctx->setting, @1.first);
     }
   }
 
   TOK_EQUALS value setting_terminator
+  {
+    libconfig_parsectx_end_member(ctx);
+
+    /* A scalar merged into the member it overrides leaves none to count. */
+    if(ctx->setting)
+      libconfig_parsectx_count(ctx, ctx->setting);
+
+    libconfig_parsectx_end_span(ctx, ctx->setting, @4.first, @4.last,
+                                @5.last);
+  }
   ;
 
 array:
@@ -143,17 +225,23 @@ array:
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_ARRAY);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, @1.first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_ARRAY;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_ARRAY);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, @1.first, @1.last);
   }
   simple_value_list_optional
   TOK_ARRAY_END
   {
+    libconfig_parsectx_close_span(ctx, ctx->parent, @4.last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
@@ -166,17 +254,23 @@ list:
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_LIST);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, @1.first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_LIST;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_LIST);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, @1.first, @1.last);
   }
   value_list_optional
   TOK_LIST_END
   {
+    libconfig_parsectx_close_span(ctx, ctx->parent, @4.last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
@@ -204,12 +298,15 @@ simple_value:
 
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -222,13 +319,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_DEFAULT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -244,13 +344,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_DEFAULT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -266,13 +369,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_HEX);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -288,13 +394,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_HEX);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -310,13 +419,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_BIN);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -332,13 +444,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_BIN);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -354,13 +469,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_OCT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -376,13 +494,16 @@ simple_value:
       config_setting_t *e = config_setting_set_int64_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         config_setting_set_format(e, CONFIG_FORMAT_OCT);
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -398,12 +519,15 @@ simple_value:
       config_setting_t *e = config_setting_set_float_elem(ctx->parent, -1, $1);
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -419,12 +543,15 @@ simple_value:
 
       if(! e)
       {
-        libconfig_yyerror(scanner, ctx, scan_ctx, err_array_elem_type);
+        libconfig_yyerror(NULL, scanner, ctx, scan_ctx, err_array_elem_type);
         YYABORT;
       }
       else
       {
         CAPTURE_PARSE_POS(e);
+        libconfig_parsectx_count(ctx, e);
+        libconfig_parsectx_begin_span(ctx, e, @1.first);
+        libconfig_parsectx_end_span(ctx, e, @1.first, @1.last, @1.last);
       }
     }
     else
@@ -439,7 +566,13 @@ simple_value:
 value_list:
     value
   | value_list TOK_COMMA value
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_TRUE, @2.last);
+  }
   | value_list TOK_COMMA
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_FALSE, @2.last);
+  }
   ;
 
 value_list_optional:
@@ -450,7 +583,13 @@ value_list_optional:
 simple_value_list:
     simple_value
   | simple_value_list TOK_COMMA simple_value
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_TRUE, @2.last);
+  }
   | simple_value_list TOK_COMMA
+  {
+    libconfig_parsectx_separate_span(ctx, CONFIG_FALSE, @2.last);
+  }
   ;
 
 simple_value_list_optional:
@@ -465,17 +604,25 @@ group:
     {
       ctx->parent = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_GROUP);
       CAPTURE_PARSE_POS(ctx->parent);
+      libconfig_parsectx_count(ctx, ctx->parent);
+      libconfig_parsectx_begin_span(ctx, ctx->parent, @1.first);
     }
     else
     {
-      ctx->setting->type = CONFIG_TYPE_GROUP;
-      ctx->parent = ctx->setting;
+      ctx->parent = libconfig_parsectx_open_member(ctx, CONFIG_TYPE_GROUP);
       ctx->setting = NULL;
     }
+
+    libconfig_parsectx_open_span(ctx, ctx->parent, @1.first, @1.last);
+    libconfig_parsectx_push_group(ctx);
   }
   setting_list_optional
   TOK_GROUP_END
   {
+    libconfig_parsectx_pop_group(ctx);
+    libconfig_parsectx_close_span(ctx, ctx->parent, @4.last);
+    ctx->setting = ctx->parent;
+
     if(ctx->parent)
       ctx->parent = ctx->parent->parent;
   }
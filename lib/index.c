@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "libconfig.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define INDEX_MIN_CAPACITY 16
+
+/* ------------------------------------------------------------------------- */
+
+/* A record, and the setting within it that holds its key. */
+struct index_entry
+{
+  unsigned int hash;
+  const config_setting_t *key; /* NULL if the slot is free */
+  config_setting_t *record;
+};
+
+struct config_index_t
+{
+  config_setting_t *aggregate;
+  char *path;
+  unsigned long generation; /* of the configuration, when last built */
+  struct index_entry *entries;
+  unsigned int capacity; /* a power of two */
+};
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned int __index_hash_int(long long value)
+{
+  unsigned long long h = (unsigned long long)value;
+
+  /* The finalizer of MurmurHash3. */
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+
+  return((unsigned int)h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Computes the hash of a key. Returns CONFIG_FALSE if the setting can't be
+ * a key.
+ */
+static int __index_key_hash(const config_setting_t *key, unsigned int *hash)
+{
+  switch(config_setting_type(key))
+  {
+    case CONFIG_TYPE_INT:
+    case CONFIG_TYPE_INT64:
+      *hash = __index_hash_int(config_setting_get_int64(key));
+      return(CONFIG_TRUE);
+
+    case CONFIG_TYPE_STRING:
+      if(! config_setting_get_string(key))
+        return(CONFIG_FALSE);
+
+      *hash = libconfig_hash_string(config_setting_get_string(key));
+      return(CONFIG_TRUE);
+
+    default:
+      return(CONFIG_FALSE);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the slot holding the record with the given key, or the free slot
+ * where it belongs. Integer keys of either width compare equal by value.
+ */
+static struct index_entry *__index_probe(const config_index_t *index,
+                                         unsigned int hash, int is_string,
+                                         long long ival, const char *sval)
+{
+  unsigned int mask = index->capacity - 1;
+  unsigned int i = hash & mask;
+
+  for(;; i = (i + 1) & mask)
+  {
+    struct index_entry *entry = index->entries + i;
+    int type;
+
+    if(! entry->key)
+      return(entry);
+
+    if(entry->hash != hash)
+      continue;
+
+    type = config_setting_type(entry->key);
+
+    if(is_string)
+    {
+      if((type == CONFIG_TYPE_STRING)
+         && !strcmp(config_setting_get_string(entry->key), sval))
+        return(entry);
+    }
+    else if(((type == CONFIG_TYPE_INT) || (type == CONFIG_TYPE_INT64))
+            && (config_setting_get_int64(entry->key) == ival))
+      return(entry);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __index_build(config_index_t *index)
+{
+  unsigned int length = (unsigned int)config_setting_length(index->aggregate);
+  unsigned int capacity = INDEX_MIN_CAPACITY, i;
+
+  /* Keep the load factor at or below 1/2. */
+  while(capacity < length * 2)
+    capacity *= 2;
+
+  if(capacity != index->capacity)
+  {
+    __delete(index->entries);
+    index->entries = (struct index_entry *)libconfig_calloc(
+      capacity, sizeof(struct index_entry));
+    index->capacity = capacity;
+  }
+  else
+    memset(index->entries, 0, capacity * sizeof(struct index_entry));
+
+  for(i = 0; i < length; ++i)
+  {
+    config_setting_t *record = config_setting_get_elem(index->aggregate, i);
+    const config_setting_t *key;
+    struct index_entry *entry;
+    unsigned int hash;
+    int is_string;
+
+    if(config_setting_type(record) != CONFIG_TYPE_GROUP)
+      continue;
+
+    key = config_setting_lookup_const(record, index->path);
+    if(! key || ! __index_key_hash(key, &hash))
+      continue;
+
+    is_string = (config_setting_type(key) == CONFIG_TYPE_STRING);
+    entry = __index_probe(index, hash, is_string,
+                          is_string ? 0 : config_setting_get_int64(key),
+                          is_string ? config_setting_get_string(key) : NULL);
+
+    /* The first of several records with the same key wins. */
+    if(! entry->key)
+    {
+      entry->hash = hash;
+      entry->key = key;
+      entry->record = record;
+    }
+  }
+
+  index->generation = index->aggregate->config->generation;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Rebuilds the index if the configuration has changed since it was built. */
+static void __index_refresh(config_index_t *index)
+{
+  if(index->generation != index->aggregate->config->generation)
+    __index_build(index);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_index_t *config_setting_build_index(config_setting_t *setting,
+                                           const char *path)
+{
+  config_index_t *index;
+
+  if(! setting || ! path || ! config_setting_is_aggregate(setting))
+    return(NULL);
+
+  index = __new(config_index_t);
+  index->aggregate = setting;
+  index->path = strdup(path);
+  __index_build(index);
+
+  return(index);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *config_index_find_int(config_index_t *index,
+                                        long long value)
+{
+  if(! index)
+    return(NULL);
+
+  __index_refresh(index);
+
+  return(__index_probe(index, __index_hash_int(value), CONFIG_FALSE, value,
+                       NULL)->record);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *config_index_find_string(config_index_t *index,
+                                           const char *value)
+{
+  if(! index || ! value)
+    return(NULL);
+
+  __index_refresh(index);
+
+  return(__index_probe(index, libconfig_hash_string(value), CONFIG_TRUE, 0,
+                       value)->record);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_index_destroy(config_index_t *index)
+{
+  if(! index)
+    return;
+
+  __delete(index->path);
+  __delete(index->entries);
+  __delete(index);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,364 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "iosource.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#define READ_CHUNK_SIZE 16384
+#define BUNDLE_MIN_CAPACITY 16
+
+/* ------------------------------------------------------------------------- */
+
+static void *__stdio_open(void *ctx, const char *path)
+{
+  (void)ctx;
+
+  return((void *)fopen(path, "rt"));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static size_t __stdio_read(void *ctx, void *file, char *buf, size_t len)
+{
+  size_t n;
+
+  (void)ctx;
+
+  n = fread(buf, 1, len, (FILE *)file);
+  if((n < len) && ferror((FILE *)file))
+    return(CONFIG_IO_ERROR);
+
+  return(n);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __stdio_close(void *ctx, void *file)
+{
+  (void)ctx;
+
+  fclose((FILE *)file);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __stdio_stat(void *ctx, const char *path, config_io_stat_t *st)
+{
+  struct stat statbuf;
+
+  (void)ctx;
+
+  if(stat(path, &statbuf) != 0)
+    return(CONFIG_FALSE);
+
+  st->size = (size_t)statbuf.st_size;
+  st->is_dir = S_ISDIR(statbuf.st_mode) ? CONFIG_TRUE : CONFIG_FALSE;
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_io_t libconfig_default_io = {
+  __stdio_open, __stdio_read, __stdio_close, __stdio_stat, NULL
+};
+
+/* ------------------------------------------------------------------------- */
+
+char *libconfig_io_read_file(const config_t *config, const char *path,
+                             size_t *len)
+{
+  const config_io_t *io = config->io;
+  config_io_stat_t st;
+  size_t capacity = READ_CHUNK_SIZE, n;
+  void *file;
+  char *data;
+
+  /* Knowing the size up front lets the file be read in a single call; the
+   * extra byte is room for the read that finds the end of the file.
+   */
+  if(io->stat)
+  {
+    if(! io->stat(io->ctx, path, &st) || st.is_dir)
+      return(NULL);
+
+    capacity = st.size + 1;
+  }
+
+  file = io->open(io->ctx, path);
+  if(! file)
+    return(NULL);
+
+  data = (char *)libconfig_malloc(capacity);
+  *len = 0;
+
+  while((n = io->read(io->ctx, file, data + *len, capacity - *len)) > 0)
+  {
+    /* A file that can't be read in full is not parsed at all. */
+    if(n == CONFIG_IO_ERROR)
+    {
+      io->close(io->ctx, file);
+      __delete(data);
+      return(NULL);
+    }
+
+    *len += n;
+    if(*len == capacity)
+    {
+      capacity *= 2;
+      data = (char *)libconfig_realloc(data, capacity);
+    }
+  }
+
+  io->close(io->ctx, file);
+
+  return(data);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct bundle_entry
+{
+  unsigned int hash;
+  char *path; /* NULL if the slot is free */
+  const char *data;
+  size_t len;
+};
+
+struct config_bundle_t
+{
+  config_io_t io;
+  struct bundle_entry *entries;
+  unsigned int capacity; /* a power of two, or 0 */
+  unsigned int count;
+};
+
+struct bundle_file
+{
+  const char *data;
+  size_t len;
+  size_t pos;
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the slot holding the file with the given path, or the free slot
+ * where it belongs. The table must have at least one free slot.
+ */
+static struct bundle_entry *__bundle_find(const config_bundle_t *bundle,
+                                          const char *path,
+                                          unsigned int hash)
+{
+  unsigned int mask = bundle->capacity - 1;
+  unsigned int i = hash & mask;
+  struct bundle_entry *entry;
+
+  for(;;)
+  {
+    entry = bundle->entries + i;
+
+    if(! entry->path)
+      return(entry);
+
+    if((entry->hash == hash) && !strcmp(entry->path, path))
+      return(entry);
+
+    i = (i + 1) & mask;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __bundle_grow(config_bundle_t *bundle)
+{
+  struct bundle_entry *old = bundle->entries, *entry;
+  unsigned int old_capacity = bundle->capacity, i;
+
+  bundle->capacity = (old_capacity < BUNDLE_MIN_CAPACITY)
+    ? BUNDLE_MIN_CAPACITY : old_capacity * 2;
+  bundle->entries = (struct bundle_entry *)libconfig_calloc(
+    bundle->capacity, sizeof(struct bundle_entry));
+
+  for(i = 0; i < old_capacity; ++i)
+  {
+    if(old[i].path)
+    {
+      entry = __bundle_find(bundle, old[i].path, old[i].hash);
+      *entry = old[i];
+    }
+  }
+
+  __delete(old);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const struct bundle_entry *__bundle_lookup(
+  const config_bundle_t *bundle, const char *path)
+{
+  const struct bundle_entry *entry;
+
+  if(bundle->count == 0)
+    return(NULL);
+
+  entry = __bundle_find(bundle, path, libconfig_hash_string(path));
+
+  return(entry->path ? entry : NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void *__bundle_open(void *ctx, const char *path)
+{
+  const struct bundle_entry *entry = __bundle_lookup(
+    (const config_bundle_t *)ctx, path);
+  struct bundle_file *file;
+
+  if(! entry)
+    return(NULL);
+
+  file = __new(struct bundle_file);
+  file->data = entry->data;
+  file->len = entry->len;
+
+  return(file);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static size_t __bundle_read(void *ctx, void *file, char *buf, size_t len)
+{
+  struct bundle_file *f = (struct bundle_file *)file;
+
+  (void)ctx;
+
+  if(len > f->len - f->pos)
+    len = f->len - f->pos;
+
+  memcpy(buf, f->data + f->pos, len);
+  f->pos += len;
+
+  return(len);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __bundle_close(void *ctx, void *file)
+{
+  (void)ctx;
+
+  __delete(file);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __bundle_stat(void *ctx, const char *path, config_io_stat_t *st)
+{
+  const struct bundle_entry *entry = __bundle_lookup(
+    (const config_bundle_t *)ctx, path);
+
+  if(! entry)
+    return(CONFIG_FALSE);
+
+  st->size = entry->len;
+  st->is_dir = CONFIG_FALSE;
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_bundle_t *config_bundle_new(void)
+{
+  config_bundle_t *bundle = __new(config_bundle_t);
+
+  bundle->io.open = __bundle_open;
+  bundle->io.read = __bundle_read;
+  bundle->io.close = __bundle_close;
+  bundle->io.stat = __bundle_stat;
+  bundle->io.ctx = bundle;
+
+  return(bundle);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_bundle_add(config_bundle_t *bundle, const char *path,
+                      const char *data, size_t len)
+{
+  struct bundle_entry *entry;
+  unsigned int hash;
+
+  if(! bundle || ! path || (! data && len > 0))
+    return(CONFIG_FALSE);
+
+  /* Keep the load factor at or below 1/2. */
+  if((bundle->count + 1) * 2 > bundle->capacity)
+    __bundle_grow(bundle);
+
+  hash = libconfig_hash_string(path);
+  entry = __bundle_find(bundle, path, hash);
+
+  if(! entry->path)
+  {
+    entry->hash = hash;
+    entry->path = strdup(path);
+    ++(bundle->count);
+  }
+
+  entry->data = data;
+  entry->len = len;
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_io_t *config_bundle_io(config_bundle_t *bundle)
+{
+  return(bundle ? &(bundle->io) : NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_bundle_destroy(config_bundle_t *bundle)
+{
+  unsigned int i;
+
+  if(! bundle)
+    return;
+
+  for(i = 0; i < bundle->capacity; ++i)
+    __delete(bundle->entries[i].path);
+
+  __delete(bundle->entries);
+  __delete(bundle);
+}
+
+/* ------------------------------------------------------------------------- */
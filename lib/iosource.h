@@ -0,0 +1,46 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#ifndef __libconfig_iosource_h
+#define __libconfig_iosource_h
+
+#include <sys/types.h>
+
+#include "libconfig.h"
+
+/*
+ * The I/O provider used when none has been set; it reads files from the file
+ * system with stdio.
+ */
+extern const config_io_t libconfig_default_io;
+
+/*
+ * Reads the whole of the file at 'path' through the configuration's I/O
+ * provider, into a buffer that the caller must free, and stores its length
+ * at 'len'. Returns NULL if the file does not exist, cannot be opened, or is
+ * a directory.
+ */
+extern char *libconfig_io_read_file(const config_t *config, const char *path,
+                                    size_t *len);
+
+#endif /* __libconfig_iosource_h */
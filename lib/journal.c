@@ -0,0 +1,739 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "journal.h"
+#include "iosource.h"
+#include "strbuf.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JOURNAL_SUFFIX ".journal"
+
+static const char *__io_error = "file I/O error";
+static const char *__record_error = "invalid journal record";
+
+/* ------------------------------------------------------------------------- */
+
+/*
+ * A journal is a header line, "J <hash>", where <hash> is the hash of the
+ * contents of the configuration file that the journal applies to, followed
+ * by records, one per change:
+ *
+ *   S <path> <t> <value>   set the value of a scalar setting, where <t> is
+ *                          'i', 'I', 'f', 'b' or 's' for an int, int64,
+ *                          float (as the hex bits of the double), bool or
+ *                          string value
+ *   F <path> <format>      set the format of an integer setting
+ *   A <path> <type> <name> add a setting of the given type to a group, or
+ *                          an unnamed one to an array or list
+ *   X <path>               remove a setting
+ *
+ * Paths, names and string values are written as "<length>:<bytes>", so that
+ * records can be read back without any unescaping, and each record ends
+ * with a newline; a record that has been cut short by a crash while it was
+ * being written is discarded.
+ */
+
+struct config_journal_t
+{
+  char *filename; /* of the configuration file */
+  char *path;     /* of the journal */
+  FILE *stream;   /* NULL if the journal could not be (re)opened */
+  size_t size;    /* in bytes */
+  strbuf_t record;
+  strbuf_t path_buf;
+};
+
+struct journal_record
+{
+  char type;
+  const char *path;
+  size_t path_len;
+  char value_type;
+  long long ival;
+  unsigned long long bits;
+  const char *str;
+  size_t str_len;
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* 64-bit FNV-1a. */
+
+#define JOURNAL_HASH_INIT 0xCBF29CE484222325ULL
+
+static unsigned long long __journal_hash(unsigned long long hash,
+                                         const char *data, size_t len)
+{
+  const unsigned char *p = (const unsigned char *)data;
+
+  for(; len--; ++p)
+  {
+    hash ^= *p;
+    hash *= 0x100000001B3ULL;
+  }
+
+  return(hash);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The file is read back through the configuration's I/O provider, so that
+ * the hash is that of the text the next config_read_file() will parse.
+ */
+static int __journal_hash_file(const config_t *config, const char *filename,
+                               unsigned long long *hash)
+{
+  size_t len;
+  char *data = libconfig_io_read_file(config, filename, &len);
+
+  if(! data)
+    return(CONFIG_FALSE);
+
+  *hash = __journal_hash(JOURNAL_HASH_INIT, data, len);
+  __delete(data);
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Reads the whole of the journal, if there is one. */
+static char *__journal_read_file(const char *path, size_t *len)
+{
+  char buf[BUFSIZ];
+  size_t n;
+  strbuf_t text;
+  FILE *stream = fopen(path, "rb");
+
+  if(! stream)
+    return(NULL);
+
+  __zero(&text);
+  while((n = fread(buf, 1, sizeof(buf), stream)) > 0)
+    libconfig_strbuf_append_chars(&text, buf, n);
+
+  fclose(stream);
+
+  *len = text.length;
+  return(text.string ? libconfig_strbuf_release(&text) : strdup(""));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __journal_write(config_t *config, struct config_journal_t *journal,
+                           const char *data, size_t len)
+{
+  if(! journal->stream)
+    return(CONFIG_FALSE);
+
+  if((fwrite(data, 1, len, journal->stream) != len)
+     || (fflush(journal->stream) != 0))
+    return(CONFIG_FALSE);
+
+  if(config_get_option(config, CONFIG_OPTION_FSYNC))
+  {
+    int fd = posix_fileno(journal->stream);
+
+    if((fd >= 0) && (posix_fsync(fd) != 0))
+      return(CONFIG_FALSE);
+  }
+
+  journal->size += len;
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Starts the journal over for the configuration file contents with the given
+ * hash, keeping the 'len' bytes of records at 'records'.
+ */
+static int __journal_reset(config_t *config, struct config_journal_t *journal,
+                           unsigned long long hash, const char *records,
+                           size_t len)
+{
+  char header[32];
+
+  if(journal->stream)
+    fclose(journal->stream);
+
+  journal->size = 0;
+  journal->stream = fopen(journal->path, "wb");
+
+  snprintf(header, sizeof(header), "J %016llX\n", hash);
+
+  return(__journal_write(config, journal, header, strlen(header))
+         && ((len == 0) || __journal_write(config, journal, records, len)));
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Appends the path of 'setting' from the root. The path is built from the
+ * setting upward with each element reversed, and then reversed as a whole,
+ * so that deep settings don't need deep recursion.
+ */
+static void __journal_append_path(strbuf_t *buf,
+                                  const config_setting_t *setting)
+{
+  size_t start = buf->length, len;
+  char *p, *q;
+
+  for(; setting->parent; setting = setting->parent)
+  {
+    char index[16];
+    const char *name = setting->name;
+
+    if(buf->length > start)
+      libconfig_strbuf_append_char(buf, '.');
+
+    if(! name)
+    {
+      snprintf(index, sizeof(index), "[%d]", config_setting_index(setting));
+      name = index;
+    }
+
+    for(len = strlen(name); len--;)
+      libconfig_strbuf_append_char(buf, name[len]);
+  }
+
+  /* The root's path is empty, and the buffer may not have been allocated. */
+  if(buf->length == start)
+    return;
+
+  for(p = buf->string + start, q = buf->string + buf->length - 1; p < q;
+      ++p, --q)
+  {
+    char c = *p;
+    *p = *q;
+    *q = c;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __journal_append_bytes(strbuf_t *buf, const char *s, size_t len)
+{
+  char prefix[24];
+
+  snprintf(prefix, sizeof(prefix), " %lu:", (unsigned long)len);
+  libconfig_strbuf_append_string(buf, prefix);
+  libconfig_strbuf_append_chars(buf, s, len);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __journal_append_value(strbuf_t *buf,
+                                   const config_setting_t *setting)
+{
+  char value[32];
+  const config_value_t *v = &(setting->value);
+
+  switch(setting->type)
+  {
+    case CONFIG_TYPE_INT:
+      snprintf(value, sizeof(value), " i %d", v->ival);
+      break;
+
+    case CONFIG_TYPE_INT64:
+      snprintf(value, sizeof(value), " I " INT64_FMT, v->llval);
+      break;
+
+    case CONFIG_TYPE_FLOAT:
+    {
+      unsigned long long bits;
+
+      memcpy(&bits, &(v->fval), sizeof(bits));
+      snprintf(value, sizeof(value), " f %016llX", bits);
+      break;
+    }
+
+    case CONFIG_TYPE_BOOL:
+      snprintf(value, sizeof(value), " b %d", v->ival ? 1 : 0);
+      break;
+
+    case CONFIG_TYPE_STRING:
+      libconfig_strbuf_append_string(buf, " s");
+      __journal_append_bytes(buf, v->sval ? v->sval : "",
+                             v->sval ? strlen(v->sval) : 0);
+      return;
+
+    default:
+      return;
+  }
+
+  libconfig_strbuf_append_string(buf, value);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_journal_prepare(config_t *config, char type,
+                               const config_setting_t *setting)
+{
+  struct config_journal_t *journal = config->journal;
+  strbuf_t *buf = &(journal->record), *path = &(journal->path_buf);
+  char number[16];
+
+  path->length = 0;
+  __journal_append_path(path, (type == JOURNAL_ADD) ? setting->parent
+                        : setting);
+
+  buf->length = 0;
+  libconfig_strbuf_append_char(buf, type);
+  __journal_append_bytes(buf, path->string ? path->string : "",
+                         path->length);
+
+  switch(type)
+  {
+    case JOURNAL_SET:
+      __journal_append_value(buf, setting);
+      break;
+
+    case JOURNAL_FORMAT:
+      snprintf(number, sizeof(number), " %d", (int)setting->format);
+      libconfig_strbuf_append_string(buf, number);
+      break;
+
+    case JOURNAL_ADD:
+      snprintf(number, sizeof(number), " %d", (int)setting->type);
+      libconfig_strbuf_append_string(buf, number);
+      __journal_append_bytes(buf, setting->name ? setting->name : "",
+                             setting->name ? strlen(setting->name) : 0);
+      break;
+
+    default:
+      break;
+  }
+
+  libconfig_strbuf_append_char(buf, '\n');
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_journal_commit(config_t *config)
+{
+  struct config_journal_t *journal = config->journal;
+  strbuf_t *buf = &(journal->record);
+
+  /* If the record can't be written, the configuration is written out in
+   * full instead.
+   */
+  if(! __journal_write(config, journal, buf->string, buf->length)
+     || ((config->journal_limit > 0)
+         && (journal->size > config->journal_limit)))
+    (void)config_journal_compact(config);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_journal_append(config_t *config, char type,
+                              const config_setting_t *setting)
+{
+  libconfig_journal_prepare(config, type, setting);
+  libconfig_journal_commit(config);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Readers for the fields of a record. Each returns CONFIG_FALSE if the field
+ * is malformed, or runs past the end of the journal.
+ */
+
+static int __journal_read_char(const char **p, const char *end, char c)
+{
+  if((*p >= end) || (**p != c))
+    return(CONFIG_FALSE);
+
+  ++(*p);
+  return(CONFIG_TRUE);
+}
+
+static int __journal_read_integer(const char **p, const char *end,
+                                  long long *val)
+{
+  int neg = 0;
+  unsigned long long v = 0;
+  const char *digits;
+
+  if((*p < end) && (**p == '-'))
+  {
+    neg = 1;
+    ++(*p);
+  }
+
+  for(digits = *p; (*p < end) && (**p >= '0') && (**p <= '9'); ++(*p))
+    v = (v * 10) + (unsigned long long)(**p - '0');
+
+  *val = neg ? (long long)(0 - v) : (long long)v;
+  return((*p > digits) && (*p < end));
+}
+
+static int __journal_read_hex(const char **p, const char *end,
+                              unsigned long long *val)
+{
+  const char *digits = *p;
+
+  for(*val = 0; *p < end; ++(*p))
+  {
+    char c = **p;
+
+    if((c >= '0') && (c <= '9'))
+      *val = (*val << 4) | (unsigned long long)(c - '0');
+    else if((c >= 'A') && (c <= 'F'))
+      *val = (*val << 4) | (unsigned long long)(c - 'A' + 10);
+    else
+      break;
+  }
+
+  return((*p > digits) && (*p < end));
+}
+
+static int __journal_read_bytes(const char **p, const char *end,
+                                const char **s, size_t *len)
+{
+  long long n;
+
+  if(! __journal_read_integer(p, end, &n) || (n < 0)
+     || ! __journal_read_char(p, end, ':'))
+    return(CONFIG_FALSE);
+
+  if((size_t)(end - *p) < (size_t)n)
+  {
+    *p = end;
+    return(CONFIG_FALSE);
+  }
+
+  *s = *p;
+  *len = (size_t)n;
+  *p += n;
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __journal_read_record(const char **p, const char *end,
+                                 struct journal_record *record)
+{
+  if(*p >= end)
+    return(CONFIG_FALSE);
+
+  record->type = *((*p)++);
+
+  if(! __journal_read_char(p, end, ' ')
+     || ! __journal_read_bytes(p, end, &(record->path), &(record->path_len)))
+    return(CONFIG_FALSE);
+
+  switch(record->type)
+  {
+    case JOURNAL_SET:
+      if(! __journal_read_char(p, end, ' ') || (*p >= end))
+        return(CONFIG_FALSE);
+
+      record->value_type = *((*p)++);
+
+      if(! __journal_read_char(p, end, ' '))
+        return(CONFIG_FALSE);
+
+      switch(record->value_type)
+      {
+        case 'i':
+        case 'I':
+        case 'b':
+          if(! __journal_read_integer(p, end, &(record->ival)))
+            return(CONFIG_FALSE);
+          break;
+
+        case 'f':
+          if(! __journal_read_hex(p, end, &(record->bits)))
+            return(CONFIG_FALSE);
+          break;
+
+        case 's':
+          if(! __journal_read_bytes(p, end, &(record->str),
+                                    &(record->str_len)))
+            return(CONFIG_FALSE);
+          break;
+
+        default:
+          return(CONFIG_FALSE);
+      }
+      break;
+
+    case JOURNAL_FORMAT:
+      if(! __journal_read_char(p, end, ' ')
+         || ! __journal_read_integer(p, end, &(record->ival)))
+        return(CONFIG_FALSE);
+      break;
+
+    case JOURNAL_ADD:
+      if(! __journal_read_char(p, end, ' ')
+         || ! __journal_read_integer(p, end, &(record->ival))
+         || ! __journal_read_char(p, end, ' ')
+         || ! __journal_read_bytes(p, end, &(record->str),
+                                   &(record->str_len)))
+        return(CONFIG_FALSE);
+      break;
+
+    case JOURNAL_REMOVE:
+      break;
+
+    default:
+      return(CONFIG_FALSE);
+  }
+
+  return(__journal_read_char(p, end, '\n'));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __journal_apply(config_t *config, struct config_journal_t *journal,
+                           const struct journal_record *record)
+{
+  config_setting_t *setting = config->root;
+  strbuf_t *buf = &(journal->record);
+
+  if(record->path_len > 0)
+  {
+    setting = config_setting_lookup_n(config->root, record->path,
+                                      record->path_len);
+    if(! setting)
+      return(CONFIG_FALSE);
+  }
+
+  /* Copy the string or name, which isn't NUL-terminated in the journal. */
+  buf->length = 0;
+  libconfig_strbuf_append_chars(buf, record->str ? record->str : "",
+                                record->str_len);
+
+  switch(record->type)
+  {
+    case JOURNAL_SET:
+      switch(record->value_type)
+      {
+        case 'i':
+          return(config_setting_set_int(setting, (int)record->ival));
+
+        case 'I':
+          return(config_setting_set_int64(setting, record->ival));
+
+        case 'b':
+          return(config_setting_set_bool(setting, (int)record->ival));
+
+        case 'f':
+        {
+          double val;
+
+          memcpy(&val, &(record->bits), sizeof(val));
+          return(config_setting_set_float(setting, val));
+        }
+
+        default:
+          return(config_setting_set_string(setting, buf->string));
+      }
+
+    case JOURNAL_FORMAT:
+      return(config_setting_set_format(setting,
+                                       (unsigned short)record->ival));
+
+    case JOURNAL_ADD:
+      return(config_setting_add(setting, buf->length ? buf->string : NULL,
+                                (int)record->ival) != NULL);
+
+    default: /* JOURNAL_REMOVE */
+      if(! setting->parent)
+        return(CONFIG_FALSE);
+
+      return(config_setting_remove_elem(
+               setting->parent, (unsigned int)config_setting_index(setting)));
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Replays the records from 'p' onward, and returns the position after the
+ * last whole record, or NULL if a record could not be applied.
+ */
+static const char *__journal_replay(config_t *config,
+                                    struct config_journal_t *journal,
+                                    const char *p, const char *end,
+                                    int *line)
+{
+  while(p < end)
+  {
+    struct journal_record record;
+    const char *q = p;
+
+    __zero(&record);
+
+    if(! __journal_read_record(&q, end, &record))
+    {
+      /* A record that runs past the end was cut short; any other is
+       * corrupt.
+       */
+      return((q >= end) ? p : NULL);
+    }
+
+    if(! __journal_apply(config, journal, &record))
+      return(NULL);
+
+    for(; p < q; ++p)
+    {
+      if(*p == '\n')
+        ++(*line);
+    }
+  }
+
+  return(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int libconfig_journal_open(config_t *config, const char *filename,
+                           const char *data, size_t len)
+{
+  struct config_journal_t *journal = __new(struct config_journal_t);
+  unsigned long long hash = __journal_hash(JOURNAL_HASH_INIT, data, len);
+  const char *records = NULL, *good = NULL;
+  size_t text_len = 0;
+  char *text;
+  int line = 2, ok;
+
+  journal->filename = strdup(filename);
+  journal->path = (char *)libconfig_malloc(strlen(filename)
+                                           + sizeof(JOURNAL_SUFFIX));
+  strcpy(journal->path, filename);
+  strcat(journal->path, JOURNAL_SUFFIX);
+
+  text = __journal_read_file(journal->path, &text_len);
+  if(text)
+  {
+    const char *p = text, *end = text + text_len;
+    unsigned long long base;
+
+    /* A journal written for other contents of the file is left over from a
+     * compaction that was interrupted after the file was written, and has
+     * nothing to add to it.
+     */
+    if(__journal_read_char(&p, end, 'J') && __journal_read_char(&p, end, ' ')
+       && __journal_read_hex(&p, end, &base)
+       && __journal_read_char(&p, end, '\n') && (base == hash))
+    {
+      records = p;
+      good = __journal_replay(config, journal, p, end, &line);
+      if(! good)
+      {
+        __delete(text);
+        libconfig_journal_close(journal);
+        config->error_text = __record_error;
+        config->error_file = NULL;
+        config->error_line = line;
+        config->error_type = CONFIG_ERR_PARSE;
+        return(CONFIG_FALSE);
+      }
+    }
+  }
+
+  if(good && (good == text + text_len))
+  {
+    journal->stream = fopen(journal->path, "ab");
+    journal->size = text_len;
+    ok = (journal->stream != NULL);
+  }
+  else /* none, left over, or with a record that was cut short */
+    ok = __journal_reset(config, journal, hash, records,
+                         records ? (size_t)(good - records) : 0);
+
+  __delete(text);
+
+  if(! ok)
+  {
+    libconfig_journal_close(journal);
+    config->error_text = __io_error;
+    config->error_type = CONFIG_ERR_FILE_IO;
+    return(CONFIG_FALSE);
+  }
+
+  config->journal = journal;
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_journal_close(struct config_journal_t *journal)
+{
+  if(! journal)
+    return;
+
+  if(journal->stream)
+    fclose(journal->stream);
+
+  __delete(journal->filename);
+  __delete(journal->path);
+  __delete(journal->record.string);
+  __delete(journal->path_buf.string);
+  __delete(journal);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_journal_compact(config_t *config)
+{
+  struct config_journal_t *journal = config->journal;
+  unsigned long long hash;
+
+  if(! journal)
+    return(CONFIG_TRUE);
+
+  if(! config_write_file(config, journal->filename))
+    return(CONFIG_FALSE);
+
+  /* The new journal is tied to the file by the hash of what was written. */
+  if(! __journal_hash_file(config, journal->filename, &hash)
+     || ! __journal_reset(config, journal, hash, NULL, 0))
+  {
+    config->error_text = __io_error;
+    config->error_type = CONFIG_ERR_FILE_IO;
+    return(CONFIG_FALSE);
+  }
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_set_journal_limit(config_t *config, size_t limit)
+{
+  config->journal_limit = limit;
+}
+
+/* ------------------------------------------------------------------------- */
+
+size_t config_get_journal_limit(const config_t *config)
+{
+  return(config->journal_limit);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,73 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#ifndef __libconfig_journal_h
+#define __libconfig_journal_h
+
+#include <stddef.h>
+
+#include "libconfig.h"
+
+/*
+ * The journal kept beside a configuration file read with
+ * CONFIG_OPTION_JOURNAL. Each change made to the configuration through the
+ * API is appended to it as a record, and the records are replayed when the
+ * file is next read, until the journal is compacted back into the file.
+ */
+
+/* Record types. */
+#define JOURNAL_SET    'S' /* a scalar setting's value was set */
+#define JOURNAL_FORMAT 'F' /* an integer setting's format was changed */
+#define JOURNAL_ADD    'A' /* a setting was added */
+#define JOURNAL_REMOVE 'X' /* a setting was removed */
+
+/*
+ * Replays the journal of the file 'filename', whose contents, 'data', have
+ * just been read into the configuration, and attaches the journal to the
+ * configuration so that further changes are recorded in it. Returns
+ * CONFIG_FALSE, with the error set in the configuration, if the journal
+ * cannot be replayed or opened.
+ */
+extern int libconfig_journal_open(config_t *config, const char *filename,
+                                  const char *data, size_t len);
+extern void libconfig_journal_close(struct config_journal_t *journal);
+
+/*
+ * Appends a record of the given type for 'setting' to the configuration's
+ * journal, compacting the journal if it has grown past the limit, or if the
+ * record cannot be written.
+ */
+extern void libconfig_journal_append(config_t *config, char type,
+                                     const config_setting_t *setting);
+
+/*
+ * The two halves of libconfig_journal_append(), for changes that must be
+ * recorded in terms of the tree as it was before the change, but written
+ * only after it: libconfig_journal_prepare() builds the record, and
+ * libconfig_journal_commit() writes it, and compacts the journal if needed.
+ */
+extern void libconfig_journal_prepare(config_t *config, char type,
+                                      const config_setting_t *setting);
+extern void libconfig_journal_commit(config_t *config);
+
+#endif /* __libconfig_journal_h */
@@ -31,14 +31,23 @@
 #endif
 
 #include <ctype.h>
+#include <errno.h>
 #include <float.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include "libconfig.h"
+#include "dirlist.h"
+#include "fastscan.h"
+#include "frozen.h"
+#include "iosource.h"
+#include "journal.h"
+#include "parallel.h"
 #include "parsectx.h"
 #include "scanctx.h"
 #include "strvec.h"
@@ -51,6 +60,8 @@
 #define CHUNK_SIZE 16
 #define DEFAULT_TAB_WIDTH 2
 #define DEFAULT_FLOAT_PRECISION 6
+#define PARALLEL_MIN_CHUNK_SIZE (256 * 1024)
+#define PARALLEL_MAX_THREADS 64
 
 /* ------------------------------------------------------------------------- */
 
@@ -69,11 +80,6 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
 
 static const char *__io_error = "file I/O error";
 
-static void __config_list_destroy(config_list_t *list);
-static void __config_write_setting(const config_t *config,
-                                   const config_setting_t *setting,
-                                   FILE *stream, int depth);
-
 /* ------------------------------------------------------------------------- */
 
 #ifdef LIBCONFIG_ASSERTS
@@ -156,9 +162,9 @@ static void __config_indent(FILE *stream, int depth, unsigned short w)
 
 /* ------------------------------------------------------------------------- */
 
-static void __config_write_value(const config_t *config,
-                                 const config_value_t *value, int type,
-                                 int format, int depth, FILE *stream)
+static void __config_write_scalar(const config_t *config,
+                                  const config_value_t *value, int type,
+                                  int format, FILE *stream)
 {
   /* Long enough for 64-bit binary value + NULL terminator. */
   char value_buf[(sizeof(int64_t) * BITS_IN_BYTE) + 1];
@@ -229,9 +235,20 @@ static void __config_write_value(const config_t *config,
     {
       const int sci_ok = config_get_option(
             config, CONFIG_OPTION_ALLOW_SCIENTIFIC_NOTATION);
-      libconfig_format_double(value->fval, config->float_precision, sci_ok,
-                              value_buf, sizeof(value_buf));
-      fputs(value_buf, stream);
+
+      if(config_get_option(config, CONFIG_OPTION_ROUND_TRIP_FLOATS))
+      {
+        char float_buf[FORMAT_DOUBLE_SHORTEST_BUFSIZE];
+
+        libconfig_format_double_shortest(value->fval, sci_ok, float_buf);
+        fputs(float_buf, stream);
+      }
+      else
+      {
+        libconfig_format_double(value->fval, config->float_precision, sci_ok,
+                                value_buf, sizeof(value_buf));
+        fputs(value_buf, stream);
+      }
       break;
     }
 
@@ -283,116 +300,214 @@ static void __config_write_value(const config_t *config,
       break;
     }
 
-    /* list */
-    case CONFIG_TYPE_LIST:
-    {
-      config_list_t *list = value->list;
-
-      fputs("( ", stream);
+    default:
+      /* this shouldn't happen, but handle it gracefully... */
+      fputs("???", stream);
+      break;
+  }
+}
 
-      if(list)
-      {
-        int len = list->length;
-        config_setting_t **s;
+/* ------------------------------------------------------------------------- */
 
-        for(s = list->elements; len--; s++)
-        {
-          __config_write_value(config, &((*s)->value), (*s)->type,
-                               config_setting_get_format(*s), depth + 1,
-                               stream);
+/* A setting is written either as a bare value, as it appears in a list or
+ * array, or as a member with its name and terminator, as it appears in a
+ * group. WRITE_TEXT omits the line break that follows a member.
+ */
+#define WRITE_VALUE   0
+#define WRITE_TEXT    1
+#define WRITE_SETTING 2
 
-          if(len)
-            fputc(',', stream);
+struct config_writer_t
+{
+  const config_t *config;
+  const config_setting_t *top;
+  FILE *stream;
+  int depth;
+  int mode;
+  char group_assign_char;
+  char nongroup_assign_char;
+  int semicolons;
+  int brace_on_separate_line;
+};
 
-          fputc(' ', stream);
-        }
-      }
+/* ------------------------------------------------------------------------- */
 
-      fputc(')', stream);
-      break;
-    }
+static int __config_writer_is_member(const struct config_writer_t *writer,
+                                     const config_setting_t *setting)
+{
+  if(setting == writer->top)
+    return(writer->mode != WRITE_VALUE);
 
-    /* array */
-    case CONFIG_TYPE_ARRAY:
-    {
-      config_list_t *list = value->list;
+  return(setting->parent->type == CONFIG_TYPE_GROUP);
+}
 
-      fputs("[ ", stream);
+/* ------------------------------------------------------------------------- */
 
-      if(list)
-      {
-        int len = list->length;
-        config_setting_t **s;
+static int __config_writer_enter(config_setting_t *setting,
+                                 unsigned int walk_depth, void *user)
+{
+  const struct config_writer_t *writer = (const struct config_writer_t *)user;
+  FILE *stream = writer->stream;
+  int depth = writer->depth + (int)walk_depth;
 
-        for(s = list->elements; len--; s++)
-        {
-          __config_write_value(config, &((*s)->value), (*s)->type,
-                               config_setting_get_format(*s), depth + 1,
-                               stream);
+  if(__config_writer_is_member(writer, setting))
+  {
+    if(depth > 1)
+      __config_indent(stream, depth, writer->config->tab_width);
 
-          if(len)
-            fputc(',', stream);
+    if(setting->name)
+    {
+      fputs(setting->name, stream);
+      fprintf(stream, " %c ", ((setting->type == CONFIG_TYPE_GROUP)
+                               ? writer->group_assign_char
+                               : writer->nongroup_assign_char));
+    }
+  }
 
-          fputc(' ', stream);
-        }
-      }
+  switch(setting->type)
+  {
+    case CONFIG_TYPE_LIST:
+      fputs("( ", stream);
+      break;
 
-      fputc(']', stream);
+    case CONFIG_TYPE_ARRAY:
+      fputs("[ ", stream);
       break;
-    }
 
-    /* group */
     case CONFIG_TYPE_GROUP:
-    {
-      config_list_t *list = value->list;
-
       if(depth > 0)
       {
-        if(config_get_option(config, CONFIG_OPTION_OPEN_BRACE_ON_SEPARATE_LINE))
+        if(writer->brace_on_separate_line)
         {
           fputc('\n', stream);
 
           if(depth > 1)
-            __config_indent(stream, depth, config->tab_width);
+            __config_indent(stream, depth, writer->config->tab_width);
         }
 
         fputs("{\n", stream);
       }
+      break;
 
-      if(list)
-      {
-        int len = list->length;
-        config_setting_t **s;
+    default:
+      __config_write_scalar(writer->config, &(setting->value), setting->type,
+                            config_setting_get_format(setting), stream);
+      break;
+  }
 
-        for(s = list->elements; len--; s++)
-          __config_write_setting(config, *s, stream, depth + 1);
-      }
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __config_writer_leave(config_setting_t *setting,
+                                 unsigned int walk_depth, void *user)
+{
+  const struct config_writer_t *writer = (const struct config_writer_t *)user;
+  FILE *stream = writer->stream;
+  int depth = writer->depth + (int)walk_depth;
+
+  switch(setting->type)
+  {
+    case CONFIG_TYPE_LIST:
+      fputc(')', stream);
+      break;
+
+    case CONFIG_TYPE_ARRAY:
+      fputc(']', stream);
+      break;
 
+    case CONFIG_TYPE_GROUP:
       if(depth > 1)
-        __config_indent(stream, depth, config->tab_width);
+        __config_indent(stream, depth, writer->config->tab_width);
 
       if(depth > 0)
         fputc('}', stream);
-
       break;
-    }
 
     default:
-      /* this shouldn't happen, but handle it gracefully... */
-      fputs("???", stream);
       break;
   }
+
+  if(__config_writer_is_member(writer, setting))
+  {
+    if((depth > 0) && writer->semicolons)
+      fputc(';', stream);
+
+    if((depth > 0)
+       && ((setting != writer->top) || (writer->mode != WRITE_TEXT)))
+      fputc('\n', stream);
+  }
+  else if(setting != writer->top)
+  {
+    const config_list_t *list = setting->parent->value.list;
+
+    if(list->elements[list->length - 1] != setting)
+      fputc(',', stream);
+
+    fputc(' ', stream);
+  }
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_write_walk(const config_t *config,
+                                const config_setting_t *setting,
+                                FILE *stream, int depth, int mode)
+{
+  struct config_writer_t writer;
+
+  writer.config = config;
+  writer.top = setting;
+  writer.stream = stream;
+  writer.depth = depth;
+  writer.mode = mode;
+  writer.group_assign_char = config_get_option(
+    config, CONFIG_OPTION_COLON_ASSIGNMENT_FOR_GROUPS) ? ':' : '=';
+  writer.nongroup_assign_char = config_get_option(
+    config, CONFIG_OPTION_COLON_ASSIGNMENT_FOR_NON_GROUPS) ? ':' : '=';
+  writer.semicolons = config_get_option(
+    config, CONFIG_OPTION_SEMICOLON_SEPARATORS);
+  writer.brace_on_separate_line = config_get_option(
+    config, CONFIG_OPTION_OPEN_BRACE_ON_SEPARATE_LINE);
+
+  config_walk((config_setting_t *)setting, __config_writer_enter,
+              __config_writer_leave, &writer);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Writes the value of a setting, without its name. */
+static void __config_write_value(const config_t *config,
+                                 const config_setting_t *setting,
+                                 int depth, FILE *stream)
+{
+  __config_write_walk(config, setting, stream, depth, WRITE_VALUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_list_reserve(config_list_t *list, unsigned int count)
+{
+  if(count > list->capacity)
+  {
+    list->elements = (config_setting_t **)libconfig_realloc(
+      list->elements, count * sizeof(config_setting_t *));
+    list->capacity = count;
+  }
 }
 
 /* ------------------------------------------------------------------------- */
 
 static void __config_list_add(config_list_t *list, config_setting_t *setting)
 {
-  if((list->length % CHUNK_SIZE) == 0)
+  if(list->length == list->capacity)
   {
-    list->elements = (config_setting_t **)libconfig_realloc(
-      list->elements,
-      (list->length + CHUNK_SIZE) * sizeof(config_setting_t *));
+    /* Grow geometrically so that appending n elements is O(n) overall. */
+    __config_list_reserve(list, (list->capacity < CHUNK_SIZE)
+                          ? CHUNK_SIZE : list->capacity * 2);
   }
 
   list->elements[list->length] = setting;
@@ -415,13 +530,16 @@ static config_setting_t *__config_list_search(config_list_t *list,
   if(! list || ! name)
     return(NULL);
 
+  /* The name is not NUL-terminated, but contains no NULs, so strncmp() can
+   * only match a name that is at least namelen characters long.
+   */
   for(i = 0, found = list->elements; i < list->length; i++, found++)
   {
     if(! (*found)->name)
       continue;
 
-    if((strlen((*found)->name) == namelen)
-        && !strncmp(name, (*found)->name, namelen))
+    if(!strncmp(name, (*found)->name, namelen)
+       && ((*found)->name[namelen] == '\0'))
     {
       if(idx)
         *idx = i;
@@ -454,96 +572,1109 @@ static config_setting_t *__config_list_remove(config_list_t *list, int idx)
 
 /* ------------------------------------------------------------------------- */
 
+/* Frees a setting whose children, if any, have been freed already. */
+static int __config_setting_free(config_setting_t *setting,
+                                 unsigned int depth, void *user)
+{
+  (void)depth;
+  (void)user;
+
+  if(setting->name)
+    __delete(setting->name);
+
+  if(setting->type == CONFIG_TYPE_STRING)
+    __delete(setting->value.sval);
+
+  else if(config_setting_is_aggregate(setting) && setting->value.list)
+  {
+    __delete(setting->value.list->elements);
+    __delete(setting->value.list);
+  }
+
+  if(setting->hook && setting->config->destructor)
+    setting->config->destructor(setting->hook);
+
+  __delete(setting);
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
 static void __config_setting_destroy(config_setting_t *setting)
 {
-  if(setting)
+  config_walk(setting, NULL, __config_setting_free, NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Discards the cached hashes of a setting whose content is about to change,
+ * and of its ancestors. A setting's hash is only ever computed along with
+ * those of its descendants, so the walk can stop at the first setting that
+ * has no hash.
+ */
+static void __config_setting_touch(config_setting_t *setting)
+{
+  /* Record indexes and path tables built before the change are out of
+   * date, as is the source text of the setting and its ancestors.
+   */
+  if(setting && setting->config)
   {
-    if(setting->name)
-      __delete(setting->name);
+    config_t *config = setting->config;
+
+    ++(config->generation);
+
+    if(config->frozen)
+    {
+      libconfig_frozen_destroy(config->frozen);
+      config->frozen = NULL;
+    }
+
+    if(config->srcmap)
+      libconfig_srcmap_touch(config->srcmap, setting);
+  }
+
+  for(; setting && setting->hash; setting = setting->parent)
+    setting->hash = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Records a change to a setting in its configuration's journal, if there is
+ * one. Returns CONFIG_TRUE, for the convenience of the setters.
+ */
+static int __config_setting_changed(config_setting_t *setting, char type)
+{
+  if(setting->config && setting->config->journal)
+    libconfig_journal_append(setting->config, type, setting);
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Builds the journal record of the removal of a setting, which names the
+ * setting by its path, while the setting is still in the tree. The record is
+ * written by __config_setting_removed() once the setting is gone, so that a
+ * compaction triggered by the record writes the configuration without it.
+ * Returns the configuration whose journal holds the record, or NULL.
+ */
+static config_t *__config_setting_removing(config_setting_t *setting)
+{
+  config_t *config = setting->config;
+
+  if(! config || ! config->journal)
+    return(NULL);
+
+  libconfig_journal_prepare(config, JOURNAL_REMOVE, setting);
+  return(config);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_setting_removed(config_t *journaled)
+{
+  if(journaled)
+    libconfig_journal_commit(journaled);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __config_list_checktype(const config_setting_t *setting, int type)
+{
+  /* if the array is empty, then it has no type yet */
+
+  if(! setting->value.list)
+    return(CONFIG_TRUE);
+
+  if(setting->value.list->length == 0)
+    return(CONFIG_TRUE);
+
+  /* if it's a list, any type is allowed */
+
+  if(setting->type == CONFIG_TYPE_LIST)
+    return(CONFIG_TRUE);
+
+  /* otherwise the first element added determines the type of the array */
+
+  return((setting->value.list->elements[0]->type == type)
+         ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __config_type_is_scalar(int type)
+{
+  return((type >= CONFIG_TYPE_INT) && (type <= CONFIG_TYPE_BOOL));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __config_validate_name(const char *name)
+{
+  const char *p = name;
+
+  if(*p == '\0')
+    return(CONFIG_FALSE);
+
+  if(! isalpha((int)*p) && (*p != '*'))
+    return(CONFIG_FALSE);
+
+  for(++p; *p; ++p)
+  {
+    if(! (isalpha((int)*p) || isdigit((int)*p) || strchr("*_-", (int)*p)))
+      return(CONFIG_FALSE);
+  }
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __config_count_setting(config_setting_t *setting,
+                                  unsigned int depth, void *user)
+{
+  (void)depth;
+
+  ++((unsigned long *)user)[setting->type];
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_read_begin(config_t *config,
+                                struct parse_context *parse_ctx,
+                                struct scan_context *scan_ctx,
+                                const char *filename)
+{
+  config_clear(config);
+
+  libconfig_parsectx_init(parse_ctx);
+  parse_ctx->config = config;
+  parse_ctx->parent = config->root;
+  parse_ctx->setting = config->root;
+
+  libconfig_scanctx_init(scan_ctx, filename);
+  config->root->file = libconfig_scanctx_current_filename(scan_ctx);
+  scan_ctx->config = config;
+  scan_ctx->timing = config_get_option(config, CONFIG_OPTION_PHASE_TIMING);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Finishes a read, once the scanner has been destroyed, and records its
+ * statistics.
+ */
+static void __config_read_end(config_t *config,
+                              struct parse_context *parse_ctx,
+                              struct scan_context *scan_ctx,
+                              unsigned long allocations,
+                              unsigned long long read_ns)
+{
+  config_stats_t *stats = config->stats;
+
+  config->filenames = libconfig_scanctx_cleanup(scan_ctx);
+  libconfig_parsectx_cleanup(parse_ctx);
+
+  /* The settings are counted as they are read, unless some of them were
+   * overridden by others, which is rare enough to count the tree instead.
+   * The root setting is not counted, as it was not read from the input.
+   */
+  if(parse_ctx->recount)
+  {
+    memset(stats->settings, 0, sizeof(stats->settings));
+    config_walk(config->root, __config_count_setting, NULL, stats->settings);
+    --(stats->settings[CONFIG_TYPE_GROUP]);
+  }
+  else
+    memcpy(stats->settings, parse_ctx->settings, sizeof(stats->settings));
+
+  stats->bytes_scanned = scan_ctx->bytes_scanned;
+  stats->tokens = scan_ctx->tokens;
+  stats->files_included = scan_ctx->files_included;
+  stats->peak_string_size = scan_ctx->peak_string_size;
+  stats->allocations = allocations;
+  stats->read_ns = read_ns;
+  stats->include_ns = scan_ctx->include_ns;
+
+  if(scan_ctx->timing)
+  {
+    stats->scan_ns = scan_ctx->scan_ns - scan_ctx->include_ns;
+    stats->parse_ns = stats->read_ns - scan_ctx->scan_ns;
+  }
+  else
+    stats->scan_ns = stats->parse_ns = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* One piece of the input to a parallel read, and the result of parsing it. */
+struct parse_chunk
+{
+  config_t *config;
+  config_t shadow; /* receives the settings read, and any parse error */
+  const char *filename;
+  const char *str;
+  struct input_chunk input;
+  config_setting_t *root; /* a detached group holding the settings read */
+  struct scan_context scan_ctx;
+  int ok;
+  unsigned long settings[CONFIG_TYPE_LIST + 1]; /* read, by type */
+  int recount;
+  unsigned long allocations;
+  unsigned long long busy_ns;
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Moves a setting read by a parallel read from its chunk's private
+ * configuration to the configuration being read.
+ */
+static int __config_setting_adopt(config_setting_t *setting,
+                                  unsigned int depth, void *user)
+{
+  (void)depth;
+
+  setting->config = (config_t *)user;
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_parse_chunk(void *arg)
+{
+  struct parse_chunk *chunk = (struct parse_chunk *)arg;
+  struct fastscan fast;
+  struct parse_context parse_ctx;
+  unsigned long allocations = libconfig_allocation_count();
+  unsigned long long start = libconfig_time_ns();
+
+  /* The settings are built in the chunk's private copy of the
+   * configuration, since adding a setting updates its configuration, and
+   * the chunks are parsed concurrently.
+   */
+  chunk->root = __new(config_setting_t);
+  chunk->root->type = CONFIG_TYPE_GROUP;
+  chunk->root->config = &(chunk->shadow);
+
+  libconfig_parsectx_init(&parse_ctx);
+  parse_ctx.config = &(chunk->shadow);
+  parse_ctx.parent = chunk->root;
+  parse_ctx.setting = chunk->root;
+
+  /* The filename is borrowed from the main scan context; the input can't
+   * contain includes, so no other filenames are recorded.
+   */
+  libconfig_scanctx_init(&(chunk->scan_ctx), NULL);
+  chunk->scan_ctx.top_filename = chunk->filename;
+  chunk->scan_ctx.config = &(chunk->shadow);
+  chunk->scan_ctx.timing = config_get_option(chunk->config,
+                                             CONFIG_OPTION_PHASE_TIMING);
+
+  libconfig_fastscan_init(&fast, &(chunk->scan_ctx));
+  libconfig_fastscan_set_string(&fast, chunk->str + chunk->input.offset,
+                                chunk->input.length);
+  libconfig_fastscan_set_lineno(&fast, chunk->input.lineno);
+
+  chunk->ok = (libconfig_yyparse(NULL, &parse_ctx, &(chunk->scan_ctx)) == 0);
+  memcpy(chunk->settings, parse_ctx.settings, sizeof(chunk->settings));
+  chunk->recount = parse_ctx.recount;
+
+  libconfig_fastscan_cleanup(&fast);
+  libconfig_strvec_delete(libconfig_scanctx_cleanup(&(chunk->scan_ctx)));
+  libconfig_parsectx_cleanup(&parse_ctx);
+
+  /* Only this thread refers to the settings, so they can be handed over to
+   * the configuration here rather than in the merge.
+   */
+  config_walk(chunk->root, __config_setting_adopt, NULL, chunk->config);
+
+  chunk->allocations = libconfig_allocation_count() - allocations;
+  chunk->busy_ns = libconfig_time_ns() - start;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Moves the members of a chunk's root group to the end of ctx->parent, in
+ * order, checking for duplicates as the parser would have. Returns
+ * CONFIG_FALSE, leaving the members that were not moved in the chunk's root,
+ * if a duplicate is found.
+ */
+static int __config_splice_chunk(struct parse_context *ctx,
+                                 config_setting_t *chunk_root)
+{
+  config_list_t *list = chunk_root->value.list, *dest;
+  config_setting_t *setting;
+  unsigned int i;
+
+  if(! list)
+    return(CONFIG_TRUE);
+
+  if(! ctx->parent->value.list)
+    ctx->parent->value.list = __new(config_list_t);
+
+  dest = ctx->parent->value.list;
+  __config_list_reserve(dest, dest->length + list->length);
+
+  for(i = 0; i < list->length; ++i)
+  {
+    setting = list->elements[i];
+
+    if(! libconfig_parsectx_claim_member(ctx, setting))
+      break;
+
+    setting->parent = ctx->parent;
+    __config_list_add(dest, setting);
+  }
+
+  __config_setting_touch(ctx->parent);
+
+  list->length -= i;
+  memmove(list->elements, list->elements + i,
+          list->length * sizeof(config_setting_t *));
+
+  return(list->length == 0 ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Reads the 'len' bytes at 'str' by splitting them into chunks at top-level
+ * setting boundaries and parsing the chunks concurrently. Returns
+ * CONFIG_FALSE if the input could not be split, or if it could not be read
+ * this way, in which case the caller reads it again sequentially; this
+ * reports any error exactly as a sequential read would.
+ */
+static int __config_read_parallel(config_t *config, const char *filename,
+                                  const char *str, size_t len)
+{
+  struct input_chunk inputs[PARALLEL_MAX_THREADS];
+  struct parse_chunk *chunks, *chunk;
+  struct scan_context scan_ctx;
+  struct parse_context parse_ctx;
+  unsigned int threads = (config->parse_threads > 0)
+    ? config->parse_threads : libconfig_cpu_count();
+  unsigned int count, i, t;
+  size_t chunk_size;
+  unsigned long allocations = libconfig_allocation_count(), run_allocations;
+  unsigned long chunk_allocations = 0;
+  unsigned long long start = libconfig_time_ns(), run_ns, busy_ns = 0;
+  int ok = CONFIG_TRUE;
+
+  if(threads > PARALLEL_MAX_THREADS)
+    threads = PARALLEL_MAX_THREADS;
+
+  if((threads < 2) || (len < 2 * PARALLEL_MIN_CHUNK_SIZE))
+    return(CONFIG_FALSE);
+
+  chunk_size = len / threads;
+  if(chunk_size < PARALLEL_MIN_CHUNK_SIZE)
+    chunk_size = PARALLEL_MIN_CHUNK_SIZE;
+
+  count = libconfig_split_input(str, len, chunk_size, inputs, threads);
+  if(count < 2)
+    return(CONFIG_FALSE);
+
+  __config_read_begin(config, &parse_ctx, &scan_ctx, filename);
+
+  chunks = (struct parse_chunk *)libconfig_calloc(count,
+                                                  sizeof(struct parse_chunk));
+
+  for(i = 0, chunk = chunks; i < count; ++i, ++chunk)
+  {
+    chunk->config = config;
+    chunk->shadow = *config;
+    chunk->filename = libconfig_scanctx_current_filename(&scan_ctx);
+    chunk->str = str;
+    chunk->input = inputs[i];
+  }
+
+  run_allocations = libconfig_allocation_count();
+  run_ns = libconfig_time_ns();
+  libconfig_run_parallel(__config_parse_chunk, chunks,
+                         sizeof(struct parse_chunk), count);
+  run_ns = libconfig_time_ns() - run_ns;
+  run_allocations = libconfig_allocation_count() - run_allocations;
+
+  for(i = 0, chunk = chunks; i < count; ++i, ++chunk)
+    ok = ok && chunk->ok;
+
+  /* Once a chunk can't be spliced, the rest are only destroyed. */
+  for(i = 0, chunk = chunks; i < count; ++i, ++chunk)
+  {
+    if(ok)
+      ok = __config_splice_chunk(&parse_ctx, chunk->root);
+
+    __config_setting_destroy(chunk->root);
+
+    scan_ctx.bytes_scanned += chunk->scan_ctx.bytes_scanned;
+    scan_ctx.tokens += chunk->scan_ctx.tokens;
+    if(chunk->scan_ctx.peak_string_size > scan_ctx.peak_string_size)
+      scan_ctx.peak_string_size = chunk->scan_ctx.peak_string_size;
+    scan_ctx.scan_ns += chunk->scan_ctx.scan_ns;
+
+    chunk_allocations += chunk->allocations;
+    busy_ns += chunk->busy_ns;
+
+    for(t = 0; t <= CONFIG_TYPE_LIST; ++t)
+      parse_ctx.settings[t] += chunk->settings[t];
+    parse_ctx.recount = parse_ctx.recount || chunk->recount;
+  }
+
+  __delete(chunks);
+
+  /* The allocation counter is per-thread, so the allocations made while the
+   * chunks were parsed are taken from the chunks themselves.
+   */
+  __config_read_end(config, &parse_ctx, &scan_ctx,
+                    libconfig_allocation_count() - allocations
+                    - run_allocations + chunk_allocations,
+                    libconfig_time_ns() - start);
+
+  /* The time spent parsing is summed over all of the threads. */
+  if(scan_ctx.timing)
+    config->stats->parse_ns = config->stats->read_ns - run_ns + busy_ns
+      - scan_ctx.scan_ns;
+
+  return(ok);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Completes the source map of a configuration that has been read in its
+ * entirety; 'inner_end' is the end of the text of its last setting.
+ */
+static void __config_srcmap_seal(config_t *config, size_t inner_end)
+{
+  struct srcmap_span *span = libconfig_srcmap_span(config->srcmap,
+                                                   config->root);
+
+  span->inner_end = inner_end;
+  span->value_end = span->end = config->srcmap->length;
+
+  libconfig_srcmap_seal(config->srcmap);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Reads from 'stream' if it is not NULL, and from the 'len' bytes at 'str'
+ * otherwise. If 'consumed' is not NULL, the string is the caller's buffer,
+ * which is scanned in place, and the number of bytes of it that were scanned
+ * is stored at 'consumed'.
+ */
+static int __config_read(config_t *config, FILE *stream, const char *filename,
+                         const char *str, size_t len, size_t *consumed)
+{
+  yyscan_t scanner = NULL;
+  struct fastscan fast;
+  struct scan_context scan_ctx;
+  struct parse_context parse_ctx;
+  /* Spans are taken from the hand-written scanner, and a merged setting
+   * doesn't correspond to any one span.
+   */
+  int preserve = (config_get_option(config, CONFIG_OPTION_PRESERVE_FORMATTING)
+                  && ! config_get_option(config, CONFIG_OPTION_MERGE_OVERRIDES)
+                  && ! stream && ! consumed);
+  int use_fast = (config_get_option(config, CONFIG_OPTION_FAST_SCANNER)
+                  || consumed /* flex can only scan a copy of the input */
+                  || preserve);
+  unsigned long allocations = libconfig_allocation_count();
+  unsigned long long start = libconfig_time_ns();
+  int r;
+
+  if(! stream && ! consumed && ! preserve
+     && config_get_option(config, CONFIG_OPTION_PARALLEL_PARSE)
+     && __config_read_parallel(config, filename, str, len))
+    return(CONFIG_TRUE);
+
+  __config_read_begin(config, &parse_ctx, &scan_ctx, filename);
+
+  if(preserve)
+    parse_ctx.srcmap = config->srcmap = libconfig_srcmap_create(str, len);
+
+  if(use_fast)
+  {
+    libconfig_fastscan_init(&fast, &scan_ctx);
+
+    if(stream)
+      libconfig_fastscan_set_stream(&fast, stream);
+    else /* read from string */
+      libconfig_fastscan_set_string(&fast, str, len);
+  }
+  else
+  {
+    libconfig_yylex_init_extra(&scan_ctx, &scanner);
+
+    if(stream)
+      libconfig_yyrestart(stream, scanner);
+    else /* read from string */
+      (void)libconfig_yy_scan_bytes(str, (int)len, scanner);
+
+    libconfig_yyset_lineno(1, scanner);
+  }
+
+  r = libconfig_yyparse(scanner, &parse_ctx, &scan_ctx);
+
+  if(r != 0)
+  {
+    config->error_file = libconfig_scanctx_current_filename(&scan_ctx);
+    config->error_type = CONFIG_ERR_PARSE;
+
+    /* Unwind the include stack, freeing the buffers and closing the files.
+     * The hand-written scanner does this itself when it is cleaned up.
+     */
+    if(! use_fast)
+    {
+      YY_BUFFER_STATE buf;
+
+      while((buf = (YY_BUFFER_STATE)libconfig_scanctx_pop_include(&scan_ctx))
+            != NULL)
+        libconfig_yy_delete_buffer(buf, scanner);
+    }
+  }
+
+  if(consumed)
+    *consumed = libconfig_fastscan_consumed(&fast);
+
+  if(use_fast)
+    libconfig_fastscan_cleanup(&fast);
+  else
+    libconfig_yylex_destroy(scanner);
+
+  if(preserve)
+  {
+    /* The spans of settings read from included files are not in the text. */
+    if((r == 0) && (scan_ctx.files_included == 0))
+      __config_srcmap_seal(config, parse_ctx.span_cursor);
+    else
+    {
+      libconfig_srcmap_destroy(config->srcmap);
+      config->srcmap = NULL;
+    }
+  }
+
+  __config_read_end(config, &parse_ctx, &scan_ctx,
+                    libconfig_allocation_count() - allocations,
+                    libconfig_time_ns() - start);
+
+  return(r == 0 ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_read(config_t *config, FILE *stream)
+{
+  config_assert(config != NULL);
+  config_assert(stream != NULL);
+
+  return(__config_read(config, stream, NULL, NULL, 0, NULL));
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_read_string(config_t *config, const char *str)
+{
+  config_assert(config != NULL);
+  config_assert(str != NULL);
+
+  return(__config_read(config, NULL, NULL, str, strlen(str), NULL));
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_read_buffer(config_t *config, const char *buffer, size_t length,
+                       size_t *consumed)
+{
+  const char *nul;
+  size_t n;
+
+  config_assert(config != NULL);
+  config_assert(buffer != NULL || length == 0);
+
+  /* As with config_read_string(), a NUL byte ends the input. */
+  if(length > 0 && (nul = (const char *)memchr(buffer, '\0', length)) != NULL)
+    length = (size_t)(nul - buffer);
+
+  return(__config_read(config, NULL, NULL, length ? buffer : "", length,
+                       consumed ? consumed : &n));
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct config_parser_t
+{
+  config_t *config;
+  struct fastscan fast;
+  struct scan_context scan_ctx;
+  struct parse_context parse_ctx;
+  libconfig_yypstate *pstate;
+  int status; /* YYPUSH_MORE until the parse is complete */
+  unsigned long allocations;
+  unsigned long long read_ns;
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Feeds the parser tokens until the scanner runs out of input or the parse
+ * is complete, in which case the scanner and the contexts are released.
+ */
+static void __config_parser_run(config_parser_t *parser)
+{
+  struct scan_context *scan_ctx = &(parser->scan_ctx);
+  unsigned long allocations = libconfig_allocation_count();
+  unsigned long long start = libconfig_time_ns();
+
+  while(parser->status == YYPUSH_MORE)
+  {
+    YYSTYPE lval;
+    YYLTYPE loc;
+    unsigned long long scan_start = 0;
+    int token;
+
+    if(scan_ctx->timing)
+      scan_start = libconfig_time_ns();
+
+    token = libconfig_fastscan_lex(&lval, &(parser->fast));
+    loc.first = loc.last = 0; /* no source map when push parsing */
+
+    if(scan_ctx->timing)
+      scan_ctx->scan_ns += libconfig_time_ns() - scan_start;
+
+    if(token == FASTSCAN_MORE)
+      break;
+
+    if(token > 0)
+      ++(scan_ctx->tokens);
+
+    parser->status = libconfig_yypush_parse(parser->pstate, token, &lval,
+                                            &loc, NULL, &(parser->parse_ctx),
+                                            scan_ctx);
+  }
+
+  if(parser->status != YYPUSH_MORE)
+  {
+    config_t *config = parser->config;
+
+    if(parser->status != 0)
+    {
+      config->error_file = libconfig_scanctx_current_filename(scan_ctx);
+      config->error_type = CONFIG_ERR_PARSE;
+    }
+
+    libconfig_yypstate_delete(parser->pstate);
+    parser->pstate = NULL;
+    libconfig_fastscan_cleanup(&(parser->fast));
+  }
+
+  parser->allocations += libconfig_allocation_count() - allocations;
+  parser->read_ns += libconfig_time_ns() - start;
+
+  if(! parser->pstate)
+    __config_read_end(parser->config, &(parser->parse_ctx), scan_ctx,
+                      parser->allocations, parser->read_ns);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_parser_t *config_parser_new(config_t *config)
+{
+  config_parser_t *parser;
+
+  config_assert(config != NULL);
+
+  parser = __new(config_parser_t);
+  parser->config = config;
+  parser->status = YYPUSH_MORE;
+  parser->allocations = libconfig_allocation_count();
+  parser->read_ns = libconfig_time_ns();
+
+  __config_read_begin(config, &(parser->parse_ctx), &(parser->scan_ctx),
+                      NULL);
+  libconfig_fastscan_init(&(parser->fast), &(parser->scan_ctx));
+  libconfig_fastscan_set_partial(&(parser->fast));
+  parser->pstate = libconfig_yypstate_new();
+
+  parser->allocations = libconfig_allocation_count() - parser->allocations;
+  parser->read_ns = libconfig_time_ns() - parser->read_ns;
+
+  return(parser);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_parser_feed(config_parser_t *parser, const char *chunk,
+                       size_t len)
+{
+  const char *nul = NULL;
+
+  config_assert(parser != NULL);
+  config_assert(chunk != NULL || len == 0);
+
+  if(parser->status != YYPUSH_MORE)
+    return(parser->status == 0 ? CONFIG_TRUE : CONFIG_FALSE);
+
+  /* As with config_read_string(), a NUL byte ends the input. */
+  if(len > 0 && (nul = (const char *)memchr(chunk, '\0', len)) != NULL)
+    len = (size_t)(nul - chunk);
+
+  if(len > 0)
+    libconfig_fastscan_append(&(parser->fast), chunk, len);
+
+  if(nul)
+    libconfig_fastscan_end_input(&(parser->fast));
+
+  if(len > 0 || nul)
+    __config_parser_run(parser);
+
+  return(parser->status == 0 || parser->status == YYPUSH_MORE
+         ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_parser_finish(config_parser_t *parser)
+{
+  config_assert(parser != NULL);
+
+  if(parser->status == YYPUSH_MORE)
+  {
+    libconfig_fastscan_end_input(&(parser->fast));
+    __config_parser_run(parser);
+  }
+
+  return(parser->status == 0 ? CONFIG_TRUE : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_parser_destroy(config_parser_t *parser)
+{
+  if(! parser)
+    return;
+
+  /* An unfinished parse is abandoned, leaving whatever was read so far. */
+  if(parser->pstate)
+  {
+    libconfig_yypstate_delete(parser->pstate);
+    libconfig_fastscan_cleanup(&(parser->fast));
+    __config_read_end(parser->config, &(parser->parse_ctx),
+                      &(parser->scan_ctx), parser->allocations,
+                      parser->read_ns);
+  }
+
+  __delete(parser);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Writes a setting, without the line break that follows it. */
+static void __config_write_setting_text(const config_t *config,
+                                        const config_setting_t *setting,
+                                        FILE *stream, int depth)
+{
+  __config_write_walk(config, setting, stream, depth, WRITE_TEXT);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_write_setting(const config_t *config,
+                                   const config_setting_t *setting,
+                                   FILE *stream, int depth)
+{
+  __config_write_walk(config, setting, stream, depth, WRITE_SETTING);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_write_source(const struct config_srcmap_t *map,
+                                  size_t from, size_t to, FILE *stream)
+{
+  if(to > from)
+    fwrite(map->text + from, 1, to - from, stream);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __config_write_preserved(const config_t *config,
+                                     const config_setting_t *setting,
+                                     const struct srcmap_span *span,
+                                     FILE *stream, int depth);
+
+/* Returns the end of the white space and comments that follow 'pos' on the
+ * same line, including the line break. These belong to the setting before
+ * them, and a comment that spans lines to the setting after it.
+ */
+static size_t __config_source_line_end(const struct config_srcmap_t *map,
+                                       size_t pos)
+{
+  const char *text = map->text;
+  const char *close;
+
+  while(pos < map->length)
+  {
+    switch(text[pos])
+    {
+      case ' ': case '\t': case '\r':
+        ++pos;
+        break;
+
+      case '\n':
+        return(pos + 1);
+
+      case '#':
+        while((pos < map->length) && (text[pos] != '\n'))
+          ++pos;
+        break;
+
+      case '/':
+        if(text[pos + 1] == '/')
+        {
+          while((pos < map->length) && (text[pos] != '\n'))
+            ++pos;
+          break;
+        }
+
+        if((text[pos + 1] != '*') || !(close = strstr(text + pos + 2, "*/"))
+           || memchr(text + pos, '\n', (size_t)(close - (text + pos))))
+          return(pos);
+
+        pos = (size_t)(close + 2 - text);
+        break;
+
+      default:
+        return(pos);
+    }
+  }
+
+  return(pos);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Writes the rest of the line of the last element of an aggregate that was
+ * written, which ends at 'pos', and skips the elements after it that were
+ * removed. Returns the position of the text after the elements.
+ */
+static size_t __config_write_elements_end(const struct config_srcmap_t *map,
+                                          const struct srcmap_span *span,
+                                          size_t pos, int *newline,
+                                          FILE *stream)
+{
+  size_t next = __config_source_line_end(map, pos);
+
+  __config_write_source(map, pos, next, stream);
+  if(next > pos)
+    *newline = (map->text[next - 1] == '\n');
+
+  if(pos == span->inner_end)
+    return(next);
+
+  next = __config_source_line_end(map, span->inner_end);
+  if(*newline && (next < span->value_end) && (map->text[next] == '\n'))
+    ++next;
+
+  return(next);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Writes the value of an aggregate that was read from the source text,
+ * copying the text of its elements that are still there, and of everything
+ * around them, and writing new elements after them. The text of an element
+ * that has been removed is dropped, along with the white space and comments
+ * before it and on the rest of its last line.
+ */
+static void __config_write_preserved_elements(const config_t *config,
+                                              const config_setting_t *setting,
+                                              const struct srcmap_span *span,
+                                              FILE *stream, int depth)
+{
+  const struct config_srcmap_t *map = config->srcmap;
+  const config_list_t *list = setting->value.list;
+  size_t pos = span->inner, next;
+  unsigned int i, written = 0;
+  int separate = 0; /* the last element has no separator after it */
+  int newline = 0; /* the last thing written was a line break */
+  int closed = 0; /* the text of the elements has all been written */
+
+  __config_write_source(map, span->value, span->inner, stream);
+
+  for(i = 0; list && (i < list->length); ++i)
+  {
+    const config_setting_t *child = list->elements[i];
+    const struct srcmap_span *child_span = libconfig_srcmap_find(map, child);
+
+    if(child_span && ! closed && (child_span->gap >= pos)
+       && (child_span->end <= span->inner_end))
+    {
+      next = child_span->gap;
+      if(next > pos)
+      {
+        /* The elements before this one were removed. */
+        next = __config_source_line_end(map, pos);
+        __config_write_source(map, pos, next, stream);
+        next = __config_source_line_end(map, child_span->gap);
+      }
+
+      __config_write_source(map, next, child_span->begin, stream);
+      __config_write_preserved(config, child, child_span, stream, depth + 1);
+      pos = child_span->end;
+      separate = (child_span->end == child_span->value_end);
+      newline = 0;
+    }
+    else if(setting->type == CONFIG_TYPE_GROUP)
+    {
+      /* A new member goes on a line of its own. */
+      if(! closed)
+      {
+        pos = __config_write_elements_end(map, span, pos, &newline, stream);
+        closed = 1;
+      }
 
-    if(setting->type == CONFIG_TYPE_STRING)
-      __delete(setting->value.sval);
+      if(! newline)
+        fputc('\n', stream);
 
-    else if(config_setting_is_aggregate(setting))
-    {
-      if(setting->value.list)
-        __config_list_destroy(setting->value.list);
+      __config_write_setting_text(config, child, stream, depth + 1);
+      fputc('\n', stream);
+      newline = 1;
     }
+    else
+    {
+      if(written > 0)
+        fputs(separate ? ", " : " ", stream);
+      else if(! closed)
+      {
+        /* Keep the space after the open bracket. */
+        next = __config_source_line_end(map, pos);
+        __config_write_source(map, pos, next, stream);
+        pos = next;
+      }
 
-    if(setting->hook && setting->config->destructor)
-      setting->config->destructor(setting->hook);
+      __config_write_value(config, child, depth + 1, stream);
+      separate = 1;
+    }
 
-    __delete(setting);
+    ++written;
   }
+
+  if(! closed)
+    pos = __config_write_elements_end(map, span, pos, &newline, stream);
+
+  __config_write_source(map, pos, span->value_end, stream);
 }
 
 /* ------------------------------------------------------------------------- */
 
-static void __config_list_destroy(config_list_t *list)
+/* Writes a setting that was read from the source text. A setting that hasn't
+ * changed since is copied from the text; one whose span has been marked dirty
+ * by a change is written anew, apart from its name and terminator and the
+ * text around them.
+ */
+static void __config_write_preserved(const config_t *config,
+                                     const config_setting_t *setting,
+                                     const struct srcmap_span *span,
+                                     FILE *stream, int depth)
 {
-  config_setting_t **p;
-  unsigned int i;
+  const struct config_srcmap_t *map = config->srcmap;
 
-  if(! list)
+  if(! span->dirty)
+  {
+    __config_write_source(map, span->begin, span->end, stream);
     return;
+  }
 
-  if(list->elements)
-  {
-    for(p = list->elements, i = 0; i < list->length; p++, i++)
-      __config_setting_destroy(*p);
+  __config_write_source(map, span->begin, span->value, stream);
 
-    __delete(list->elements);
-  }
+  if(config_setting_is_aggregate(setting))
+    __config_write_preserved_elements(config, setting, span, stream, depth);
+  else
+    __config_write_value(config, setting, depth, stream);
 
-  __delete(list);
+  __config_write_source(map, span->value_end, span->end, stream);
 }
 
 /* ------------------------------------------------------------------------- */
 
-static int __config_list_checktype(const config_setting_t *setting, int type)
+void config_write(const config_t *config, FILE *stream)
 {
-  /* if the array is empty, then it has no type yet */
+  int set_locale;
+  unsigned long long start = libconfig_time_ns();
 
-  if(! setting->value.list)
-    return(CONFIG_TRUE);
+  config_assert(config != NULL);
+  config_assert(stream != NULL);
 
-  if(setting->value.list->length == 0)
-    return(CONFIG_TRUE);
+  /* Shortest round-trip formatting doesn't depend on the locale. */
+  set_locale = !config_get_option(config, CONFIG_OPTION_ROUND_TRIP_FLOATS);
 
-  /* if it's a list, any type is allowed */
+  if(set_locale)
+    __config_locale_override();
 
-  if(setting->type == CONFIG_TYPE_LIST)
-    return(CONFIG_TRUE);
+  if(config->srcmap)
+    __config_write_preserved(config, config->root,
+                             libconfig_srcmap_find(config->srcmap,
+                                                   config->root),
+                             stream, 0);
+  else
+    __config_write_setting(config, config->root, stream, 0);
 
-  /* otherwise the first element added determines the type of the array */
+  if(set_locale)
+    __config_locale_restore();
 
-  return((setting->value.list->elements[0]->type == type)
-         ? CONFIG_TRUE : CONFIG_FALSE);
+  /* The statistics are kept apart from the configuration proper, and are
+   * updated even though it is const; see the documentation of write_ns.
+   */
+  config->stats->write_ns = libconfig_time_ns() - start;
 }
 
 /* ------------------------------------------------------------------------- */
 
-static int __config_type_is_scalar(int type)
+int config_read_file(config_t *config, const char *filename)
 {
-  return((type >= CONFIG_TYPE_INT) && (type <= CONFIG_TYPE_BOOL));
+  int ret;
+  char *data;
+  size_t len;
+
+  config_assert(config != NULL);
+  config_assert(filename != NULL);
+
+  data = libconfig_io_read_file(config, filename, &len);
+  if(! data)
+  {
+    config->error_text = __io_error;
+    config->error_type = CONFIG_ERR_FILE_IO;
+    return(CONFIG_FALSE);
+  }
+
+  ret = __config_read(config, NULL, filename, data, len, NULL);
+
+  if(ret && config_get_option(config, CONFIG_OPTION_JOURNAL))
+    ret = libconfig_journal_open(config, filename, data, len);
+
+  __delete(data);
+
+  return(ret);
 }
 
 /* ------------------------------------------------------------------------- */
 
-static int __config_validate_name(const char *name)
+/* Writes all of the 'len' bytes at 'data' to the file 'fd'. */
+static int __config_write_fd(int fd, const char *data, size_t len)
 {
-  const char *p = name;
-
-  if(*p == '\0')
-    return(CONFIG_FALSE);
+  while(len > 0)
+  {
+    int n = posix_write(fd, data, (len > INT_MAX) ? INT_MAX : (int)len);
 
-  if(! isalpha((int)*p) && (*p != '*'))
-    return(CONFIG_FALSE);
+    if(n <= 0)
+    {
+      if((n < 0) && (errno == EINTR))
+        continue;
 
-  for(++p; *p; ++p)
-  {
-    if(! (isalpha((int)*p) || isdigit((int)*p) || strchr("*_-", (int)*p)))
       return(CONFIG_FALSE);
+    }
+
+    data += n;
+    len -= (size_t)n;
   }
 
   return(CONFIG_TRUE);
@@ -551,167 +1682,147 @@ static int __config_validate_name(const char *name)
 
 /* ------------------------------------------------------------------------- */
 
-static int __config_read(config_t *config, FILE *stream, const char *filename,
-                         const char *str)
+/* Flushes the directory entry of a file that has just been renamed into
+ * place to disk. This isn't possible, or necessary, on Windows, where the
+ * rename is written through.
+ */
+static int __config_sync_dir(const char *filename)
 {
-  yyscan_t scanner;
-  struct scan_context scan_ctx;
-  struct parse_context parse_ctx;
-  int r;
-
-  config_clear(config);
-
-  libconfig_parsectx_init(&parse_ctx);
-  parse_ctx.config = config;
-  parse_ctx.parent = config->root;
-  parse_ctx.setting = config->root;
-
-  __config_locale_override();
+#ifdef LIBCONFIG_WINDOWS_OS
 
-  libconfig_scanctx_init(&scan_ctx, filename);
-  config->root->file = libconfig_scanctx_current_filename(&scan_ctx);
-  scan_ctx.config = config;
-  libconfig_yylex_init_extra(&scan_ctx, &scanner);
+  (void)filename;
+  return(CONFIG_TRUE);
 
-  if(stream)
-    libconfig_yyrestart(stream, scanner);
-  else /* read from string */
-    (void)libconfig_yy_scan_string(str, scanner);
+#else
 
-  libconfig_yyset_lineno(1, scanner);
-  r = libconfig_yyparse(scanner, &parse_ctx, &scan_ctx);
+  const char *sep = strrchr(filename, '/');
+  size_t len = (sep == NULL) ? 0 : (sep == filename) ? 1
+    : (size_t)(sep - filename);
+  char *dir = (char *)libconfig_malloc(len + 2);
+  int fd, ok;
 
-  if(r != 0)
+  if(len == 0)
+    strcpy(dir, ".");
+  else
   {
-    YY_BUFFER_STATE buf;
-
-    config->error_file = libconfig_scanctx_current_filename(&scan_ctx);
-    config->error_type = CONFIG_ERR_PARSE;
-
-    /* Unwind the include stack, freeing the buffers and closing the files. */
-    while((buf = (YY_BUFFER_STATE)libconfig_scanctx_pop_include(&scan_ctx))
-          != NULL)
-      libconfig_yy_delete_buffer(buf, scanner);
+    memcpy(dir, filename, len);
+    dir[len] = '\0';
   }
 
-  libconfig_yylex_destroy(scanner);
-  config->filenames = libconfig_scanctx_cleanup(&scan_ctx);
-  libconfig_parsectx_cleanup(&parse_ctx);
-
-  __config_locale_restore();
-
-  return(r == 0 ? CONFIG_TRUE : CONFIG_FALSE);
-}
-
-/* ------------------------------------------------------------------------- */
-
-int config_read(config_t *config, FILE *stream)
-{
-  config_assert(config != NULL);
-  config_assert(stream != NULL);
+  fd = posix_open(dir, O_RDONLY);
+  ok = (fd >= 0);
 
-  return(__config_read(config, stream, NULL, NULL));
-}
+  /* Some file systems can't sync a directory, and say so with EINVAL. */
+  if(ok && (posix_fsync(fd) != 0) && (errno != EINVAL))
+    ok = CONFIG_FALSE;
 
-/* ------------------------------------------------------------------------- */
+  if(fd >= 0)
+    posix_close(fd);
 
-int config_read_string(config_t *config, const char *str)
-{
-  config_assert(config != NULL);
-  config_assert(str != NULL);
+  __delete(dir);
+  return(ok);
 
-  return(__config_read(config, NULL, NULL, str));
+#endif
 }
 
 /* ------------------------------------------------------------------------- */
 
-static void __config_write_setting(const config_t *config,
-                                   const config_setting_t *setting,
-                                   FILE *stream, int depth)
+/* Writes the configuration to a new file beside 'filename' and renames it
+ * over 'filename' once it is on disk, so that a reader of the file, or a
+ * crash, sees either the old contents or the new, but never a mix of the
+ * two. The configuration is rendered in memory first, where possible, so
+ * that it can be written with a single call.
+ */
+static int __config_write_file_atomic(config_t *config, const char *filename)
 {
-  char group_assign_char = config_get_option(
-    config, CONFIG_OPTION_COLON_ASSIGNMENT_FOR_GROUPS) ? ':' : '=';
-
-  char nongroup_assign_char = config_get_option(
-    config, CONFIG_OPTION_COLON_ASSIGNMENT_FOR_NON_GROUPS) ? ':' : '=';
-
-  if(depth > 1)
-    __config_indent(stream, depth, config->tab_width);
-
+  size_t temp_len = strlen(filename) + 16;
+  char *temp = (char *)libconfig_malloc(temp_len);
+  char *data = NULL;
+  size_t len = 0;
+  struct stat stbuf;
+  FILE *stream;
+  unsigned int seed;
+  int fd = -1, attempt, ok;
 
-  if(setting->name)
+#ifdef HAVE_OPEN_MEMSTREAM
+  stream = open_memstream(&data, &len);
+  ok = (stream != NULL);
+  if(ok)
   {
-    fputs(setting->name, stream);
-    fprintf(stream, " %c ", ((setting->type == CONFIG_TYPE_GROUP)
-                             ? group_assign_char
-                             : nongroup_assign_char));
+    config_write(config, stream);
+    ok = (fclose(stream) == 0);
   }
 
-  __config_write_value(config, &(setting->value), setting->type,
-                       config_setting_get_format(setting), depth, stream);
-
-  if(depth > 0)
+  if(! ok)
   {
-    if(config_get_option(config, CONFIG_OPTION_SEMICOLON_SEPARATORS))
-      fputc(';', stream);
-
-    fputc('\n', stream);
+    free(data); /* allocated by the C library */
+    __delete(temp);
+    return(CONFIG_FALSE);
   }
-}
-
-/* ------------------------------------------------------------------------- */
+#endif
 
-void config_write(const config_t *config, FILE *stream)
-{
-  config_assert(config != NULL);
-  config_assert(stream != NULL);
+  /* The name is made unique to this call from the process ID, the time and
+   * the address of the name buffer, which no other call in this process can
+   * hold at the same time. A name that is taken anyway is retried.
+   */
+  seed = (unsigned int)posix_getpid() ^ (unsigned int)time(NULL)
+    ^ (unsigned int)((size_t)temp >> 4);
 
-  __config_locale_override();
+  for(attempt = 0; (fd < 0) && (attempt < 100); ++attempt)
+  {
+    snprintf(temp, temp_len, "%s.%08X", filename,
+             seed + (unsigned int)attempt);
+    fd = posix_open(temp, O_WRONLY | O_CREAT | O_EXCL, 0666);
 
-  __config_write_setting(config, config->root, stream, 0);
+    if((fd < 0) && (errno != EEXIST))
+      break;
+  }
 
-  __config_locale_restore();
-}
+  ok = (fd >= 0);
 
-/* ------------------------------------------------------------------------- */
+#ifndef LIBCONFIG_WINDOWS_OS
+  /* Keep the permissions of the file being replaced. */
+  if(ok && (stat(filename, &stbuf) == 0))
+    ok = (fchmod(fd, stbuf.st_mode & 07777) == 0);
+#else
+  (void)stbuf;
+#endif
 
-int config_read_file(config_t *config, const char *filename)
-{
-  int ret, ok = 0;
-  FILE *stream;
+#ifdef HAVE_OPEN_MEMSTREAM
+  ok = ok && __config_write_fd(fd, data, len) && (posix_fsync(fd) == 0);
+  free(data);
 
-  config_assert(config != NULL);
-  config_assert(filename != NULL);
+  if(fd >= 0)
+    ok = (posix_close(fd) == 0) && ok;
+#else
+  (void)data;
+  (void)len;
 
-  stream = fopen(filename, "rt");
-  if(stream != NULL)
+  if(fd >= 0)
   {
-    /* On some operating systems, fopen() succeeds on a directory. */
-    int fd = posix_fileno(stream);
-    struct stat statbuf;
-
-    if(fstat(fd, &statbuf) == 0)
+    stream = fdopen(fd, "wt");
+    if(stream)
+    {
+      config_write(config, stream);
+      ok = ok && (fflush(stream) == 0) && (posix_fsync(fd) == 0);
+      ok = (fclose(stream) == 0) && ok;
+    }
+    else
     {
-      /* Only proceed if this is not a directory. */
-      if(!S_ISDIR(statbuf.st_mode))
-        ok = 1;
+      posix_close(fd);
+      ok = CONFIG_FALSE;
     }
   }
+#endif
 
-  if(!ok)
-  {
-    if(stream != NULL)
-      fclose(stream);
+  ok = ok && (posix_rename(temp, filename) == 0);
 
-    config->error_text = __io_error;
-    config->error_type = CONFIG_ERR_FILE_IO;
-    return(CONFIG_FALSE);
-  }
+  if((fd >= 0) && ! ok)
+    remove(temp);
 
-  ret = __config_read(config, stream, filename, NULL);
-  fclose(stream);
+  __delete(temp);
 
-  return(ret);
+  return(ok && __config_sync_dir(filename));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -723,6 +1834,19 @@ int config_write_file(config_t *config, const char *filename)
   config_assert(config != NULL);
   config_assert(filename != NULL);
 
+  if(config_get_option(config, CONFIG_OPTION_ATOMIC_WRITE))
+  {
+    if(! __config_write_file_atomic(config, filename))
+    {
+      config->error_text = __io_error;
+      config->error_type = CONFIG_ERR_FILE_IO;
+      return(CONFIG_FALSE);
+    }
+
+    config->error_type = CONFIG_ERR_NONE;
+    return(CONFIG_TRUE);
+  }
+
   stream = fopen(filename, "wt");
   if(stream == NULL)
   {
@@ -764,6 +1888,11 @@ void config_destroy(config_t *config)
   __config_setting_destroy(config->root);
   libconfig_strvec_delete(config->filenames);
   __delete(config->include_dir);
+  __delete(config->stats);
+  libconfig_dircache_destroy(config->dir_cache);
+  libconfig_srcmap_destroy(config->srcmap);
+  libconfig_journal_close(config->journal);
+  libconfig_frozen_destroy(config->frozen);
   __zero(config);
 }
 
@@ -775,10 +1904,20 @@ void config_clear(config_t *config)
 
   /* Destroy the root setting (recursively) and then create a new one. */
   __config_setting_destroy(config->root);
+  ++(config->generation);
+
+  libconfig_frozen_destroy(config->frozen);
+  config->frozen = NULL;
 
   libconfig_strvec_delete(config->filenames);
   config->filenames = NULL;
 
+  libconfig_srcmap_destroy(config->srcmap);
+  config->srcmap = NULL;
+
+  libconfig_journal_close(config->journal);
+  config->journal = NULL;
+
   config->root = __new(config_setting_t);
   config->root->type = CONFIG_TYPE_GROUP;
   config->root->config = config;
@@ -829,6 +1968,7 @@ void config_init(config_t *config)
 
   __zero(config);
   config_clear(config);
+  config->stats = __new(config_stats_t);
 
   /* Set default options. */
   config->options = (CONFIG_OPTION_SEMICOLON_SEPARATORS
@@ -837,6 +1977,7 @@ void config_init(config_t *config)
   config->tab_width = DEFAULT_TAB_WIDTH;
   config->float_precision = DEFAULT_FLOAT_PRECISION;
   config->include_fn = config_default_include_func;
+  config->io = &libconfig_default_io;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -880,6 +2021,24 @@ int config_get_option(const config_t *config, int option)
 
 /* ------------------------------------------------------------------------- */
 
+void config_set_parse_threads(config_t *config, unsigned int threads)
+{
+  config_assert(config != NULL);
+
+  config->parse_threads = threads;
+}
+
+/* ------------------------------------------------------------------------- */
+
+unsigned int config_get_parse_threads(const config_t *config)
+{
+  config_assert(config != NULL);
+
+  return(config->parse_threads);
+}
+
+/* ------------------------------------------------------------------------- */
+
 void config_set_hook(config_t *config, void *hook)
 {
   config_assert(config != NULL);
@@ -889,6 +2048,16 @@ void config_set_hook(config_t *config, void *hook)
 
 /* ------------------------------------------------------------------------- */
 
+void config_get_stats(const config_t *config, config_stats_t *stats)
+{
+  config_assert(config != NULL);
+  config_assert(stats != NULL);
+
+  *stats = *(config->stats);
+}
+
+/* ------------------------------------------------------------------------- */
+
 void config_set_fatal_error_func(config_fatal_error_fn_t func)
 {
   libconfig_set_fatal_error_func(func);
@@ -919,6 +2088,8 @@ static config_setting_t *__config_setting_create(config_setting_t *parent,
     list = parent->value.list = __new(config_list_t);
 
   __config_list_add(list, setting);
+  __config_setting_touch(parent);
+  __config_setting_changed(setting, JOURNAL_ADD);
 
   return(setting);
 }
@@ -1196,14 +2367,16 @@ int config_setting_set_int(config_setting_t *setting, int value)
       /* fall through */
 
     case CONFIG_TYPE_INT:
+      __config_setting_touch(setting);
       setting->value.ival = value;
-      return(CONFIG_TRUE);
+      return(__config_setting_changed(setting, JOURNAL_SET));
 
     case CONFIG_TYPE_FLOAT:
       if(config_get_auto_convert(setting->config))
       {
+        __config_setting_touch(setting);
         setting->value.fval = (float)value;
-        return(CONFIG_TRUE);
+        return(__config_setting_changed(setting, JOURNAL_SET));
       }
       else
         return(CONFIG_FALSE);
@@ -1226,14 +2399,16 @@ int config_setting_set_int64(config_setting_t *setting, long long value)
       /* fall through */
 
     case CONFIG_TYPE_INT64:
+      __config_setting_touch(setting);
       setting->value.llval = value;
-      return(CONFIG_TRUE);
+      return(__config_setting_changed(setting, JOURNAL_SET));
 
     case CONFIG_TYPE_INT:
       if((value >= INT32_MIN) && (value <= INT32_MAX))
       {
+        __config_setting_touch(setting);
         setting->value.ival = (int)value;
-        return(CONFIG_TRUE);
+        return(__config_setting_changed(setting, JOURNAL_SET));
       }
       else
         return(CONFIG_FALSE);
@@ -1241,8 +2416,9 @@ int config_setting_set_int64(config_setting_t *setting, long long value)
     case CONFIG_TYPE_FLOAT:
       if(config_get_auto_convert(setting->config))
       {
+        __config_setting_touch(setting);
         setting->value.fval = (float)value;
-        return(CONFIG_TRUE);
+        return(__config_setting_changed(setting, JOURNAL_SET));
       }
       else
         return(CONFIG_FALSE);
@@ -1265,14 +2441,16 @@ int config_setting_set_float(config_setting_t *setting, double value)
       /* fall through */
 
     case CONFIG_TYPE_FLOAT:
+      __config_setting_touch(setting);
       setting->value.fval = value;
-      return(CONFIG_TRUE);
+      return(__config_setting_changed(setting, JOURNAL_SET));
 
     case CONFIG_TYPE_INT:
       if(config_get_option(setting->config, CONFIG_OPTION_AUTOCONVERT))
       {
+        __config_setting_touch(setting);
         setting->value.ival = (int)value;
-        return(CONFIG_TRUE);
+        return(__config_setting_changed(setting, JOURNAL_SET));
       }
       else
         return(CONFIG_FALSE);
@@ -1280,8 +2458,9 @@ int config_setting_set_float(config_setting_t *setting, double value)
     case CONFIG_TYPE_INT64:
       if(config_get_option(setting->config, CONFIG_OPTION_AUTOCONVERT))
       {
+        __config_setting_touch(setting);
         setting->value.llval = (long long)value;
-        return(CONFIG_TRUE);
+        return(__config_setting_changed(setting, JOURNAL_SET));
       }
       else
         return(CONFIG_FALSE);
@@ -1328,8 +2507,9 @@ int config_setting_set_bool(config_setting_t *setting, int value)
   else if(setting->type != CONFIG_TYPE_BOOL)
     return(CONFIG_FALSE);
 
+  __config_setting_touch(setting);
   setting->value.ival = value;
-  return(CONFIG_TRUE);
+  return(__config_setting_changed(setting, JOURNAL_SET));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1370,12 +2550,14 @@ int config_setting_set_string(config_setting_t *setting, const char *value)
   else if(setting->type != CONFIG_TYPE_STRING)
     return(CONFIG_FALSE);
 
+  __config_setting_touch(setting);
+
   if(setting->value.sval)
     __delete(setting->value.sval);
 
   setting->value.sval = (value == NULL) ? NULL : strdup(value);
 
-  return(CONFIG_TRUE);
+  return(__config_setting_changed(setting, JOURNAL_SET));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1391,7 +2573,12 @@ int config_setting_set_format(config_setting_t *setting, unsigned short format)
          && (format != CONFIG_FORMAT_BIN)))
     return(CONFIG_FALSE);
 
-  setting->format = format;
+  if(setting->format != format)
+  {
+    __config_setting_touch(setting);
+    setting->format = format;
+    __config_setting_changed(setting, JOURNAL_FORMAT);
+  }
 
   return(CONFIG_TRUE);
 }
@@ -1408,35 +2595,81 @@ unsigned short config_setting_get_format(const config_setting_t *setting)
 
 /* ------------------------------------------------------------------------- */
 
-const config_setting_t *config_setting_lookup_const(
-  const config_setting_t *setting, const char *path)
+#define __is_path_token(C) (((C) != '\0') && strchr(PATH_TOKENS, (C)))
+
+/* Parses the index in a path element of the form "[index]", like strtol(),
+ * but without reading past the end of the path. As with strtol(), nothing
+ * is consumed if there are no digits, so that "[ ]" and "[-]" do not name
+ * an element.
+ */
+static const char *__config_path_index(const char *p, const char *end,
+                                       long *index)
+{
+  const char *start = p;
+  int neg = 0;
+  unsigned long val = 0;
+
+  while((p < end) && isspace((unsigned char)*p))
+    ++p;
+
+  if((p < end) && ((*p == '-') || (*p == '+')))
+    neg = (*(p++) == '-');
+
+  if((p == end) || ! isdigit((unsigned char)*p))
+  {
+    *index = 0;
+    return(start);
+  }
+
+  for(; (p < end) && isdigit((unsigned char)*p); ++p)
+  {
+    if(val <= (unsigned long)LONG_MAX)
+      val = (val * 10) + (unsigned long)(*p - '0');
+  }
+
+  if(val > (unsigned long)LONG_MAX)
+    val = (unsigned long)LONG_MAX;
+
+  *index = neg ? -(long)val : (long)val;
+
+  return(p);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_setting_t *config_setting_lookup_const_n(
+  const config_setting_t *setting, const char *path, size_t len)
 {
-  const char *p = path;
+  const char *p = path, *end = path + len;
   const config_setting_t *found = setting;
 
   config_assert(setting != NULL);
   config_assert(path != NULL);
 
-  while(*p && found)
+  while((p < end) && found)
   {
-    if(strchr(PATH_TOKENS, *p))
+    if(__is_path_token(*p))
       ++p;
 
-    if(*p == '[')
+    if((p < end) && (*p == '['))
     {
-      char *q;
-      long index = strtol(++p, &q, 10);
-      if(*q != ']')
+      long index;
+
+      p = __config_path_index(++p, end, &index);
+      if((p == end) || (*p != ']'))
         return NULL;
 
-      p = ++q;
+      ++p;
       found = config_setting_get_elem(found, index);
     }
     else if(found->type == CONFIG_TYPE_GROUP)
     {
       const char *q = p;
 
-      while(*q && !strchr(PATH_TOKENS, *q))
+      /* A NUL ends the element, and, since it is not a path token, the
+       * lookup.
+       */
+      while((q < end) && *q && !__is_path_token(*q))
         ++q;
 
       found = __config_list_search(found->value.list, p, (size_t)(q - p),
@@ -1447,7 +2680,18 @@ const config_setting_t *config_setting_lookup_const(
       break;
   }
 
-  return((*p || (found == setting)) ? NULL : found);
+  return(((p < end) || (found == setting)) ? NULL : found);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_setting_t *config_setting_lookup_const(
+  const config_setting_t *setting, const char *path)
+{
+  config_assert(setting != NULL);
+  config_assert(path != NULL);
+
+  return(config_setting_lookup_const_n(setting, path, strlen(path)));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1458,28 +2702,75 @@ config_setting_t *config_setting_lookup(const config_setting_t *setting,
   config_assert(setting != NULL);
   config_assert(path != NULL);
 
-  return((config_setting_t *)config_setting_lookup_const(setting, path));
+  return((config_setting_t *)config_setting_lookup_const(setting, path));
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *config_setting_lookup_n(const config_setting_t *setting,
+                                          const char *path, size_t len)
+{
+  config_assert(setting != NULL);
+  config_assert(path != NULL);
+
+  return((config_setting_t *)config_setting_lookup_const_n(setting, path,
+                                                           len));
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *config_lookup(const config_t *config, const char *path)
+{
+  config_assert(config != NULL);
+  config_assert(path != NULL);
+
+  return((config_setting_t *)config_lookup_const_n(config, path,
+                                                   strlen(path)));
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_setting_t *config_lookup_const(const config_t *config,
+                                            const char *path)
+{
+  config_assert(config != NULL);
+  config_assert(path != NULL);
+
+  return(config_lookup_const_n(config, path, strlen(path)));
 }
 
 /* ------------------------------------------------------------------------- */
 
-config_setting_t *config_lookup(const config_t *config, const char *path)
+config_setting_t *config_lookup_n(const config_t *config, const char *path,
+                                  size_t len)
 {
   config_assert(config != NULL);
   config_assert(path != NULL);
 
-  return(config_setting_lookup(config->root, path));
+  return((config_setting_t *)config_lookup_const_n(config, path, len));
 }
 
 /* ------------------------------------------------------------------------- */
 
-const config_setting_t *config_lookup_const(const config_t *config,
-                                            const char *path)
+const config_setting_t *config_lookup_const_n(const config_t *config,
+                                              const char *path, size_t len)
 {
   config_assert(config != NULL);
   config_assert(path != NULL);
 
-  return(config_setting_lookup(config->root, path));
+  /* A frozen configuration has its canonical paths in a table; any other
+   * spelling of a path is looked up one element at a time.
+   */
+  if(config->frozen)
+  {
+    const config_setting_t *setting = libconfig_frozen_lookup(
+      config->frozen, path, len);
+
+    if(setting)
+      return(setting);
+  }
+
+  return(config_setting_lookup_const_n(config->root, path, len));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -1864,6 +3155,22 @@ config_setting_t *config_setting_get_member(const config_setting_t *setting,
 
 /* ------------------------------------------------------------------------- */
 
+config_setting_t *config_setting_get_member_n(const config_setting_t *setting,
+                                              const char *name, size_t len)
+{
+  config_assert(setting != NULL);
+
+  if(setting->type != CONFIG_TYPE_GROUP)
+    return(NULL);
+
+  if(!name || memchr(name, '\0', len))
+    return(NULL);
+
+  return(__config_list_search(setting->value.list, name, len, NULL));
+}
+
+/* ------------------------------------------------------------------------- */
+
 void config_set_destructor(config_t *config, void (*destructor)(void *))
 {
   config_assert(config != NULL);
@@ -1892,6 +3199,24 @@ void config_set_include_func(config_t *config, config_include_fn_t func)
 
 /* ------------------------------------------------------------------------- */
 
+void config_set_io(config_t *config, const config_io_t *io)
+{
+  config_assert(config != NULL);
+
+  config->io = io ? io : &libconfig_default_io;
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_io_t *config_get_io(const config_t *config)
+{
+  config_assert(config != NULL);
+
+  return(config->io);
+}
+
+/* ------------------------------------------------------------------------- */
+
 int config_setting_length(const config_setting_t *setting)
 {
   config_assert(setting != NULL);
@@ -1956,6 +3281,7 @@ int config_setting_remove(config_setting_t *parent, const char *name)
   config_setting_t *setting;
   const char *settingName;
   const char *lastFound;
+  config_t *journaled;
 
   if(! parent || !name)
     return(CONFIG_FALSE);
@@ -1987,8 +3313,11 @@ int config_setting_remove(config_setting_t *parent, const char *name)
                                       strlen(settingName), &idx)))
     return(CONFIG_FALSE);
 
+  journaled = __config_setting_removing(setting);
+  __config_setting_touch(setting->parent);
   __config_list_remove(setting->parent->value.list, idx);
   __config_setting_destroy(setting);
+  __config_setting_removed(journaled);
 
   return(CONFIG_TRUE);
 }
@@ -1999,6 +3328,7 @@ int config_setting_remove_elem(config_setting_t *parent, unsigned int idx)
 {
   config_list_t *list;
   config_setting_t *removed = NULL;
+  config_t *journaled;
 
   if(! parent)
     return(CONFIG_FALSE);
@@ -2013,8 +3343,32 @@ int config_setting_remove_elem(config_setting_t *parent, unsigned int idx)
   if(idx >= list->length)
     return(CONFIG_FALSE);
 
+  journaled = __config_setting_removing(list->elements[idx]);
+  __config_setting_touch(parent);
   removed = __config_list_remove(list, idx);
   __config_setting_destroy(removed);
+  __config_setting_removed(journaled);
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_setting_reserve(config_setting_t *setting, unsigned int count)
+{
+  config_list_t *list;
+
+  config_assert(setting != NULL);
+
+  if(! config_setting_is_aggregate(setting))
+    return(CONFIG_FALSE);
+
+  list = setting->value.list;
+
+  if(! list)
+    list = setting->value.list = __new(config_list_t);
+
+  __config_list_reserve(list, count);
 
   return(CONFIG_TRUE);
 }
@@ -2054,6 +3408,10 @@ const char **config_default_include_func(config_t *config,
   config_assert(config != NULL);
   config_assert(path != NULL);
 
+  if(config_get_option(config, CONFIG_OPTION_GLOB_INCLUDES)
+     && libconfig_is_glob_include(path))
+    return(libconfig_glob_include(config, include_dir, path, error));
+
   if(include_dir && IS_RELATIVE_PATH(path))
   {
     file = (char *)libconfig_malloc(strlen(include_dir) + strlen(path) + 2);
@@ -2094,3 +3452,380 @@ int config_setting_is_aggregate(const config_setting_t *setting)
 }
 
 /* ------------------------------------------------------------------------- */
+
+#define WALK_STACK_SIZE 64
+
+/* The walk keeps the index of the child being visited at each level on a
+ * stack of its own rather than recursing, so that it can go as deep as the
+ * tree does. A setting may be destroyed by the post-order callback, since
+ * nothing is read from it afterward but through its parent.
+ */
+int config_walk(config_setting_t *setting, config_walk_fn_t pre,
+                config_walk_fn_t post, void *user)
+{
+  unsigned int local[WALK_STACK_SIZE];
+  unsigned int *stack = local, capacity = WALK_STACK_SIZE, depth = 0;
+  int entering = 1, ok = CONFIG_TRUE;
+
+  if(! setting)
+    return(CONFIG_TRUE);
+
+  for(;;)
+  {
+    config_setting_t *parent;
+
+    if(entering)
+    {
+      int action = pre ? pre(setting, depth, user) : CONFIG_WALK_CONTINUE;
+      config_list_t *list = config_setting_is_aggregate(setting)
+        ? setting->value.list : NULL;
+
+      if(action == CONFIG_WALK_STOP)
+      {
+        ok = CONFIG_FALSE;
+        break;
+      }
+
+      if((action != CONFIG_WALK_SKIP) && list && (list->length > 0))
+      {
+        if(depth == capacity)
+        {
+          unsigned int *grown = (unsigned int *)libconfig_malloc(
+            capacity * 2 * sizeof(unsigned int));
+
+          memcpy(grown, stack, capacity * sizeof(unsigned int));
+          if(stack != local)
+            __delete(stack);
+
+          stack = grown;
+          capacity *= 2;
+        }
+
+        stack[depth++] = 0;
+        setting = list->elements[0];
+        continue;
+      }
+    }
+
+    parent = setting->parent;
+
+    if(post && (post(setting, depth, user) == CONFIG_WALK_STOP))
+    {
+      ok = CONFIG_FALSE;
+      break;
+    }
+
+    if(depth == 0)
+      break;
+
+    if(++stack[depth - 1] < parent->value.list->length)
+    {
+      setting = parent->value.list->elements[stack[depth - 1]];
+      entering = 1;
+    }
+    else
+    {
+      setting = parent;
+      --depth;
+      entering = 0;
+    }
+  }
+
+  if(stack != local)
+    __delete(stack);
+
+  return(ok);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The finalizer of SplitMix64. */
+static unsigned long long __config_hash_mix(unsigned long long h)
+{
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+
+  return(h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned long long __config_hash_combine(unsigned long long h,
+                                                unsigned long long v)
+{
+  return(__config_hash_mix(h ^ (v + 0x9e3779b97f4a7c15ULL)));
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* FNV-1a, 64-bit. A NULL string hashes differently from an empty one. */
+static unsigned long long __config_hash_string(const char *s)
+{
+  unsigned long long h = 14695981039346656037ULL;
+  const unsigned char *p;
+
+  if(! s)
+    return(0);
+
+  for(p = (const unsigned char *)s; *p; ++p)
+  {
+    h ^= *p;
+    h *= 1099511628211ULL;
+  }
+
+  return(h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned long long __config_hash_float(double value)
+{
+  unsigned long long bits = 0;
+
+  memcpy(&bits, &value, (sizeof(value) < sizeof(bits))
+         ? sizeof(value) : sizeof(bits));
+
+  return(bits);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The hash covers a setting's type and value, and the names and hashes of
+ * its children, in order. Its own name, format, and source position are not
+ * included, so that settings can be compared wherever they are. The hashes
+ * of the children have been computed by the time this is called.
+ */
+static int __config_setting_hash_leave(config_setting_t *setting,
+                                       unsigned int depth, void *user)
+{
+  unsigned long long h;
+
+  (void)depth;
+  (void)user;
+
+  if(setting->hash)
+    return(CONFIG_WALK_CONTINUE);
+
+  h = __config_hash_mix(setting->type);
+
+  switch(setting->type)
+  {
+    case CONFIG_TYPE_INT:
+    case CONFIG_TYPE_BOOL:
+      h = __config_hash_combine(h, (unsigned long long)setting->value.ival);
+      break;
+
+    case CONFIG_TYPE_INT64:
+      h = __config_hash_combine(h, (unsigned long long)setting->value.llval);
+      break;
+
+    case CONFIG_TYPE_FLOAT:
+      h = __config_hash_combine(h, __config_hash_float(setting->value.fval));
+      break;
+
+    case CONFIG_TYPE_STRING:
+      h = __config_hash_combine(h, __config_hash_string(setting->value.sval));
+      break;
+
+    case CONFIG_TYPE_GROUP:
+    case CONFIG_TYPE_ARRAY:
+    case CONFIG_TYPE_LIST:
+    {
+      unsigned int i, len = (unsigned int)config_setting_length(setting);
+
+      h = __config_hash_combine(h, len);
+
+      for(i = 0; i < len; ++i)
+      {
+        config_setting_t *child = setting->value.list->elements[i];
+
+        h = __config_hash_combine(h, __config_hash_string(child->name));
+        h = __config_hash_combine(h, child->hash);
+      }
+
+      break;
+    }
+
+    default:
+      break;
+  }
+
+  setting->hash = (h == 0) ? 1 : h;
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* A setting whose hash is cached has the hashes of all of its descendants
+ * cached as well, so the walk doesn't descend into it.
+ */
+static int __config_setting_hash_enter(config_setting_t *setting,
+                                       unsigned int depth, void *user)
+{
+  (void)depth;
+  (void)user;
+
+  return(setting->hash ? CONFIG_WALK_SKIP : CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The hashes are cached in the settings, even though the setting is passed
+ * as const; as documented, this makes hashing a write to the configuration
+ * as far as threads are concerned.
+ */
+unsigned long long config_setting_hash(const config_setting_t *setting)
+{
+  config_assert(setting != NULL);
+
+  if(! setting->hash)
+    config_walk((config_setting_t *)setting, __config_setting_hash_enter,
+                __config_setting_hash_leave, NULL);
+
+  return(setting->hash);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#define EQUAL_STACK_SIZE 64
+
+/* A pair of settings still to be compared. */
+struct setting_pair
+{
+  const config_setting_t *a;
+  const config_setting_t *b;
+};
+
+/* Compares two scalar settings of the same type, or the lengths and the
+ * names of the children of two aggregates.
+ */
+static int __config_setting_equal_shallow(const config_setting_t *a,
+                                          const config_setting_t *b)
+{
+  switch(a->type)
+  {
+    case CONFIG_TYPE_INT:
+    case CONFIG_TYPE_BOOL:
+      return(a->value.ival == b->value.ival);
+
+    case CONFIG_TYPE_INT64:
+      return(a->value.llval == b->value.llval);
+
+    case CONFIG_TYPE_FLOAT:
+      return(__config_hash_float(a->value.fval)
+             == __config_hash_float(b->value.fval));
+
+    case CONFIG_TYPE_STRING:
+      if(! a->value.sval || ! b->value.sval)
+        return(a->value.sval == b->value.sval);
+
+      return(! strcmp(a->value.sval, b->value.sval));
+
+    case CONFIG_TYPE_GROUP:
+    case CONFIG_TYPE_ARRAY:
+    case CONFIG_TYPE_LIST:
+    {
+      unsigned int i, len = (unsigned int)config_setting_length(a);
+
+      if(len != (unsigned int)config_setting_length(b))
+        return(CONFIG_FALSE);
+
+      for(i = 0; i < len; ++i)
+      {
+        const char *na = a->value.list->elements[i]->name;
+        const char *nb = b->value.list->elements[i]->name;
+
+        if((na || nb) && (! na || ! nb || strcmp(na, nb)))
+          return(CONFIG_FALSE);
+      }
+
+      return(CONFIG_TRUE);
+    }
+
+    default:
+      return(CONFIG_TRUE);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* The pairs of children still to be compared are kept on a stack rather than
+ * recursed into, so that the comparison can go as deep as the trees do.
+ */
+static int __config_setting_equal(const config_setting_t *a,
+                                  const config_setting_t *b)
+{
+  struct setting_pair local[EQUAL_STACK_SIZE];
+  struct setting_pair *stack = local;
+  unsigned int capacity = EQUAL_STACK_SIZE, count = 0, i, len;
+  int equal = CONFIG_TRUE;
+
+  stack[count].a = a;
+  stack[count++].b = b;
+
+  while(equal && (count > 0))
+  {
+    --count;
+    a = stack[count].a;
+    b = stack[count].b;
+
+    if(a == b)
+      continue;
+
+    /* Settings whose hashes differ cannot be equal, so the comparison only
+     * descends into subtrees that might be.
+     */
+    if((config_setting_hash(a) != config_setting_hash(b))
+       || (a->type != b->type) || ! __config_setting_equal_shallow(a, b))
+    {
+      equal = CONFIG_FALSE;
+      break;
+    }
+
+    if(! config_setting_is_aggregate(a))
+      continue;
+
+    len = (unsigned int)config_setting_length(a);
+    if(count + len > capacity)
+    {
+      struct setting_pair *grown;
+
+      while(count + len > capacity)
+        capacity *= 2;
+
+      grown = (struct setting_pair *)libconfig_malloc(
+        capacity * sizeof(struct setting_pair));
+      memcpy(grown, stack, count * sizeof(struct setting_pair));
+      if(stack != local)
+        __delete(stack);
+
+      stack = grown;
+    }
+
+    for(i = 0; i < len; ++i)
+    {
+      stack[count].a = a->value.list->elements[i];
+      stack[count++].b = b->value.list->elements[i];
+    }
+  }
+
+  if(stack != local)
+    __delete(stack);
+
+  return(equal);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_setting_equal(const config_setting_t *a, const config_setting_t *b)
+{
+  config_assert(a != NULL);
+  config_assert(b != NULL);
+
+  return(__config_setting_equal(a, b));
+}
+
+/* ------------------------------------------------------------------------- */
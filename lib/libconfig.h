@@ -69,6 +69,17 @@ extern "C" {
 #define CONFIG_OPTION_ALLOW_SCIENTIFIC_NOTATION       0x20
 #define CONFIG_OPTION_FSYNC                           0x40
 #define CONFIG_OPTION_ALLOW_OVERRIDES                 0x80
+#define CONFIG_OPTION_FAST_SCANNER                    0x100
+#define CONFIG_OPTION_ROUND_TRIP_FLOATS               0x200
+#define CONFIG_OPTION_PHASE_TIMING                    0x400
+#define CONFIG_OPTION_GLOB_INCLUDES                   0x800
+#define CONFIG_OPTION_CACHE_INCLUDE_LISTINGS          0x1000
+#define CONFIG_OPTION_PARALLEL_PARSE                  0x2000
+#define CONFIG_OPTION_MERGE_OVERRIDES                 0x4000
+#define CONFIG_OPTION_MERGE_APPEND                    0x8000
+#define CONFIG_OPTION_PRESERVE_FORMATTING             0x10000
+#define CONFIG_OPTION_JOURNAL                         0x20000
+#define CONFIG_OPTION_ATOMIC_WRITE                    0x40000
 
 #define CONFIG_TRUE  (1)
 #define CONFIG_FALSE (0)
@@ -92,7 +103,9 @@ typedef struct config_setting_t
   struct config_t *config;
   void *hook;
   unsigned int line;
+  unsigned int span; /* in the source map, if any; 0 if none */
   const char *file;
+  unsigned long long hash; /* cached; 0 if not computed */
 } config_setting_t;
 
 typedef enum
@@ -106,6 +119,7 @@ typedef struct config_list_t
 {
   unsigned int length;
   config_setting_t **elements;
+  unsigned int capacity;
 } config_list_t;
 
 typedef const char ** (*config_include_fn_t)(struct config_t *,
@@ -115,6 +129,53 @@ typedef const char ** (*config_include_fn_t)(struct config_t *,
 
 typedef void (*config_fatal_error_fn_t)(const char *);
 
+typedef int (*config_walk_fn_t)(config_setting_t *setting, unsigned int depth,
+                                void *user);
+
+#define CONFIG_WALK_CONTINUE 0
+#define CONFIG_WALK_SKIP     1
+#define CONFIG_WALK_STOP     2
+
+#define CONFIG_IO_ERROR ((size_t)-1)
+
+typedef int (*config_query_fn_t)(config_setting_t *setting, void *user);
+
+typedef struct config_io_stat_t
+{
+  size_t size;
+  int is_dir;
+} config_io_stat_t;
+
+typedef struct config_io_t
+{
+  void *(*open)(void *ctx, const char *path);
+  size_t (*read)(void *ctx, void *file, char *buf, size_t len);
+  void (*close)(void *ctx, void *file);
+  int (*stat)(void *ctx, const char *path, config_io_stat_t *st);
+  void *ctx;
+} config_io_t;
+
+typedef struct config_bundle_t config_bundle_t;
+
+struct config_dir_cache_t; /* fwd decl */
+struct config_srcmap_t; /* fwd decl */
+struct config_journal_t; /* fwd decl */
+
+typedef struct config_stats_t
+{
+  size_t bytes_scanned;
+  unsigned long tokens;
+  unsigned long settings[CONFIG_TYPE_LIST + 1]; /* indexed by type */
+  unsigned int files_included;
+  size_t peak_string_size;
+  unsigned long allocations;
+  unsigned long long read_ns;
+  unsigned long long scan_ns;
+  unsigned long long parse_ns;
+  unsigned long long include_ns;
+  unsigned long long write_ns;
+} config_stats_t;
+
 typedef struct config_t
 {
   config_setting_t *root;
@@ -131,6 +192,15 @@ typedef struct config_t
   config_error_t error_type;
   const char **filenames;
   void *hook;
+  config_stats_t *stats;
+  const config_io_t *io;
+  struct config_dir_cache_t *dir_cache;
+  unsigned int parse_threads;
+  struct config_srcmap_t *srcmap;
+  struct config_journal_t *journal;
+  size_t journal_limit;
+  unsigned long generation;
+  struct config_frozen_t *frozen;
 } config_t;
 
 extern LIBCONFIG_API int config_read(config_t *config, FILE *stream);
@@ -147,12 +217,29 @@ extern LIBCONFIG_API void config_set_option(config_t *config, int option,
 extern LIBCONFIG_API int config_get_option(const config_t *config, int option);
 
 extern LIBCONFIG_API int config_read_string(config_t *config, const char *str);
+extern LIBCONFIG_API int config_read_buffer(config_t *config,
+                                           const char *buffer, size_t length,
+                                           size_t *consumed);
+
+typedef struct config_parser_t config_parser_t;
+
+extern LIBCONFIG_API config_parser_t *config_parser_new(config_t *config);
+extern LIBCONFIG_API int config_parser_feed(config_parser_t *parser,
+                                           const char *chunk, size_t len);
+extern LIBCONFIG_API int config_parser_finish(config_parser_t *parser);
+extern LIBCONFIG_API void config_parser_destroy(config_parser_t *parser);
 
 extern LIBCONFIG_API int config_read_file(config_t *config,
                                           const char *filename);
 extern LIBCONFIG_API int config_write_file(config_t *config,
                                            const char *filename);
 
+extern LIBCONFIG_API int config_journal_compact(config_t *config);
+extern LIBCONFIG_API int config_freeze(config_t *config);
+extern LIBCONFIG_API void config_set_journal_limit(config_t *config,
+                                                   size_t limit);
+extern LIBCONFIG_API size_t config_get_journal_limit(const config_t *config);
+
 extern LIBCONFIG_API void config_set_destructor(config_t *config,
                                                 void (*destructor)(void *));
 extern LIBCONFIG_API void config_set_include_dir(config_t *config,
@@ -160,6 +247,18 @@ extern LIBCONFIG_API void config_set_include_dir(config_t *config,
 extern LIBCONFIG_API void config_set_include_func(config_t *config,
                                                   config_include_fn_t func);
 
+extern LIBCONFIG_API void config_set_io(config_t *config,
+                                        const config_io_t *io);
+extern LIBCONFIG_API const config_io_t *config_get_io(const config_t *config);
+
+extern LIBCONFIG_API config_bundle_t *config_bundle_new(void);
+extern LIBCONFIG_API int config_bundle_add(config_bundle_t *bundle,
+                                           const char *path,
+                                           const char *data, size_t len);
+extern LIBCONFIG_API const config_io_t *config_bundle_io(
+  config_bundle_t *bundle);
+extern LIBCONFIG_API void config_bundle_destroy(config_bundle_t *bundle);
+
 extern LIBCONFIG_API void config_set_float_precision(config_t *config,
                                                      unsigned short digits);
 extern LIBCONFIG_API unsigned short config_get_float_precision(
@@ -170,8 +269,16 @@ extern LIBCONFIG_API void config_set_tab_width(config_t *config,
 extern LIBCONFIG_API unsigned short config_get_tab_width(
   const config_t *config);
 
+extern LIBCONFIG_API void config_set_parse_threads(config_t *config,
+                                                   unsigned int threads);
+extern LIBCONFIG_API unsigned int config_get_parse_threads(
+  const config_t *config);
+
 extern LIBCONFIG_API void config_set_hook(config_t *config, void *hook);
 
+extern LIBCONFIG_API void config_get_stats(const config_t *config,
+                                           config_stats_t *stats);
+
 #define config_get_hook(C) ((C)->hook)
 
 extern LIBCONFIG_API void config_init(config_t *config);
@@ -299,6 +406,15 @@ extern LIBCONFIG_API int config_setting_is_aggregate(
 
 extern LIBCONFIG_API int config_setting_index(const config_setting_t *setting);
 
+extern LIBCONFIG_API unsigned long long config_setting_hash(
+  const config_setting_t *setting);
+extern LIBCONFIG_API int config_setting_equal(const config_setting_t *a,
+                                              const config_setting_t *b);
+
+extern LIBCONFIG_API int config_walk(config_setting_t *setting,
+                                     config_walk_fn_t pre,
+                                     config_walk_fn_t post, void *user);
+
 extern LIBCONFIG_API int config_setting_length(
   const config_setting_t *setting);
 extern LIBCONFIG_API config_setting_t *config_setting_get_elem(
@@ -306,6 +422,8 @@ extern LIBCONFIG_API config_setting_t *config_setting_get_elem(
 
 extern LIBCONFIG_API config_setting_t *config_setting_get_member(
   const config_setting_t *setting, const char *name);
+extern LIBCONFIG_API config_setting_t *config_setting_get_member_n(
+  const config_setting_t *setting, const char *name, size_t len);
 
 extern LIBCONFIG_API config_setting_t *config_setting_add(
   config_setting_t *parent, const char *name, int type);
@@ -313,6 +431,8 @@ extern LIBCONFIG_API int config_setting_remove(config_setting_t *parent,
                                                const char *name);
 extern LIBCONFIG_API int config_setting_remove_elem(config_setting_t *parent,
                                                     unsigned int idx);
+extern LIBCONFIG_API int config_setting_reserve(config_setting_t *setting,
+                                                unsigned int count);
 extern LIBCONFIG_API void config_setting_set_hook(config_setting_t *setting,
                                                   void *hook);
 
@@ -328,6 +448,17 @@ extern LIBCONFIG_API config_setting_t *config_setting_lookup(
 extern LIBCONFIG_API const config_setting_t *config_setting_lookup_const(
   const config_setting_t *setting, const char *path);
 
+extern LIBCONFIG_API config_setting_t *config_lookup_n(const config_t *config,
+                                                       const char *path,
+                                                       size_t len);
+extern LIBCONFIG_API const config_setting_t *config_lookup_const_n(
+  const config_t *config, const char *path, size_t len);
+
+extern LIBCONFIG_API config_setting_t *config_setting_lookup_n(
+  const config_setting_t *setting, const char *path, size_t len);
+extern LIBCONFIG_API const config_setting_t *config_setting_lookup_const_n(
+  const config_setting_t *setting, const char *path, size_t len);
+
 extern LIBCONFIG_API int config_lookup_int(const config_t *config,
                                            const char *path, int *value);
 extern LIBCONFIG_API int config_lookup_int64(const config_t *config,
@@ -341,6 +472,48 @@ extern LIBCONFIG_API int config_lookup_string(const config_t *config,
                                               const char *path,
                                               const char **value);
 
+typedef struct config_overlay_t config_overlay_t;
+
+extern LIBCONFIG_API config_overlay_t *config_overlay_new(void);
+extern LIBCONFIG_API int config_overlay_push(config_overlay_t *overlay,
+                                             const config_t *config);
+extern LIBCONFIG_API void config_overlay_flush(config_overlay_t *overlay);
+extern LIBCONFIG_API const config_setting_t *config_overlay_lookup(
+  config_overlay_t *overlay, const char *path);
+extern LIBCONFIG_API int config_overlay_lookup_int(config_overlay_t *overlay,
+                                                   const char *path,
+                                                   int *value);
+extern LIBCONFIG_API int config_overlay_lookup_int64(
+  config_overlay_t *overlay, const char *path, long long *value);
+extern LIBCONFIG_API int config_overlay_lookup_float(
+  config_overlay_t *overlay, const char *path, double *value);
+extern LIBCONFIG_API int config_overlay_lookup_bool(config_overlay_t *overlay,
+                                                    const char *path,
+                                                    int *value);
+extern LIBCONFIG_API int config_overlay_lookup_string(
+  config_overlay_t *overlay, const char *path, const char **value);
+extern LIBCONFIG_API void config_overlay_destroy(config_overlay_t *overlay);
+
+typedef struct config_query_t config_query_t;
+
+extern LIBCONFIG_API config_query_t *config_query_compile(const char *expr);
+extern LIBCONFIG_API int config_query_run(const config_query_t *query,
+                                          config_setting_t *setting,
+                                          config_query_fn_t fn, void *user);
+extern LIBCONFIG_API void config_query_destroy(config_query_t *query);
+extern LIBCONFIG_API int config_query(config_t *config, const char *expr,
+                                      config_query_fn_t fn, void *user);
+
+typedef struct config_index_t config_index_t;
+
+extern LIBCONFIG_API config_index_t *config_setting_build_index(
+  config_setting_t *setting, const char *path);
+extern LIBCONFIG_API config_setting_t *config_index_find_int(
+  config_index_t *index, long long value);
+extern LIBCONFIG_API config_setting_t *config_index_find_string(
+  config_index_t *index, const char *value);
+extern LIBCONFIG_API void config_index_destroy(config_index_t *index);
+
 #define /* config_setting_t * */ config_root_setting( \
   /* const config_t * */ C)                           \
   ((C)->root)
@@ -26,6 +26,12 @@
 #include <stdio.h>
 #include <exception>
 #include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <optional>
+#include <string_view>
+#endif
 
 #if defined(_WIN32) || defined(__WIN32__) || defined(WIN32)
 #if defined(LIBCONFIGXX_STATIC)
@@ -51,6 +57,8 @@
 
 struct config_t; // fwd decl
 struct config_setting_t; // fwd decl
+struct config_overlay_t; // fwd decl
+struct config_index_t; // fwd decl
 
 namespace libconfig {
 
@@ -59,6 +67,9 @@ class LIBCONFIGXX_API ConfigException : public std::exception { };
 class Setting; // fwd decl
 class SettingIterator;
 class SettingConstIterator;
+class SettingView;
+class SettingViewIterator;
+class SettingViewDescendants;
 
 class LIBCONFIGXX_API SettingException : public ConfigException
 {
@@ -132,6 +143,13 @@ class LIBCONFIGXX_API FileIOException : public ConfigException
   virtual const char *what() const LIBCONFIGXX_NOEXCEPT;
 };
 
+class LIBCONFIGXX_API QueryException : public ConfigException
+{
+  public:
+
+  virtual const char *what() const LIBCONFIGXX_NOEXCEPT;
+};
+
 class LIBCONFIGXX_API ParseException : public ConfigException
 {
   public:
@@ -163,6 +181,8 @@ class LIBCONFIGXX_API ParseException : public ConfigException
 class LIBCONFIGXX_API Setting
 {
   friend class Config;
+  friend class ConfigStack;
+  friend class SettingView;
 
   public:
 
@@ -229,6 +249,40 @@ class LIBCONFIGXX_API Setting
   inline Setting & lookup(const std::string &path) const
   { return(lookup(path.c_str())); }
 
+  // Like lookup(), but returns a null view rather than throwing if there is
+  // no such setting.
+  SettingView tryLookup(const char *path) const;
+  SettingView tryLookup(const char *path, size_t length) const;
+  inline SettingView tryLookup(const std::string &path) const;
+
+  std::vector<SettingView> query(const char *expr) const;
+  inline std::vector<SettingView> query(const std::string &expr) const;
+#if __cplusplus >= 201703L
+  inline SettingView tryLookup(std::string_view path) const;
+#endif
+
+  // Returns the value of the setting at the given path, or defaultValue if
+  // there is no such setting or it cannot be converted to T. These never
+  // throw, and do not allocate unless T is std::string.
+  template<typename T, typename P>
+  inline T get(const P &path, const T &defaultValue) const
+  {
+    T value = T();
+    return(tryLookup(path).getValue(value) ? value : defaultValue);
+  }
+
+#if __cplusplus >= 201703L
+  template<typename T, typename P>
+  inline std::optional<T> get(const P &path) const
+  {
+    T value = T();
+    if(tryLookup(path).getValue(value))
+      return(value);
+
+    return(std::nullopt);
+  }
+#endif
+
   Setting & operator[](const char *name) const;
 
   inline Setting & operator[](const std::string &name) const
@@ -294,6 +348,7 @@ class LIBCONFIGXX_API Setting
   { return(exists(name.c_str())); }
 
   int getLength() const;
+  void reserve(unsigned int count);
   const char *getName() const;
   std::string getPath() const;
   int getIndex() const;
@@ -303,6 +358,9 @@ class LIBCONFIGXX_API Setting
 
   bool isRoot() const;
 
+  unsigned long long getHash() const;
+  bool isEqual(const Setting &other) const;
+
   inline bool isGroup() const
   { return(_type == TypeGroup); }
 
@@ -335,6 +393,9 @@ class LIBCONFIGXX_API Setting
   const_iterator begin() const;
   const_iterator end() const;
 
+  // Returns a range over all of the settings below this one, in pre-order.
+  SettingViewDescendants descendants() const;
+
   private:
 
   config_setting_t *_setting;
@@ -458,6 +519,391 @@ class LIBCONFIGXX_API SettingConstIterator
 
 SettingConstIterator operator+(int offset, const SettingConstIterator &si);
 
+// A pointer-sized, trivially copyable handle to a setting, with the read-only
+// part of the Setting API. Unlike a Setting, it is not allocated and attached
+// to the setting on first use, so visiting a large aggregate through views
+// allocates nothing. Copying or assigning a view never affects the setting it
+// refers to, and a view is only valid as long as that setting exists.
+
+class LIBCONFIGXX_API SettingView
+{
+  public:
+
+  typedef SettingViewIterator iterator;
+  typedef SettingViewIterator const_iterator;
+
+  inline SettingView()
+    : _setting(NULL) { }
+
+  explicit SettingView(const Setting &setting);
+
+  explicit inline SettingView(config_setting_t *setting)
+    : _setting(setting) { }
+
+  inline bool isNull() const
+  { return(_setting == NULL); }
+
+  inline bool operator==(const SettingView &other) const
+  { return(_setting == other._setting); }
+
+  inline bool operator!=(const SettingView &other) const
+  { return(_setting != other._setting); }
+
+  Setting::Type getType() const;
+  Setting::Format getFormat() const;
+
+  operator bool() const;
+  operator int() const;
+  operator unsigned int() const;
+  operator long() const;
+  operator unsigned long() const;
+  operator long long() const;
+  operator unsigned long long() const;
+  operator double() const;
+  operator float() const;
+  operator const char *() const;
+  operator std::string() const;
+
+  inline const char *c_str() const
+  { return operator const char *(); }
+
+  SettingView lookup(const char *path) const;
+  inline SettingView lookup(const std::string &path) const
+  { return(lookup(path.c_str())); }
+
+  SettingView tryLookup(const char *path) const;
+  SettingView tryLookup(const char *path, size_t length) const;
+  inline SettingView tryLookup(const std::string &path) const
+  { return(tryLookup(path.c_str())); }
+
+  // Returns the settings that match a query expression, which extends the
+  // path syntax with wildcards, slices and recursive descent.
+  std::vector<SettingView> query(const char *expr) const;
+  inline std::vector<SettingView> query(const std::string &expr) const
+  { return(query(expr.c_str())); }
+#if __cplusplus >= 201703L
+  inline SettingView tryLookup(std::string_view path) const
+  { return(tryLookup(path.data(), path.size())); }
+#endif
+
+  template<typename T, typename P>
+  inline T get(const P &path, const T &defaultValue) const
+  {
+    T value = T();
+    return(tryLookup(path).getValue(value) ? value : defaultValue);
+  }
+
+#if __cplusplus >= 201703L
+  template<typename T, typename P>
+  inline std::optional<T> get(const P &path) const
+  {
+    T value = T();
+    if(tryLookup(path).getValue(value))
+      return(value);
+
+    return(std::nullopt);
+  }
+#endif
+
+  SettingView operator[](const char *name) const;
+
+  inline SettingView operator[](const std::string &name) const
+  { return(operator[](name.c_str())); }
+
+  SettingView operator[](int index) const;
+
+  bool lookupValue(const char *name, bool &value) const;
+  bool lookupValue(const char *name, int &value) const;
+  bool lookupValue(const char *name, unsigned int &value) const;
+  bool lookupValue(const char *name, long long &value) const;
+  bool lookupValue(const char *name, unsigned long long &value) const;
+  bool lookupValue(const char *name, double &value) const;
+  bool lookupValue(const char *name, float &value) const;
+  bool lookupValue(const char *name, const char *&value) const;
+  bool lookupValue(const char *name, std::string &value) const;
+
+  inline bool lookupValue(const std::string &name, bool &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, int &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, unsigned int &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, long long &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name,
+                          unsigned long long &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, double &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, float &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, const char *&value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  inline bool lookupValue(const std::string &name, std::string &value) const
+  { return(lookupValue(name.c_str(), value)); }
+
+  bool exists(const char *name) const;
+
+  inline bool exists(const std::string &name) const
+  { return(exists(name.c_str())); }
+
+  // Store the value of this setting in value, converted as by the conversion
+  // operators. Returns false, leaving value unchanged, if the view is null
+  // or the value cannot be converted.
+  bool getValue(bool &value) const;
+  bool getValue(int &value) const;
+  bool getValue(unsigned int &value) const;
+  bool getValue(long long &value) const;
+  bool getValue(unsigned long long &value) const;
+  bool getValue(double &value) const;
+  bool getValue(float &value) const;
+  bool getValue(const char *&value) const;
+  bool getValue(std::string &value) const;
+
+  int getLength() const;
+  const char *getName() const;
+  std::string getPath() const;
+  int getIndex() const;
+
+  SettingView getParent() const;
+
+  bool isRoot() const;
+
+  inline bool isGroup() const
+  { return(getType() == Setting::TypeGroup); }
+
+  inline bool isArray() const
+  { return(getType() == Setting::TypeArray); }
+
+  inline bool isList() const
+  { return(getType() == Setting::TypeList); }
+
+  inline bool isAggregate() const
+  { return(getType() >= Setting::TypeGroup); }
+
+  inline bool isScalar() const
+  {
+    Setting::Type type = getType();
+    return((type > Setting::TypeNone) && (type < Setting::TypeGroup));
+  }
+
+  inline bool isNumber() const
+  {
+    Setting::Type type = getType();
+    return((type == Setting::TypeInt) || (type == Setting::TypeInt64)
+           || (type == Setting::TypeFloat));
+  }
+
+  inline bool isString() const
+  { return(getType() == Setting::TypeString); }
+
+  unsigned int getSourceLine() const;
+  const char *getSourceFile() const;
+
+  iterator begin() const;
+  iterator end() const;
+
+  // Returns a range over all of the settings below this one, in pre-order.
+  SettingViewDescendants descendants() const;
+
+  // Returns the Setting for the same setting, allocating it on first use,
+  // for access to the parts of the API that modify the configuration.
+  Setting & getSetting() const;
+
+  private:
+
+  config_setting_t *_setting;
+
+  bool isConvertibleTo(Setting::Type type) const;
+  void assertType(Setting::Type type) const;
+
+  friend class SettingIndex;
+};
+
+inline SettingView Setting::tryLookup(const std::string &path) const
+{ return(tryLookup(path.c_str())); }
+
+inline std::vector<SettingView> Setting::query(const std::string &expr) const
+{ return(query(expr.c_str())); }
+
+#if __cplusplus >= 201703L
+inline SettingView Setting::tryLookup(std::string_view path) const
+{ return(tryLookup(path.data(), path.size())); }
+#endif
+
+// A random-access iterator over the elements of an aggregate, as views. Like
+// an iterator over a std::vector, it is invalidated when elements are added
+// to or removed from the aggregate.
+
+class LIBCONFIGXX_API SettingViewIterator
+{
+  public:
+
+  // The result of operator->(), which holds the view that it points to.
+  struct Arrow
+  {
+    SettingView view;
+
+    inline const SettingView * operator->() const
+    { return(&view); }
+  };
+
+  inline SettingViewIterator()
+    : _elem(NULL) { }
+
+  explicit inline SettingViewIterator(config_setting_t * const *elem)
+    : _elem(elem) { }
+
+  // Equality comparison.
+  inline bool operator==(SettingViewIterator const &other) const
+  { return(_elem == other._elem); }
+
+  inline bool operator!=(SettingViewIterator const &other) const
+  { return(_elem != other._elem); }
+
+  inline bool operator<(SettingViewIterator const &other) const
+  { return(_elem < other._elem); }
+
+  // Dereference operators.
+  inline SettingView operator*() const
+  { return(SettingView(*_elem)); }
+
+  inline Arrow operator->() const
+  {
+    Arrow arrow = { SettingView(*_elem) };
+    return(arrow);
+  }
+
+  inline SettingView operator[](int offset) const
+  { return(SettingView(_elem[offset])); }
+
+  // Increment and decrement operators.
+  inline SettingViewIterator & operator++()
+  { ++_elem; return(*this); }
+
+  inline SettingViewIterator operator++(int)
+  { SettingViewIterator tmp(*this); ++_elem; return(tmp); }
+
+  inline SettingViewIterator & operator--()
+  { --_elem; return(*this); }
+
+  inline SettingViewIterator operator--(int)
+  { SettingViewIterator tmp(*this); --_elem; return(tmp); }
+
+  // Arithmetic operators.
+  inline SettingViewIterator operator+(int offset) const
+  { return(SettingViewIterator(_elem + offset)); }
+
+  inline SettingViewIterator & operator+=(int offset)
+  { _elem += offset; return(*this); }
+
+  inline SettingViewIterator operator-(int offset) const
+  { return(SettingViewIterator(_elem - offset)); }
+
+  inline SettingViewIterator & operator-=(int offset)
+  { _elem -= offset; return(*this); }
+
+  inline int operator-(const SettingViewIterator &other) const
+  { return(static_cast<int>(_elem - other._elem)); }
+
+  private:
+
+  config_setting_t * const *_elem;
+};
+
+inline SettingViewIterator operator+(int offset, const SettingViewIterator &si)
+{ return(si + offset); }
+
+// A forward iterator over the settings below an aggregate, as views, visiting
+// each setting before its elements. It keeps the path to the current setting
+// rather than recursing, so it handles nesting of any depth. It is
+// invalidated when settings are added to or removed from the tree below the
+// aggregate.
+
+class LIBCONFIGXX_API SettingViewRecursiveIterator
+{
+  public:
+
+  // The result of operator->(), which holds the view that it points to.
+  struct Arrow
+  {
+    SettingView view;
+
+    inline const SettingView * operator->() const
+    { return(&view); }
+  };
+
+  inline SettingViewRecursiveIterator()
+    : _setting(NULL) { }
+
+  // Positions the iterator at the first setting below the given aggregate.
+  explicit SettingViewRecursiveIterator(config_setting_t *setting);
+
+  // Equality comparison.
+  inline bool operator==(SettingViewRecursiveIterator const &other) const
+  { return(_setting == other._setting); }
+
+  inline bool operator!=(SettingViewRecursiveIterator const &other) const
+  { return(_setting != other._setting); }
+
+  // Dereference operators.
+  inline SettingView operator*() const
+  { return(SettingView(_setting)); }
+
+  inline Arrow operator->() const
+  {
+    Arrow arrow = { SettingView(_setting) };
+    return(arrow);
+  }
+
+  // The depth of the current setting below the aggregate; its elements are
+  // at depth 1.
+  inline unsigned int depth() const
+  { return(static_cast<unsigned int>(_path.size())); }
+
+  // Increment operators.
+  SettingViewRecursiveIterator & operator++();
+
+  inline SettingViewRecursiveIterator operator++(int)
+  { SettingViewRecursiveIterator tmp(*this); ++(*this); return(tmp); }
+
+  private:
+
+  config_setting_t *_setting;
+  std::vector<unsigned int> _path;
+};
+
+// The settings below an aggregate, for use in a range-based for loop.
+
+class LIBCONFIGXX_API SettingViewDescendants
+{
+  public:
+
+  typedef SettingViewRecursiveIterator iterator;
+  typedef SettingViewRecursiveIterator const_iterator;
+
+  explicit inline SettingViewDescendants(config_setting_t *setting)
+    : _setting(setting) { }
+
+  inline iterator begin() const
+  { return(iterator(_setting)); }
+
+  inline iterator end() const
+  { return(iterator()); }
+
+  private:
+
+  config_setting_t *_setting;
+};
+
 class LIBCONFIGXX_API Config
 {
   public:
@@ -472,12 +918,47 @@ class LIBCONFIGXX_API Config
     OptionOpenBraceOnSeparateLine = 0x10,
     OptionAllowScientificNotation = 0x20,
     OptionFsync = 0x40,
-    OptionAllowOverrides = 0x80
+    OptionAllowOverrides = 0x80,
+    OptionFastScanner = 0x100,
+    OptionRoundTripFloats = 0x200,
+    OptionPhaseTiming = 0x400,
+    OptionGlobIncludes = 0x800,
+    OptionCacheIncludeListings = 0x1000,
+    OptionParallelParse = 0x2000,
+    OptionMergeOverrides = 0x4000,
+    OptionMergeAppend = 0x8000,
+    OptionPreserveFormatting = 0x10000,
+    OptionJournal = 0x20000,
+    OptionAtomicWrite = 0x40000
+  };
+
+  struct Stats
+  {
+    size_t bytesScanned;
+    unsigned long tokens;
+    unsigned long settings[Setting::TypeList + 1]; // indexed by Setting::Type
+    unsigned int filesIncluded;
+    size_t peakStringSize;
+    unsigned long allocations;
+    unsigned long long readNanos;
+    unsigned long long scanNanos;
+    unsigned long long parseNanos;
+    unsigned long long includeNanos;
+    unsigned long long writeNanos;
   };
 
   Config();
   virtual ~Config();
 
+#if __cplusplus >= 201103L
+  // A Config moved from by construction is left empty; one moved from by
+  // assignment is left with the configuration this one held.
+  Config(Config &&other) noexcept;
+  Config& operator=(Config &&other) noexcept;
+#endif
+
+  void swap(Config &other) LIBCONFIGXX_NOEXCEPT;
+
   void clear();
 
   void setOptions(int options);
@@ -501,6 +982,12 @@ class LIBCONFIGXX_API Config
   void setFloatPrecision(unsigned short digits);
   unsigned short getFloatPrecision() const;
 
+  void setParseThreads(unsigned int threads);
+  unsigned int getParseThreads() const;
+
+  void setJournalLimit(size_t limit);
+  size_t getJournalLimit() const;
+
   void setIncludeDir(const char *includeDir);
   const char *getIncludeDir() const;
 
@@ -514,6 +1001,12 @@ class LIBCONFIGXX_API Config
   inline void readString(const std::string &str)
   { return(readString(str.c_str())); }
 
+  size_t readBuffer(const char *buffer, size_t length);
+#if __cplusplus >= 201703L
+  inline size_t readBuffer(std::string_view buffer)
+  { return(readBuffer(buffer.data(), buffer.size())); }
+#endif
+
   void readFile(const char *filename);
   inline void readFile(const std::string &filename)
   { readFile(filename.c_str()); }
@@ -522,10 +1015,46 @@ class LIBCONFIGXX_API Config
   inline void writeFile(const std::string &filename) const
   { writeFile(filename.c_str()); }
 
+  void compactJournal();
+  bool freeze();
+
   Setting & lookup(const char *path) const;
   inline Setting & lookup(const std::string &path) const
   { return(lookup(path.c_str())); }
 
+  // Returns a null view if there is no setting at the given path.
+  SettingView tryLookup(const char *path) const;
+  SettingView tryLookup(const char *path, size_t length) const;
+  inline SettingView tryLookup(const std::string &path) const
+  { return(tryLookup(path.c_str())); }
+
+  std::vector<SettingView> query(const char *expr) const;
+  inline std::vector<SettingView> query(const std::string &expr) const
+  { return(query(expr.c_str())); }
+#if __cplusplus >= 201703L
+  inline SettingView tryLookup(std::string_view path) const
+  { return(tryLookup(path.data(), path.size())); }
+#endif
+
+  template<typename T, typename P>
+  inline T get(const P &path, const T &defaultValue) const
+  {
+    T value = T();
+    return(tryLookup(path).getValue(value) ? value : defaultValue);
+  }
+
+#if __cplusplus >= 201703L
+  template<typename T, typename P>
+  inline std::optional<T> get(const P &path) const
+  {
+    T value = T();
+    if(tryLookup(path).getValue(value))
+      return(value);
+
+    return(std::nullopt);
+  }
+#endif
+
   bool exists(const char *path) const;
   inline bool exists(const std::string &path) const
   { return(exists(path.c_str())); }
@@ -570,6 +1099,8 @@ class LIBCONFIGXX_API Config
 
   Setting & getRoot() const;
 
+  Stats getStats() const;
+
   private:
 
   static void ConfigDestructor(void *arg);
@@ -578,10 +1109,99 @@ class LIBCONFIGXX_API Config
   config_t *_config;
   Setting::Format _defaultFormat;
 
+  void attach() LIBCONFIGXX_NOEXCEPT;
+
   Config(const Config& other); // not supported
   Config& operator=(const Config& other); // not supported
+
+  friend class ConfigStack;
+};
+
+// A read-only view of several configurations stacked on top of each other.
+// A lookup finds the setting in the topmost configuration that has it, and
+// its result is remembered. The configurations must outlive the stack, and
+// flush() must be called if any of them is modified.
+class LIBCONFIGXX_API ConfigStack
+{
+  public:
+
+  ConfigStack();
+  ~ConfigStack();
+
+  // Adds a configuration on top of the others.
+  void push(const Config &config);
+
+  void flush();
+
+  Setting & lookup(const char *path) const;
+  inline Setting & lookup(const std::string &path) const
+  { return(lookup(path.c_str())); }
+
+  SettingView tryLookup(const char *path) const;
+  inline SettingView tryLookup(const std::string &path) const
+  { return(tryLookup(path.c_str())); }
+
+  template<typename T, typename P>
+  inline T get(const P &path, const T &defaultValue) const
+  {
+    T value = T();
+    return(tryLookup(path).getValue(value) ? value : defaultValue);
+  }
+
+#if __cplusplus >= 201703L
+  template<typename T, typename P>
+  inline std::optional<T> get(const P &path) const
+  {
+    T value = T();
+    if(tryLookup(path).getValue(value))
+      return(value);
+
+    return(std::nullopt);
+  }
+#endif
+
+  bool exists(const char *path) const;
+  inline bool exists(const std::string &path) const
+  { return(exists(path.c_str())); }
+
+  private:
+
+  config_overlay_t *_overlay;
+
+  ConfigStack(const ConfigStack& other); // not supported
+  ConfigStack& operator=(const ConfigStack& other); // not supported
+};
+
+// An index of the groups in an aggregate by the value of a setting in each,
+// such as an id, for finding a record without scanning the aggregate. The
+// index is rebuilt on the next lookup after the configuration changes. The
+// aggregate must outlive the index.
+class LIBCONFIGXX_API SettingIndex
+{
+  public:
+
+  SettingIndex(const Setting &aggregate, const char *path);
+  SettingIndex(const SettingView &aggregate, const char *path);
+  ~SettingIndex();
+
+  // Return the first record whose key has the given value, or a null view.
+  SettingView find(int key) const;
+  SettingView find(long long key) const;
+  SettingView find(const char *key) const;
+  inline SettingView find(const std::string &key) const
+  { return(find(key.c_str())); }
+
+  private:
+
+  config_index_t *_index;
+
+  SettingIndex(const SettingIndex& other); // not supported
+  SettingIndex& operator=(const SettingIndex& other); // not supported
 };
 
+inline void swap(Config &a, Config &b) LIBCONFIGXX_NOEXCEPT
+{ a.swap(b); }
+
 } // namespace libconfig
 
 #endif // __libconfig_hpp
@@ -33,6 +33,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <sstream>
+#include <vector>
 
 namespace libconfig {
 
@@ -137,27 +138,117 @@ static int __toTypeCode(Setting::Type type)
 
 // ---------------------------------------------------------------------------
 
-static void __constructPath(const Setting &setting,
-                            std::stringstream &path)
+static Setting::Type __fromTypeCode(int typecode)
+{
+  Setting::Type type;
+
+  switch(typecode)
+  {
+    case CONFIG_TYPE_GROUP:
+      type = Setting::TypeGroup;
+      break;
+
+    case CONFIG_TYPE_INT:
+      type = Setting::TypeInt;
+      break;
+
+    case CONFIG_TYPE_INT64:
+      type = Setting::TypeInt64;
+      break;
+
+    case CONFIG_TYPE_FLOAT:
+      type = Setting::TypeFloat;
+      break;
+
+    case CONFIG_TYPE_STRING:
+      type = Setting::TypeString;
+      break;
+
+    case CONFIG_TYPE_BOOL:
+      type = Setting::TypeBoolean;
+      break;
+
+    case CONFIG_TYPE_ARRAY:
+      type = Setting::TypeArray;
+      break;
+
+    case CONFIG_TYPE_LIST:
+      type = Setting::TypeList;
+      break;
+
+    case CONFIG_TYPE_NONE:
+    default:
+      type = Setting::TypeNone;
+      break;
+  }
+
+  return(type);
+}
+
+// ---------------------------------------------------------------------------
+
+static Setting::Format __fromFormatCode(int formatcode)
+{
+  Setting::Format format;
+
+  switch(formatcode)
+  {
+    case CONFIG_FORMAT_HEX:
+      format = Setting::FormatHex;
+      break;
+
+    case CONFIG_FORMAT_BIN:
+      format = Setting::FormatBin;
+      break;
+
+    case CONFIG_FORMAT_OCT:
+      format = Setting::FormatOct;
+      break;
+
+    case CONFIG_FORMAT_DEFAULT:
+    default:
+      format = Setting::FormatDefault;
+      break;
+  }
+
+  return(format);
+}
+
+// ---------------------------------------------------------------------------
+
+static void __constructPath(SettingView setting, std::stringstream &path)
 {
-  // head recursion to print path from root to target
+  // collect the ancestors, then print the path from root to target
+
+  std::vector<SettingView> chain;
 
-  if(! setting.isRoot())
+  for(; ! setting.isRoot(); setting = setting.getParent())
+    chain.push_back(setting);
+
+  for(std::vector<SettingView>::reverse_iterator iter = chain.rbegin();
+      iter != chain.rend(); ++iter)
   {
-    __constructPath(setting.getParent(), path);
     if(path.tellp() > 0)
       path << '.';
 
-    const char *name = setting.getName();
+    const char *name = iter->getName();
     if(name)
       path << name;
     else
-      path << '[' << setting.getIndex() << ']';
+      path << '[' << iter->getIndex() << ']';
   }
 }
 
 // ---------------------------------------------------------------------------
 
+static void __constructPath(const Setting &setting,
+                            std::stringstream &path)
+{
+  __constructPath(SettingView(setting), path);
+}
+
+// ---------------------------------------------------------------------------
+
 SettingException::SettingException(const Setting &setting)
 {
   std::stringstream sstr;
@@ -192,7 +283,8 @@ SettingException::SettingException(const Setting &setting, const char *name)
 
 SettingException::SettingException(const char *path)
 {
-  _path = ::strdup(path);
+  // getParent() of the root has no path to report.
+  _path = ::strdup(path ? path : "");
 }
 
 // ---------------------------------------------------------------------------
@@ -346,6 +438,49 @@ const char *FileIOException::what() const LIBCONFIGXX_NOEXCEPT
 
 // ---------------------------------------------------------------------------
 
+const char *QueryException::what() const LIBCONFIGXX_NOEXCEPT
+{
+  return("QueryException");
+}
+
+// ---------------------------------------------------------------------------
+
+static int __collectQueryResult(config_setting_t *setting, void *user)
+{
+  static_cast<std::vector<SettingView> *>(user)->push_back(
+    SettingView(setting));
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+// ---------------------------------------------------------------------------
+
+static std::vector<SettingView> __runQuery(config_setting_t *setting,
+                                           const char *expr)
+{
+  config_query_t *query = config_query_compile(expr);
+  std::vector<SettingView> results;
+
+  if(! query)
+    throw QueryException();
+
+  try
+  {
+    config_query_run(query, setting, __collectQueryResult, &results);
+  }
+  catch(...)
+  {
+    config_query_destroy(query);
+    throw;
+  }
+
+  config_query_destroy(query);
+
+  return(results);
+}
+
+// ---------------------------------------------------------------------------
+
 void Config::ConfigDestructor(void *arg)
 {
   delete reinterpret_cast<Setting *>(arg);
@@ -358,7 +493,7 @@ Config::Config()
 {
   _config = new config_t;
   config_init(_config);
-  config_set_hook(_config, reinterpret_cast<void *>(this));
+  attach();
   config_set_destructor(_config, ConfigDestructor);
   config_set_include_func(_config, __include_func);
   config_set_fatal_error_func(__fatal_error_func);
@@ -374,6 +509,55 @@ Config::~Config()
 
 // ---------------------------------------------------------------------------
 
+#if __cplusplus >= 201103L
+
+Config::Config(Config &&other) noexcept
+  : Config()
+{
+  // The config_t stays where it is, so the settings (and their wrappers)
+  // are untouched; other is left with the empty configuration made above.
+  swap(other);
+}
+
+// ---------------------------------------------------------------------------
+
+Config& Config::operator=(Config &&other) noexcept
+{
+  // The old configuration is destroyed along with other.
+  if(this != &other)
+    swap(other);
+
+  return(*this);
+}
+
+#endif // __cplusplus >= 201103L
+
+// ---------------------------------------------------------------------------
+
+void Config::swap(Config &other) LIBCONFIGXX_NOEXCEPT
+{
+  config_t *config = _config;
+  Setting::Format format = _defaultFormat;
+
+  _config = other._config;
+  _defaultFormat = other._defaultFormat;
+  other._config = config;
+  other._defaultFormat = format;
+
+  attach();
+  other.attach();
+}
+
+// ---------------------------------------------------------------------------
+
+void Config::attach() LIBCONFIGXX_NOEXCEPT
+{
+  if(_config)
+    config_set_hook(_config, reinterpret_cast<void *>(this));
+}
+
+// ---------------------------------------------------------------------------
+
 void Config::clear()
 {
   config_clear(_config);
@@ -453,6 +637,34 @@ unsigned short Config::getFloatPrecision() const
 
 // ---------------------------------------------------------------------------
 
+void Config::setParseThreads(unsigned int threads)
+{
+  config_set_parse_threads(_config, threads);
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned int Config::getParseThreads() const
+{
+  return(config_get_parse_threads(_config));
+}
+
+// ---------------------------------------------------------------------------
+
+void Config::setJournalLimit(size_t limit)
+{
+  config_set_journal_limit(_config, limit);
+}
+
+// ---------------------------------------------------------------------------
+
+size_t Config::getJournalLimit() const
+{
+  return(config_get_journal_limit(_config));
+}
+
+// ---------------------------------------------------------------------------
+
 void Config::setIncludeDir(const char *includeDir)
 {
   config_set_include_dir(_config, includeDir);
@@ -511,6 +723,18 @@ void Config::readString(const char *str)
 
 // ---------------------------------------------------------------------------
 
+size_t Config::readBuffer(const char *buffer, size_t length)
+{
+  size_t consumed = 0;
+
+  if(! config_read_buffer(_config, buffer, length, &consumed))
+    handleError();
+
+  return(consumed);
+}
+
+// ---------------------------------------------------------------------------
+
 void Config::write(FILE *stream) const
 {
   config_write(_config, stream);
@@ -534,6 +758,21 @@ void Config::writeFile(const char *filename) const
 
 // ---------------------------------------------------------------------------
 
+void Config::compactJournal()
+{
+  if(! config_journal_compact(_config))
+    handleError();
+}
+
+// ---------------------------------------------------------------------------
+
+bool Config::freeze()
+{
+  return(config_freeze(_config) == CONFIG_TRUE);
+}
+
+// ---------------------------------------------------------------------------
+
 Setting & Config::lookup(const char *path) const
 {
   config_setting_t *s = config_lookup(_config, path);
@@ -545,6 +784,27 @@ Setting & Config::lookup(const char *path) const
 
 // ---------------------------------------------------------------------------
 
+SettingView Config::tryLookup(const char *path) const
+{
+  return(SettingView(config_lookup(_config, path)));
+}
+
+// ---------------------------------------------------------------------------
+
+std::vector<SettingView> Config::query(const char *expr) const
+{
+  return(__runQuery(_config->root, expr));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView Config::tryLookup(const char *path, size_t length) const
+{
+  return(SettingView(config_lookup_n(_config, path, length)));
+}
+
+// ---------------------------------------------------------------------------
+
 bool Config::exists(const char *path) const
 {
   config_setting_t *s = config_lookup(_config, path);
@@ -555,16 +815,7 @@ bool Config::exists(const char *path) const
 // ---------------------------------------------------------------------------
 
 #define CONFIG_LOOKUP_NO_EXCEPTIONS(P, T, V)    \
-  try                                           \
-  {                                             \
-    Setting &s = lookup(P);                     \
-    V = (T)s;                                   \
-    return(true);                               \
-  }                                             \
-  catch(const ConfigException &)                \
-  {                                             \
-    return(false);                              \
-  }
+  return(tryLookup(P).getValue(V))
 
 // ---------------------------------------------------------------------------
 
@@ -638,68 +889,38 @@ Setting & Config::getRoot() const
 
 // ---------------------------------------------------------------------------
 
-Setting::Setting(config_setting_t *setting)
-  : _setting(setting)
+Config::Stats Config::getStats() const
 {
-  switch(config_setting_type(setting))
-  {
-    case CONFIG_TYPE_GROUP:
-      _type = TypeGroup;
-      break;
-
-    case CONFIG_TYPE_INT:
-      _type = TypeInt;
-      break;
-
-    case CONFIG_TYPE_INT64:
-      _type = TypeInt64;
-      break;
-
-    case CONFIG_TYPE_FLOAT:
-      _type = TypeFloat;
-      break;
-
-    case CONFIG_TYPE_STRING:
-      _type = TypeString;
-      break;
-
-    case CONFIG_TYPE_BOOL:
-      _type = TypeBoolean;
-      break;
+  config_stats_t cstats;
+  Stats stats;
 
-    case CONFIG_TYPE_ARRAY:
-      _type = TypeArray;
-      break;
+  config_get_stats(_config, &cstats);
 
-    case CONFIG_TYPE_LIST:
-      _type = TypeList;
-      break;
+  stats.bytesScanned = cstats.bytes_scanned;
+  stats.tokens = cstats.tokens;
 
-    case CONFIG_TYPE_NONE:
-    default:
-      _type = TypeNone;
-      break;
-  }
+  for(int t = Setting::TypeNone; t <= Setting::TypeList; ++t)
+    stats.settings[t] = cstats.settings[__toTypeCode((Setting::Type)t)];
 
-  switch(config_setting_get_format(setting))
-  {
-    case CONFIG_FORMAT_HEX:
-      _format = FormatHex;
-      break;
+  stats.filesIncluded = cstats.files_included;
+  stats.peakStringSize = cstats.peak_string_size;
+  stats.allocations = cstats.allocations;
+  stats.readNanos = cstats.read_ns;
+  stats.scanNanos = cstats.scan_ns;
+  stats.parseNanos = cstats.parse_ns;
+  stats.includeNanos = cstats.include_ns;
+  stats.writeNanos = cstats.write_ns;
 
-    case CONFIG_FORMAT_BIN:
-      _format = FormatBin;
-      break;
+  return(stats);
+}
 
-    case CONFIG_FORMAT_OCT:
-      _format = FormatOct;
-      break;
+// ---------------------------------------------------------------------------
 
-    case CONFIG_FORMAT_DEFAULT:
-    default:
-      _format = FormatDefault;
-      break;
-  }
+Setting::Setting(config_setting_t *setting)
+  : _setting(setting),
+    _type(__fromTypeCode(config_setting_type(setting))),
+    _format(__fromFormatCode(config_setting_get_format(setting)))
+{
 }
 
 // ---------------------------------------------------------------------------
@@ -981,6 +1202,27 @@ Setting & Setting::lookup(const char *path) const
 
 // ---------------------------------------------------------------------------
 
+SettingView Setting::tryLookup(const char *path) const
+{
+  return(SettingView(*this).tryLookup(path));
+}
+
+// ---------------------------------------------------------------------------
+
+std::vector<SettingView> Setting::query(const char *expr) const
+{
+  return(SettingView(*this).query(expr));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView Setting::tryLookup(const char *path, size_t length) const
+{
+  return(SettingView(*this).tryLookup(path, length));
+}
+
+// ---------------------------------------------------------------------------
+
 Setting & Setting::operator[](const char *name) const
 {
   assertType(TypeGroup);
@@ -1010,17 +1252,10 @@ Setting & Setting::operator[](int i) const
 
 // ---------------------------------------------------------------------------
 
-#define SETTING_LOOKUP_NO_EXCEPTIONS(K, T, V)   \
-  try                                           \
-  {                                             \
-    Setting &s = operator[](K);                 \
-    V = (T)s;                                   \
-    return(true);                               \
-  }                                             \
-  catch(const ConfigException &)                \
-  {                                             \
-    return(false);                              \
-  }
+#define SETTING_LOOKUP_NO_EXCEPTIONS(K, T, V)                           \
+  config_setting_t *s = (_type == TypeGroup)                            \
+    ? config_setting_get_member(_setting, K) : NULL;                    \
+  return(SettingView(s).getValue(V))
 
 // ---------------------------------------------------------------------------
 
@@ -1106,6 +1341,14 @@ int Setting::getLength() const
 
 // ---------------------------------------------------------------------------
 
+void Setting::reserve(unsigned int count)
+{
+  if(! config_setting_reserve(_setting, count))
+    throw SettingTypeException(*this);
+}
+
+// ---------------------------------------------------------------------------
+
 const char * Setting::getName() const
 {
   return(config_setting_name(_setting));
@@ -1176,6 +1419,20 @@ int Setting::getIndex() const
 
 // ---------------------------------------------------------------------------
 
+unsigned long long Setting::getHash() const
+{
+  return(config_setting_hash(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+bool Setting::isEqual(const Setting &other) const
+{
+  return(config_setting_equal(_setting, other._setting) == CONFIG_TRUE);
+}
+
+// ---------------------------------------------------------------------------
+
 void Setting::remove(const char *name)
 {
   assertType(TypeGroup);
@@ -1326,10 +1583,17 @@ Setting::const_iterator Setting::end() const
 
 // ---------------------------------------------------------------------------
 
-SettingIterator::SettingIterator(Setting& setting, bool endIterator)
-  : _setting(&setting),
-    _count(setting.getLength()),
-    _idx(endIterator ? _count : 0)
+SettingViewDescendants Setting::descendants() const
+{
+  return(SettingView(*this).descendants());
+}
+
+// ---------------------------------------------------------------------------
+
+SettingIterator::SettingIterator(Setting& setting, bool endIterator)
+  : _setting(&setting),
+    _count(setting.getLength()),
+    _idx(endIterator ? _count : 0)
 {
   if(!setting.isAggregate())
     throw SettingTypeException(setting);
@@ -1573,6 +1837,768 @@ int SettingConstIterator::operator-(SettingConstIterator const &other) const
   return(_idx - other._idx);
 }
 
+// ---------------------------------------------------------------------------
+
+SettingView::SettingView(const Setting &setting)
+  : _setting(setting._setting)
+{
+}
+
+// ---------------------------------------------------------------------------
+
+Setting::Type SettingView::getType() const
+{
+  return(__fromTypeCode(config_setting_type(_setting)));
+}
+
+// ---------------------------------------------------------------------------
+
+Setting::Format SettingView::getFormat() const
+{
+  return(__fromFormatCode(config_setting_get_format(_setting)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator bool() const
+{
+  assertType(Setting::TypeBoolean);
+
+  return(config_setting_get_bool(_setting) ? true : false);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator int() const
+{
+  if(getType() == Setting::TypeInt64)
+  {
+    long long val = config_setting_get_int64(_setting);
+    if((val < INT32_MIN) || (val > INT32_MAX))
+      throw SettingRangeException(getSetting());
+
+    return((int)val);
+  }
+
+  assertType(Setting::TypeInt);
+
+  return(config_setting_get_int(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator unsigned int() const
+{
+  if(getType() == Setting::TypeInt64)
+  {
+    long long val = config_setting_get_int64(_setting);
+    if((val < 0) || (val > UINT32_MAX))
+      throw SettingRangeException(getSetting());
+
+    return(static_cast<unsigned int>(val));
+  }
+
+  assertType(Setting::TypeInt);
+
+  int v = config_setting_get_int(_setting);
+  if(v < 0)
+    throw SettingRangeException(getSetting());
+
+  return(static_cast<unsigned int>(v));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator long() const
+{
+  if(sizeof(long) == sizeof(long long))
+    return operator long long();
+  else
+    return operator int();
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator unsigned long() const
+{
+  if(sizeof(long) == sizeof(long long))
+    return operator unsigned long long();
+  else
+    return operator unsigned int();
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator long long() const
+{
+  if(getType() == Setting::TypeInt)
+    return((long long)config_setting_get_int(_setting));
+
+  assertType(Setting::TypeInt64);
+
+  return(config_setting_get_int64(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator unsigned long long() const
+{
+  if(getType() == Setting::TypeInt)
+  {
+    int val = config_setting_get_int(_setting);
+    if(val < 0)
+      throw SettingRangeException(getSetting());
+
+    return(static_cast<unsigned long long>(val));
+  }
+
+  assertType(Setting::TypeInt64);
+
+  long long v = config_setting_get_int64(_setting);
+  if(v < 0)
+    throw SettingRangeException(getSetting());
+
+  return(static_cast<unsigned long long>(v));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator double() const
+{
+  assertType(Setting::TypeFloat);
+
+  return(config_setting_get_float(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator float() const
+{
+  assertType(Setting::TypeFloat);
+
+  // may cause loss of precision:
+  return(static_cast<float>(config_setting_get_float(_setting)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator const char *() const
+{
+  assertType(Setting::TypeString);
+
+  return(config_setting_get_string(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::operator std::string() const
+{
+  assertType(Setting::TypeString);
+
+  const char *s = config_setting_get_string(_setting);
+
+  std::string str;
+  if(s)
+    str = s;
+
+  return(str);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::lookup(const char *path) const
+{
+  assertType(Setting::TypeGroup);
+
+  config_setting_t *setting = config_setting_lookup(_setting, path);
+
+  if(! setting)
+    throw SettingNotFoundException(getSetting(), path);
+
+  return(SettingView(setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::tryLookup(const char *path) const
+{
+  if(! _setting || (getType() != Setting::TypeGroup))
+    return(SettingView());
+
+  return(SettingView(config_setting_lookup(_setting, path)));
+}
+
+// ---------------------------------------------------------------------------
+
+std::vector<SettingView> SettingView::query(const char *expr) const
+{
+  if(! _setting)
+    return(std::vector<SettingView>());
+
+  return(__runQuery(_setting, expr));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::tryLookup(const char *path, size_t length) const
+{
+  if(! _setting || (getType() != Setting::TypeGroup))
+    return(SettingView());
+
+  return(SettingView(config_setting_lookup_n(_setting, path, length)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::operator[](const char *name) const
+{
+  assertType(Setting::TypeGroup);
+
+  config_setting_t *setting = config_setting_get_member(_setting, name);
+
+  if(! setting)
+    throw SettingNotFoundException(getSetting(), name);
+
+  return(SettingView(setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::operator[](int i) const
+{
+  if(! isAggregate())
+    throw SettingTypeException(getSetting(), i);
+
+  config_setting_t *setting = config_setting_get_elem(_setting, i);
+
+  if(! setting)
+    throw SettingNotFoundException(getSetting(), i);
+
+  return(SettingView(setting));
+}
+
+// ---------------------------------------------------------------------------
+
+// Unlike SETTING_LOOKUP_NO_EXCEPTIONS, this doesn't throw and catch an
+// exception when the member doesn't exist.
+#define VIEW_LOOKUP_NO_EXCEPTIONS(K, T, V)                              \
+  config_setting_t *s = (getType() == Setting::TypeGroup)               \
+    ? config_setting_get_member(_setting, K) : NULL;                    \
+  return(SettingView(s).getValue(V))
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, bool &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, bool, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, int &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, int, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, unsigned int &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, unsigned int, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, long long &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, long long, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name,
+                              unsigned long long &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, unsigned long long, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, double &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, double, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, float &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, float, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, const char *&value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, const char *, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::lookupValue(const char *name, std::string &value) const
+{
+  VIEW_LOOKUP_NO_EXCEPTIONS(name, const char *, value);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::exists(const char *name) const
+{
+  if(getType() != Setting::TypeGroup)
+    return(false);
+
+  config_setting_t *setting = config_setting_get_member(_setting, name);
+
+  return(setting != NULL);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(bool &value) const
+{
+  if(! _setting || ! isConvertibleTo(Setting::TypeBoolean))
+    return(false);
+
+  value = (config_setting_get_bool(_setting) ? true : false);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(int &value) const
+{
+  if(! _setting)
+    return(false);
+
+  if(getType() == Setting::TypeInt64)
+  {
+    long long val = config_setting_get_int64(_setting);
+    if((val < INT32_MIN) || (val > INT32_MAX))
+      return(false);
+
+    value = (int)val;
+    return(true);
+  }
+
+  if(! isConvertibleTo(Setting::TypeInt))
+    return(false);
+
+  value = config_setting_get_int(_setting);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(unsigned int &value) const
+{
+  if(! _setting)
+    return(false);
+
+  if(getType() == Setting::TypeInt64)
+  {
+    long long val = config_setting_get_int64(_setting);
+    if((val < 0) || (val > UINT32_MAX))
+      return(false);
+
+    value = static_cast<unsigned int>(val);
+    return(true);
+  }
+
+  if(! isConvertibleTo(Setting::TypeInt))
+    return(false);
+
+  int v = config_setting_get_int(_setting);
+  if(v < 0)
+    return(false);
+
+  value = static_cast<unsigned int>(v);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(long long &value) const
+{
+  if(! _setting)
+    return(false);
+
+  if(getType() == Setting::TypeInt)
+  {
+    value = (long long)config_setting_get_int(_setting);
+    return(true);
+  }
+
+  if(! isConvertibleTo(Setting::TypeInt64))
+    return(false);
+
+  value = config_setting_get_int64(_setting);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(unsigned long long &value) const
+{
+  if(! _setting)
+    return(false);
+
+  if(getType() == Setting::TypeInt)
+  {
+    int val = config_setting_get_int(_setting);
+    if(val < 0)
+      return(false);
+
+    value = static_cast<unsigned long long>(val);
+    return(true);
+  }
+
+  if(! isConvertibleTo(Setting::TypeInt64))
+    return(false);
+
+  long long v = config_setting_get_int64(_setting);
+  if(v < 0)
+    return(false);
+
+  value = static_cast<unsigned long long>(v);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(double &value) const
+{
+  if(! _setting || ! isConvertibleTo(Setting::TypeFloat))
+    return(false);
+
+  value = config_setting_get_float(_setting);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(float &value) const
+{
+  if(! _setting || ! isConvertibleTo(Setting::TypeFloat))
+    return(false);
+
+  // may cause loss of precision:
+  value = static_cast<float>(config_setting_get_float(_setting));
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(const char *&value) const
+{
+  if(! _setting || ! isConvertibleTo(Setting::TypeString))
+    return(false);
+
+  value = config_setting_get_string(_setting);
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::getValue(std::string &value) const
+{
+  if(! _setting || ! isConvertibleTo(Setting::TypeString))
+    return(false);
+
+  const char *s = config_setting_get_string(_setting);
+
+  if(s)
+    value = s;
+  else
+    value.clear();
+
+  return(true);
+}
+
+// ---------------------------------------------------------------------------
+
+int SettingView::getLength() const
+{
+  return(config_setting_length(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+const char * SettingView::getName() const
+{
+  return(config_setting_name(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+std::string SettingView::getPath() const
+{
+  std::stringstream path;
+
+  __constructPath(*this, path);
+
+  return(path.str());
+}
+
+// ---------------------------------------------------------------------------
+
+int SettingView::getIndex() const
+{
+  return(config_setting_index(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingView::getParent() const
+{
+  config_setting_t *setting = config_setting_parent(_setting);
+
+  if(! setting)
+    throw SettingNotFoundException(NULL);
+
+  return(SettingView(setting));
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::isRoot() const
+{
+  return(config_setting_is_root(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+unsigned int SettingView::getSourceLine() const
+{
+  return(config_setting_source_line(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+const char *SettingView::getSourceFile() const
+{
+  return(config_setting_source_file(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::iterator SettingView::begin() const
+{
+  if(! isAggregate())
+    throw SettingTypeException(getSetting());
+
+  config_list_t *list = _setting->value.list;
+
+  return(iterator(list ? list->elements : NULL));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView::iterator SettingView::end() const
+{
+  if(! isAggregate())
+    throw SettingTypeException(getSetting());
+
+  config_list_t *list = _setting->value.list;
+
+  return(iterator(list ? list->elements + list->length : NULL));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingViewDescendants SettingView::descendants() const
+{
+  if(! isAggregate())
+    throw SettingTypeException(getSetting());
+
+  return(SettingViewDescendants(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingViewRecursiveIterator::SettingViewRecursiveIterator(
+  config_setting_t *setting)
+  : _setting(setting)
+{
+  ++(*this);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingViewRecursiveIterator & SettingViewRecursiveIterator::operator++()
+{
+  config_setting_t *setting = _setting;
+  config_list_t *list = config_setting_is_aggregate(setting)
+    ? setting->value.list : NULL;
+
+  if(list && (list->length > 0))
+  {
+    _path.push_back(0);
+    _setting = list->elements[0];
+    return(*this);
+  }
+
+  // Climb until there is a next sibling, but not above where the
+  // iteration started.
+  while(! _path.empty())
+  {
+    list = setting->parent->value.list;
+
+    if(++_path.back() < list->length)
+    {
+      _setting = list->elements[_path.back()];
+      return(*this);
+    }
+
+    _path.pop_back();
+    setting = setting->parent;
+  }
+
+  _setting = NULL;
+  return(*this);
+}
+
+// ---------------------------------------------------------------------------
+
+Setting & SettingView::getSetting() const
+{
+  return(Setting::wrapSetting(_setting));
+}
+
+// ---------------------------------------------------------------------------
+
+bool SettingView::isConvertibleTo(Setting::Type type) const
+{
+  if(type == getType())
+    return(true);
+
+  return(isNumber() && config_get_auto_convert(_setting->config)
+         && ((type == Setting::TypeInt) || (type == Setting::TypeInt64)
+             || (type == Setting::TypeFloat)));
+}
+
+// ---------------------------------------------------------------------------
+
+void SettingView::assertType(Setting::Type type) const
+{
+  if(! isConvertibleTo(type))
+    throw SettingTypeException(getSetting());
+}
+
+// ---------------------------------------------------------------------------
+
+ConfigStack::ConfigStack()
+  : _overlay(config_overlay_new())
+{
+}
+
+// ---------------------------------------------------------------------------
+
+ConfigStack::~ConfigStack()
+{
+  config_overlay_destroy(_overlay);
+}
+
+// ---------------------------------------------------------------------------
+
+void ConfigStack::push(const Config &config)
+{
+  config_overlay_push(_overlay, config._config);
+}
+
+// ---------------------------------------------------------------------------
+
+void ConfigStack::flush()
+{
+  config_overlay_flush(_overlay);
+}
+
+// ---------------------------------------------------------------------------
+
+Setting & ConfigStack::lookup(const char *path) const
+{
+  const config_setting_t *s = config_overlay_lookup(_overlay, path);
+  if(! s)
+    throw SettingNotFoundException(path);
+
+  return(Setting::wrapSetting(const_cast<config_setting_t *>(s)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView ConfigStack::tryLookup(const char *path) const
+{
+  return(SettingView(const_cast<config_setting_t *>(
+                       config_overlay_lookup(_overlay, path))));
+}
+
+// ---------------------------------------------------------------------------
+
+bool ConfigStack::exists(const char *path) const
+{
+  return(config_overlay_lookup(_overlay, path) != NULL);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingIndex::SettingIndex(const Setting &aggregate, const char *path)
+  : _index(NULL)
+{
+  if(! aggregate.isAggregate())
+    throw SettingTypeException(aggregate);
+
+  _index = config_setting_build_index(SettingView(aggregate)._setting, path);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingIndex::SettingIndex(const SettingView &aggregate, const char *path)
+  : _index(NULL)
+{
+  if(! aggregate.isAggregate())
+    throw SettingTypeException(aggregate.getSetting());
+
+  _index = config_setting_build_index(aggregate._setting, path);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingIndex::~SettingIndex()
+{
+  config_index_destroy(_index);
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingIndex::find(int key) const
+{
+  return(SettingView(config_index_find_int(_index, key)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingIndex::find(long long key) const
+{
+  return(SettingView(config_index_find_int(_index, key)));
+}
+
+// ---------------------------------------------------------------------------
+
+SettingView SettingIndex::find(const char *key) const
+{
+  return(SettingView(config_index_find_string(_index, key)));
+}
+
+// ---------------------------------------------------------------------------
 
 } // namespace libconfig
 
@@ -0,0 +1,255 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "libconfig.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define OVERLAY_MIN_CAPACITY 16
+
+/* ------------------------------------------------------------------------- */
+
+/* A memoized lookup. The setting is NULL if the path is not in any layer. */
+struct overlay_entry
+{
+  unsigned int hash;
+  char *path; /* NULL if the slot is free */
+  const config_setting_t *setting;
+};
+
+struct config_overlay_t
+{
+  const config_t **layers; /* bottom to top */
+  unsigned int num_layers;
+  struct overlay_entry *entries;
+  unsigned int capacity; /* a power of two, or 0 */
+  unsigned int count;
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the slot holding the result for the given path, or the free slot
+ * where it belongs. The table must have at least one free slot.
+ */
+static struct overlay_entry *__overlay_find(const config_overlay_t *overlay,
+                                            const char *path,
+                                            unsigned int hash)
+{
+  unsigned int mask = overlay->capacity - 1;
+  unsigned int i = hash & mask;
+  struct overlay_entry *entry;
+
+  for(;;)
+  {
+    entry = overlay->entries + i;
+
+    if(! entry->path)
+      return(entry);
+
+    if((entry->hash == hash) && !strcmp(entry->path, path))
+      return(entry);
+
+    i = (i + 1) & mask;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __overlay_grow(config_overlay_t *overlay)
+{
+  struct overlay_entry *old = overlay->entries, *entry;
+  unsigned int old_capacity = overlay->capacity, i;
+
+  overlay->capacity = (old_capacity < OVERLAY_MIN_CAPACITY)
+    ? OVERLAY_MIN_CAPACITY : old_capacity * 2;
+  overlay->entries = (struct overlay_entry *)libconfig_calloc(
+    overlay->capacity, sizeof(struct overlay_entry));
+
+  for(i = 0; i < old_capacity; ++i)
+  {
+    if(old[i].path)
+    {
+      entry = __overlay_find(overlay, old[i].path, old[i].hash);
+      *entry = old[i];
+    }
+  }
+
+  __delete(old);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const config_setting_t *__overlay_resolve(
+  const config_overlay_t *overlay, const char *path)
+{
+  const config_setting_t *setting;
+  unsigned int i;
+
+  for(i = overlay->num_layers; i > 0; --i)
+  {
+    setting = config_lookup_const(overlay->layers[i - 1], path);
+    if(setting)
+      return(setting);
+  }
+
+  return(NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_overlay_t *config_overlay_new(void)
+{
+  return(__new(config_overlay_t));
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_push(config_overlay_t *overlay, const config_t *config)
+{
+  if(! overlay || ! config)
+    return(CONFIG_FALSE);
+
+  overlay->layers = (const config_t **)libconfig_realloc(
+    (void *)overlay->layers,
+    (overlay->num_layers + 1) * sizeof(const config_t *));
+  overlay->layers[(overlay->num_layers)++] = config;
+
+  /* The new layer may hide settings that earlier lookups resolved. */
+  config_overlay_flush(overlay);
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_overlay_flush(config_overlay_t *overlay)
+{
+  unsigned int i;
+
+  if(! overlay)
+    return;
+
+  for(i = 0; i < overlay->capacity; ++i)
+    __delete(overlay->entries[i].path);
+
+  __delete(overlay->entries);
+  overlay->entries = NULL;
+  overlay->capacity = 0;
+  overlay->count = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+const config_setting_t *config_overlay_lookup(config_overlay_t *overlay,
+                                              const char *path)
+{
+  struct overlay_entry *entry;
+  unsigned int hash;
+
+  if(! overlay || ! path)
+    return(NULL);
+
+  /* Keep the load factor at or below 1/2. */
+  if((overlay->count + 1) * 2 > overlay->capacity)
+    __overlay_grow(overlay);
+
+  hash = libconfig_hash_string(path);
+  entry = __overlay_find(overlay, path, hash);
+
+  if(! entry->path)
+  {
+    entry->hash = hash;
+    entry->path = strdup(path);
+    entry->setting = __overlay_resolve(overlay, path);
+    ++(overlay->count);
+  }
+
+  return(entry->setting);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_lookup_int(config_overlay_t *overlay, const char *path,
+                              int *value)
+{
+  const config_setting_t *s = config_overlay_lookup(overlay, path);
+
+  return(s ? config_setting_get_int_safe(s, value) : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_lookup_int64(config_overlay_t *overlay, const char *path,
+                                long long *value)
+{
+  const config_setting_t *s = config_overlay_lookup(overlay, path);
+
+  return(s ? config_setting_get_int64_safe(s, value) : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_lookup_float(config_overlay_t *overlay, const char *path,
+                                double *value)
+{
+  const config_setting_t *s = config_overlay_lookup(overlay, path);
+
+  return(s ? config_setting_get_float_safe(s, value) : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_lookup_bool(config_overlay_t *overlay, const char *path,
+                               int *value)
+{
+  const config_setting_t *s = config_overlay_lookup(overlay, path);
+
+  return(s ? config_setting_get_bool_safe(s, value) : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_overlay_lookup_string(config_overlay_t *overlay, const char *path,
+                                 const char **value)
+{
+  const config_setting_t *s = config_overlay_lookup(overlay, path);
+
+  return(s ? config_setting_get_string_safe(s, value) : CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_overlay_destroy(config_overlay_t *overlay)
+{
+  if(! overlay)
+    return;
+
+  config_overlay_flush(overlay);
+  __delete(overlay->layers);
+  __delete(overlay);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,251 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#include "parallel.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef LIBCONFIG_WINDOWS_OS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+unsigned int libconfig_split_input(const char *str, size_t len,
+                                   size_t chunk_size,
+                                   struct input_chunk *chunks,
+                                   unsigned int max_chunks)
+{
+  const char *p = str, *end = str + len, *start = str, *target, *q;
+  int depth = 0, lineno = 1, start_lineno = 1;
+  unsigned int count = 0;
+
+  if((max_chunks < 2) || (len <= chunk_size))
+    target = end + 1;
+  else
+    target = str + chunk_size;
+
+  while(p < end)
+  {
+    switch(*p++)
+    {
+      case '\n':
+        ++lineno;
+        break;
+
+      case '"':
+        /* Escapes are skipped over, so that '\"' doesn't end the string. */
+        for(; (p < end) && (*p != '"'); ++p)
+        {
+          if((*p == '\\') && (p + 1 < end))
+            ++p;
+          if(*p == '\n')
+            ++lineno;
+        }
+
+        if(p < end)
+          ++p;
+        break;
+
+      case '/':
+        if((p < end) && (*p == '*'))
+        {
+          for(++p; p < end; ++p)
+          {
+            if(*p == '\n')
+              ++lineno;
+            else if((*p == '*') && (p + 1 < end) && (p[1] == '/'))
+              break;
+          }
+
+          p = (p < end) ? p + 2 : end;
+          break;
+        }
+        else if((p >= end) || (*p != '/'))
+          break;
+        /* fall through */
+
+      case '#':
+        /* The newline is left to be counted by the main loop. */
+        q = (const char *)memchr(p, '\n', (size_t)(end - p));
+        p = q ? q : end;
+        break;
+
+      case '{':
+      case '[':
+      case '(':
+        ++depth;
+        break;
+
+      case '}':
+      case ']':
+      case ')':
+        --depth;
+        break;
+
+      case '@':
+        /* An @include must be expanded in order, by a single scanner. */
+        return(0);
+
+      case ';':
+      case ',':
+        if((depth == 0) && (p >= target) && (count + 1 < max_chunks))
+        {
+          chunks[count].offset = (size_t)(start - str);
+          chunks[count].length = (size_t)(p - start);
+          chunks[count].lineno = start_lineno;
+          ++count;
+
+          start = p;
+          start_lineno = lineno;
+          target = p + chunk_size;
+        }
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  chunks[count].offset = (size_t)(start - str);
+  chunks[count].length = (size_t)(end - start);
+  chunks[count].lineno = start_lineno;
+
+  return(count + 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct parallel_task
+{
+  void (*func)(void *);
+  void *arg;
+  int started;
+#ifdef LIBCONFIG_WINDOWS_OS
+  HANDLE thread;
+#else
+  pthread_t thread;
+#endif
+};
+
+/* ------------------------------------------------------------------------- */
+
+#ifdef LIBCONFIG_WINDOWS_OS
+
+static DWORD WINAPI __task_main(LPVOID arg)
+{
+  struct parallel_task *task = (struct parallel_task *)arg;
+
+  task->func(task->arg);
+  return(0);
+}
+
+#else
+
+static void *__task_main(void *arg)
+{
+  struct parallel_task *task = (struct parallel_task *)arg;
+
+  task->func(task->arg);
+  return(NULL);
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_run_parallel(void (*func)(void *), void *args, size_t size,
+                            unsigned int count)
+{
+  struct parallel_task *tasks, *task;
+  unsigned int i;
+
+  if(count == 0)
+    return;
+
+  tasks = (struct parallel_task *)libconfig_calloc(
+    count, sizeof(struct parallel_task));
+
+  for(i = 1, task = tasks + 1; i < count; ++i, ++task)
+  {
+    task->func = func;
+    task->arg = (char *)args + (i * size);
+
+#ifdef LIBCONFIG_WINDOWS_OS
+    task->thread = CreateThread(NULL, 0, __task_main, task, 0, NULL);
+    task->started = (task->thread != NULL);
+#else
+    task->started = (pthread_create(&(task->thread), NULL, __task_main,
+                                    task) == 0);
+#endif
+  }
+
+  func(args);
+
+  for(i = 1, task = tasks + 1; i < count; ++i, ++task)
+  {
+    if(task->started)
+    {
+#ifdef LIBCONFIG_WINDOWS_OS
+      WaitForSingleObject(task->thread, INFINITE);
+      CloseHandle(task->thread);
+#else
+      pthread_join(task->thread, NULL);
+#endif
+    }
+    else
+      func(task->arg);
+  }
+
+  __delete(tasks);
+}
+
+/* ------------------------------------------------------------------------- */
+
+unsigned int libconfig_cpu_count(void)
+{
+#if defined(LIBCONFIG_WINDOWS_OS)
+
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return(info.dwNumberOfProcessors > 0
+         ? (unsigned int)info.dwNumberOfProcessors : 1);
+
+#elif defined(_SC_NPROCESSORS_ONLN)
+
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  return(n > 0 ? (unsigned int)n : 1);
+
+#else
+
+  return(1);
+
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
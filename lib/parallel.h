@@ -0,0 +1,71 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#ifndef __libconfig_parallel_h
+#define __libconfig_parallel_h
+
+#include <stddef.h>
+
+/*
+ * Support for CONFIG_OPTION_PARALLEL_PARSE: splitting an input at top-level
+ * setting boundaries, and running the parse of each piece on its own thread.
+ */
+
+struct input_chunk
+{
+  size_t offset;
+  size_t length;
+  int lineno; /* of the first line of the chunk */
+};
+
+/*
+ * Splits the 'len' bytes at 'str' into at most 'max_chunks' chunks of roughly
+ * 'chunk_size' bytes each, by a structural pre-pass that tracks strings,
+ * comments and bracket depth. Chunks end only just after a ';' or ',' that
+ * terminates a top-level setting, so that each one is a sequence of complete
+ * settings that can be parsed on its own.
+ *
+ * Returns the number of chunks stored at 'chunks', which is 1 if the input is
+ * too small to split, or 0 if it must not be split because it contains an
+ * @include directive.
+ */
+extern unsigned int libconfig_split_input(const char *str, size_t len,
+                                          size_t chunk_size,
+                                          struct input_chunk *chunks,
+                                          unsigned int max_chunks);
+
+/*
+ * Calls 'func' once for each of the 'count' elements of the array at 'args',
+ * each of which is 'size' bytes long, concurrently, and returns when all of
+ * the calls have returned. The first call is made on the calling thread. If a
+ * thread cannot be created, its call is made on the calling thread instead.
+ */
+extern void libconfig_run_parallel(void (*func)(void *), void *args,
+                                   size_t size, unsigned int count);
+
+/*
+ * Returns the number of processors available, or 1 if it cannot be
+ * determined.
+ */
+extern unsigned int libconfig_cpu_count(void);
+
+#endif /* __libconfig_parallel_h */
@@ -0,0 +1,434 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#include "parsectx.h"
+#include "wincompat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_SET_MIN_CAPACITY 16
+#define GROUP_STACK_CHUNK_SIZE 8
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the slot holding the setting with the given name, or the free slot
+ * where it belongs. The table must have at least one free slot.
+ */
+static struct name_set_entry *__name_set_find(struct name_set *set,
+                                              const char *name,
+                                              unsigned int hash)
+{
+  unsigned int mask = set->capacity - 1;
+  unsigned int i = hash & mask;
+  struct name_set_entry *entry;
+
+  for(;;)
+  {
+    entry = set->entries + i;
+
+    if(! entry->setting)
+      return(entry);
+
+    if((entry->hash == hash) && !strcmp(entry->setting->name, name))
+      return(entry);
+
+    i = (i + 1) & mask;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __name_set_grow(struct name_set *set)
+{
+  struct name_set_entry *old = set->entries, *entry;
+  unsigned int old_capacity = set->capacity, i;
+
+  set->capacity = (old_capacity < NAME_SET_MIN_CAPACITY)
+    ? NAME_SET_MIN_CAPACITY : old_capacity * 2;
+  set->entries = (struct name_set_entry *)libconfig_calloc(
+    set->capacity, sizeof(struct name_set_entry));
+
+  for(i = 0; i < old_capacity; ++i)
+  {
+    if(old[i].setting)
+    {
+      entry = __name_set_find(set, old[i].setting->name, old[i].hash);
+      *entry = old[i];
+    }
+  }
+
+  __delete(old);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_init(struct parse_context *ctx)
+{
+  __zero(ctx);
+  libconfig_parsectx_push_group(ctx);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_cleanup(struct parse_context *ctx)
+{
+  while(ctx->group_depth > 0)
+    libconfig_parsectx_pop_group(ctx);
+
+  __delete(ctx->groups);
+  __delete(libconfig_strbuf_release(&(ctx->string)));
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_push_group(struct parse_context *ctx)
+{
+  struct name_set *set;
+  struct name_set_entry *entry;
+  unsigned int n, i;
+
+  if(ctx->group_depth == ctx->group_capacity)
+  {
+    ctx->group_capacity += GROUP_STACK_CHUNK_SIZE;
+    ctx->groups = (struct name_set *)libconfig_realloc(
+      ctx->groups, ctx->group_capacity * sizeof(struct name_set));
+  }
+
+  set = &(ctx->groups[ctx->group_depth]);
+  __zero(set);
+  ++(ctx->group_depth);
+
+  /* A group being merged into already has members. */
+  n = ctx->parent ? (unsigned int)config_setting_length(ctx->parent) : 0;
+  for(i = 0; i < n; ++i)
+  {
+    config_setting_t *member = config_setting_get_elem(ctx->parent, i);
+    unsigned int hash = libconfig_hash_string(member->name);
+
+    if((set->count + 1) * 2 > set->capacity)
+      __name_set_grow(set);
+
+    entry = __name_set_find(set, member->name, hash);
+    entry->hash = hash;
+    entry->setting = member;
+    ++(set->count);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_pop_group(struct parse_context *ctx)
+{
+  if(ctx->group_depth == 0)
+    return;
+
+  --(ctx->group_depth);
+  __delete(ctx->groups[ctx->group_depth].entries);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __remove_member(config_setting_t *parent, config_setting_t *member)
+{
+  config_setting_remove_elem(parent,
+                             (unsigned int)config_setting_index(member));
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Discards ctx->setting, the member just added to ctx->parent, in favor of
+ * ctx->replaced, the member of the same name that it overrides.
+ */
+static config_setting_t *__keep_replaced(struct parse_context *ctx)
+{
+  struct name_set *set = &(ctx->groups[ctx->group_depth - 1]);
+  config_setting_t *setting = ctx->setting, *replaced = ctx->replaced;
+  struct name_set_entry *entry;
+
+  entry = __name_set_find(set, replaced->name,
+                          libconfig_hash_string(replaced->name));
+  entry->setting = replaced;
+
+  replaced->line = setting->line;
+  replaced->file = setting->file;
+
+  /* The new member was the last one added. */
+  config_setting_remove_elem(ctx->parent,
+                             (unsigned int)config_setting_length(
+                               ctx->parent) - 1);
+
+  ctx->setting = NULL;
+  ctx->replaced = NULL;
+  return(replaced);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Returns the slot for a new member of ctx->parent with the given name,
+ * removing the existing member with that name, if any, when overrides are
+ * allowed, or setting it aside in ctx->replaced when they are merged. Returns
+ * NULL if the name is already taken.
+ */
+static struct name_set_entry *__claim_name(struct parse_context *ctx,
+                                           const char *name,
+                                           unsigned int hash)
+{
+  struct name_set *set = &(ctx->groups[ctx->group_depth - 1]);
+  struct name_set_entry *entry;
+
+  /* Keep the load factor at or below 1/2. */
+  if((set->count + 1) * 2 > set->capacity)
+    __name_set_grow(set);
+
+  entry = __name_set_find(set, name, hash);
+
+  if(entry->setting)
+  {
+    ctx->recount = CONFIG_TRUE;
+
+    if(config_get_option(ctx->config, CONFIG_OPTION_MERGE_OVERRIDES))
+      ctx->replaced = entry->setting;
+    else if(config_get_option(ctx->config, CONFIG_OPTION_ALLOW_OVERRIDES))
+      __remove_member(ctx->parent, entry->setting);
+    else
+      return(NULL); /* already exists */
+  }
+  else
+    ++(set->count);
+
+  entry->hash = hash;
+  return(entry);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *libconfig_parsectx_add_member(struct parse_context *ctx,
+                                                const char *name)
+{
+  struct name_set_entry *entry;
+  config_setting_t *setting;
+
+  entry = __claim_name(ctx, name, libconfig_hash_string(name));
+  if(! entry)
+    return(NULL);
+
+  /* The name has already been checked by the scanner, and is known to be
+   * unique, so the linear search in config_setting_add() is bypassed by
+   * adding an anonymous member and naming it afterwards.
+   */
+  setting = config_setting_add(ctx->parent, NULL, CONFIG_TYPE_NONE);
+  if(setting)
+    setting->name = strdup(name);
+
+  entry->setting = setting;
+
+  return(setting);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int libconfig_parsectx_claim_member(struct parse_context *ctx,
+                                    config_setting_t *setting)
+{
+  struct name_set_entry *entry;
+
+  entry = __claim_name(ctx, setting->name,
+                       libconfig_hash_string(setting->name));
+  if(! entry)
+    return(CONFIG_FALSE);
+
+  if(ctx->replaced)
+  {
+    /* A setting parsed on its own can't be merged into another. */
+    ctx->replaced = NULL;
+    return(CONFIG_FALSE);
+  }
+
+  entry->setting = setting;
+
+  return(CONFIG_TRUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_setting_t *libconfig_parsectx_open_member(struct parse_context *ctx,
+                                                 int type)
+{
+  config_setting_t *replaced = ctx->replaced;
+
+  if(replaced && (replaced->type == type))
+  {
+    __keep_replaced(ctx);
+
+    /* A group is merged into, member by member; an array or list is either
+     * appended to or replaced.
+     */
+    if((type != CONFIG_TYPE_GROUP)
+       && !config_get_option(ctx->config, CONFIG_OPTION_MERGE_APPEND))
+    {
+      unsigned int n = (unsigned int)config_setting_length(replaced);
+
+      while(n > 0)
+        config_setting_remove_elem(replaced, --n);
+    }
+
+    return(replaced);
+  }
+
+  ctx->setting->type = (unsigned short)type;
+  libconfig_parsectx_end_member(ctx);
+
+  return(ctx->setting);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_end_member(struct parse_context *ctx)
+{
+  config_setting_t *setting = ctx->setting, *replaced = ctx->replaced;
+
+  if(! replaced)
+    return;
+
+  if((replaced->type == setting->type)
+     && (setting->type != CONFIG_TYPE_GROUP)
+     && (setting->type != CONFIG_TYPE_ARRAY)
+     && (setting->type != CONFIG_TYPE_LIST))
+  {
+    /* Move the new scalar value into the existing member; the old value is
+     * freed along with the new member.
+     */
+    config_value_t value = replaced->value;
+
+    replaced->value = setting->value;
+    replaced->format = setting->format;
+    replaced->hash = 0;
+    setting->value = value;
+
+    __keep_replaced(ctx);
+  }
+  else
+  {
+    __remove_member(ctx->parent, replaced);
+    ctx->replaced = NULL;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_begin_span(struct parse_context *ctx,
+                                   config_setting_t *setting, size_t begin)
+{
+  struct srcmap_span *span;
+
+  if(! ctx->srcmap || ! setting)
+    return;
+
+  span = libconfig_srcmap_span(ctx->srcmap, setting);
+  span->gap = ctx->span_cursor;
+  span->begin = span->value = begin;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_open_span(struct parse_context *ctx,
+                                  config_setting_t *setting, size_t value,
+                                  size_t inner)
+{
+  struct srcmap_span *span;
+
+  if(! ctx->srcmap || ! setting)
+    return;
+
+  span = libconfig_srcmap_span(ctx->srcmap, setting);
+  span->value = value;
+  span->inner = inner;
+  ctx->span_cursor = inner;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_close_span(struct parse_context *ctx,
+                                   config_setting_t *setting,
+                                   size_t value_end)
+{
+  struct srcmap_span *span;
+
+  if(! ctx->srcmap || ! setting)
+    return;
+
+  span = libconfig_srcmap_span(ctx->srcmap, setting);
+  span->inner_end = ctx->span_cursor;
+  span->value_end = span->end = value_end;
+  ctx->span_cursor = value_end;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_end_span(struct parse_context *ctx,
+                                 config_setting_t *setting, size_t value,
+                                 size_t value_end, size_t end)
+{
+  struct srcmap_span *span;
+
+  if(! ctx->srcmap || ! setting)
+    return;
+
+  span = libconfig_srcmap_span(ctx->srcmap, setting);
+  span->value = value;
+  span->value_end = value_end;
+  span->end = end;
+  ctx->span_cursor = end;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_parsectx_separate_span(struct parse_context *ctx, int next,
+                                      size_t end)
+{
+  int n;
+
+  if(! ctx->srcmap || ! ctx->parent)
+    return;
+
+  n = config_setting_length(ctx->parent);
+
+  if(next)
+  {
+    if(n < 2)
+      return;
+
+    libconfig_srcmap_span(ctx->srcmap, config_setting_get_elem(
+                            ctx->parent, (unsigned int)n - 2))->end = end;
+    libconfig_srcmap_span(ctx->srcmap, config_setting_get_elem(
+                            ctx->parent, (unsigned int)n - 1))->gap = end;
+  }
+  else if(n > 0)
+  {
+    libconfig_srcmap_span(ctx->srcmap, config_setting_get_elem(
+                            ctx->parent, (unsigned int)n - 1))->end = end;
+    ctx->span_cursor = end;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
@@ -24,22 +24,125 @@
 #define __libconfig_parsectx_h
 
 #include "libconfig.h"
+#include "srcmap.h"
 #include "strbuf.h"
 #include "util.h"
 
+/*
+ * The names of the members of one group that is still open, for detecting
+ * duplicate settings in constant time. An open-addressed hash table.
+ */
+struct name_set_entry
+{
+  unsigned int hash;
+  config_setting_t *setting; /* NULL if the slot is free */
+};
+
+struct name_set
+{
+  struct name_set_entry *entries;
+  unsigned int capacity; /* 0 or a power of 2 */
+  unsigned int count;
+};
+
 struct parse_context
 {
   config_t *config;
   config_setting_t *parent;
   config_setting_t *setting;
+  config_setting_t *replaced; /* member being overridden, in merge mode */
   char *name;
   strbuf_t string;
+  struct name_set *groups; /* one per open group, innermost last */
+  unsigned int group_depth;
+  unsigned int group_capacity;
+  struct config_srcmap_t *srcmap; /* NULL unless preserving formatting */
+  size_t span_cursor; /* end of the text read into the tree so far */
+  unsigned long settings[CONFIG_TYPE_LIST + 1]; /* read so far, by type */
+  int recount; /* a member was overridden, so 'settings' is not exact */
 };
 
-#define libconfig_parsectx_init(C) \
-  __zero(C)
-#define libconfig_parsectx_cleanup(C) \
-  __delete(libconfig_strbuf_release(&((C)->string)))
+/*
+ * Initializes the context, with the name set for the root group open.
+ */
+extern void libconfig_parsectx_init(struct parse_context *ctx);
+extern void libconfig_parsectx_cleanup(struct parse_context *ctx);
+
+/*
+ * Opens and closes the name set for a group; called when the parser enters
+ * and leaves a group, with ctx->parent set to the group. The name set is
+ * seeded with the group's existing members, if any.
+ */
+extern void libconfig_parsectx_push_group(struct parse_context *ctx);
+extern void libconfig_parsectx_pop_group(struct parse_context *ctx);
+
+/*
+ * Adds a setting with the given name to ctx->parent, which must be the group
+ * whose name set is innermost. If a member with that name exists, it is
+ * replaced if CONFIG_OPTION_ALLOW_OVERRIDES is set; otherwise NULL is
+ * returned. If CONFIG_OPTION_MERGE_OVERRIDES is set, the existing member is
+ * kept in ctx->replaced until the type of the new value is known; see
+ * libconfig_parsectx_open_member() and libconfig_parsectx_end_member().
+ */
+extern config_setting_t *libconfig_parsectx_add_member(
+  struct parse_context *ctx, const char *name);
+
+/*
+ * Gives ctx->setting, a member just added by libconfig_parsectx_add_member(),
+ * the given aggregate type and returns the setting that the value's elements
+ * are to be added to. When merging into an existing member of the same type,
+ * that member is returned and the new one discarded.
+ */
+extern config_setting_t *libconfig_parsectx_open_member(
+  struct parse_context *ctx, int type);
+
+/*
+ * Completes the member whose value has just been parsed. When merging, a
+ * scalar value is moved into the existing member it overrides.
+ */
+extern void libconfig_parsectx_end_member(struct parse_context *ctx);
+
+/*
+ * Reserves the name of 'setting', which was parsed separately and is about to
+ * be moved into ctx->parent by the caller, as for
+ * libconfig_parsectx_add_member(). Returns CONFIG_FALSE if a member with that
+ * name exists and cannot be replaced.
+ */
+extern int libconfig_parsectx_claim_member(struct parse_context *ctx,
+                                           config_setting_t *setting);
+
+/*
+ * Record the spans of the settings being read in ctx->srcmap, if it is set,
+ * as offsets into the top-level input. A setting's span is begun at its first
+ * token, an aggregate's is opened and closed at its brackets, and a member's
+ * is ended after its terminator, if any. A separator after an element of
+ * ctx->parent, which is an array or list, belongs to the last element, or to
+ * the one before it if 'next' is set.
+ */
+extern void libconfig_parsectx_begin_span(struct parse_context *ctx,
+                                          config_setting_t *setting,
+                                          size_t begin);
+extern void libconfig_parsectx_open_span(struct parse_context *ctx,
+                                         config_setting_t *setting,
+                                         size_t value, size_t inner);
+extern void libconfig_parsectx_close_span(struct parse_context *ctx,
+                                          config_setting_t *setting,
+                                          size_t value_end);
+extern void libconfig_parsectx_end_span(struct parse_context *ctx,
+                                        config_setting_t *setting,
+                                        size_t value, size_t value_end,
+                                        size_t end);
+extern void libconfig_parsectx_separate_span(struct parse_context *ctx,
+                                             int next, size_t end);
+
+/*
+ * Counts a setting whose type is final, as one read; members are counted once
+ * their value has been read, and elements when they are added. The counts
+ * aren't corrected when a member overrides another; ctx->recount is set
+ * instead.
+ */
+#define libconfig_parsectx_count(C, S) \
+  (++((C)->settings[(S)->type]))
 
 #define libconfig_parsectx_append_string(C, S) \
   libconfig_strbuf_append_string(&((C)->string), (S))
@@ -0,0 +1,401 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "libconfig.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <ctype.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QUERY_PATH_TOKENS ":./"
+
+#define QUERY_MEMBER 0 /* the member with the given name */
+#define QUERY_ANY    1 /* every element or member */
+#define QUERY_INDEX  2 /* the element at the given index */
+#define QUERY_SLICE  3 /* the elements in the given range */
+
+/* ------------------------------------------------------------------------- */
+
+/* One element of a compiled path. A recursive step selects from the setting
+ * it is applied to and from each setting below it, in document order.
+ */
+struct query_step
+{
+  int kind;
+  int recursive;
+  const char *name; /* points into the query's copy of the expression */
+  size_t name_len;
+  long from; /* the index, or the start of the range */
+  long to;   /* the end of the range, exclusive */
+};
+
+struct config_query_t
+{
+  char *expr;
+  struct query_step *steps;
+  unsigned int num_steps;
+};
+
+/* The state of a run, shared by all of the steps. */
+struct query_run
+{
+  const config_query_t *query;
+  config_query_fn_t fn;
+  void *user;
+  int count;
+  int stopped;
+};
+
+/* The state of a recursive step, passed through config_walk(). */
+struct query_walk
+{
+  struct query_run *run;
+  unsigned int step;
+};
+
+static void __query_match(struct query_run *run, unsigned int step,
+                          config_setting_t *setting);
+
+/* ------------------------------------------------------------------------- */
+
+#define __is_query_token(C) (((C) != '\0') && strchr(QUERY_PATH_TOKENS, (C)))
+
+/* Parses an optional, possibly negative, index, and sets found to whether
+ * there was one. Returns NULL if there is a sign without digits.
+ */
+static const char *__query_parse_index(const char *p, long *index,
+                                       int *found)
+{
+  char *end;
+
+  while(isspace((unsigned char)*p))
+    ++p;
+
+  *found = CONFIG_FALSE;
+  if(! isdigit((unsigned char)*p) && (*p != '-') && (*p != '+'))
+    return(p);
+
+  *index = strtol(p, &end, 10);
+  if(end == p)
+    return(NULL);
+
+  *found = CONFIG_TRUE;
+
+  while(isspace((unsigned char)*end))
+    ++end;
+
+  return(end);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Parses the text between the brackets of "[*]", "[index]" or
+ * "[from:to]"; returns a pointer past the closing bracket, or NULL.
+ */
+static const char *__query_parse_brackets(const char *p,
+                                          struct query_step *step)
+{
+  while(isspace((unsigned char)*p))
+    ++p;
+
+  if(*p == '*')
+  {
+    step->kind = QUERY_ANY;
+
+    for(++p; isspace((unsigned char)*p); ++p)
+      ;
+  }
+  else
+  {
+    int found;
+
+    step->from = 0;
+    step->to = LONG_MAX;
+
+    p = __query_parse_index(p, &(step->from), &found);
+    if(! p)
+      return(NULL);
+
+    if(*p == ':')
+    {
+      step->kind = QUERY_SLICE;
+      p = __query_parse_index(p + 1, &(step->to), &found);
+      if(! p)
+        return(NULL);
+    }
+    else if(found)
+      step->kind = QUERY_INDEX;
+    else
+      return(NULL);
+  }
+
+  return((*p == ']') ? p + 1 : NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Resolves a possibly negative index into an aggregate of the given length;
+ * the result is clamped to [0, length].
+ */
+static long __query_resolve_index(long index, long length)
+{
+  if(index < 0)
+    index += length;
+
+  return((index < 0) ? 0 : ((index > length) ? length : index));
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Applies a step to the given setting alone, and the rest of the query to
+ * each setting that the step selects.
+ */
+static void __query_apply(struct query_run *run, unsigned int step,
+                          config_setting_t *setting)
+{
+  const struct query_step *s = run->query->steps + step;
+  long length, i, from, to;
+
+  switch(s->kind)
+  {
+    case QUERY_MEMBER:
+    {
+      config_setting_t *member = config_setting_get_member_n(
+        setting, s->name, s->name_len);
+
+      if(member)
+        __query_match(run, step + 1, member);
+      return;
+    }
+
+    case QUERY_INDEX:
+      length = config_setting_length(setting);
+      i = (s->from < 0) ? s->from + length : s->from;
+
+      if((i >= 0) && (i < length))
+        __query_match(run, step + 1,
+                      config_setting_get_elem(setting, (unsigned int)i));
+      return;
+
+    case QUERY_ANY:
+      from = 0;
+      to = config_setting_length(setting);
+      break;
+
+    default: /* QUERY_SLICE */
+      length = config_setting_length(setting);
+      from = __query_resolve_index(s->from, length);
+      to = __query_resolve_index(s->to, length);
+      break;
+  }
+
+  for(i = from; (i < to) && ! run->stopped; ++i)
+    __query_match(run, step + 1,
+                  config_setting_get_elem(setting, (unsigned int)i));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __query_walk_enter(config_setting_t *setting, unsigned int depth,
+                              void *user)
+{
+  struct query_walk *walk = (struct query_walk *)user;
+
+  (void)depth;
+
+  __query_apply(walk->run, walk->step, setting);
+
+  return(walk->run->stopped ? CONFIG_WALK_STOP : CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Evaluates the query from the given step on, reporting the setting as a
+ * match if there are no steps left.
+ */
+static void __query_match(struct query_run *run, unsigned int step,
+                          config_setting_t *setting)
+{
+  if(run->stopped)
+    return;
+
+  if(step == run->query->num_steps)
+  {
+    ++(run->count);
+    if(run->fn && (run->fn(setting, run->user) == CONFIG_WALK_STOP))
+      run->stopped = CONFIG_TRUE;
+  }
+  else if(run->query->steps[step].recursive)
+  {
+    struct query_walk walk;
+
+    walk.run = run;
+    walk.step = step;
+    config_walk(setting, __query_walk_enter, NULL, &walk);
+  }
+  else
+    __query_apply(run, step, setting);
+}
+
+/* ------------------------------------------------------------------------- */
+
+config_query_t *config_query_compile(const char *expr)
+{
+  config_query_t *query;
+  unsigned int capacity = 0;
+  const char *p;
+
+  if(! expr)
+    return(NULL);
+
+  query = __new(config_query_t);
+  query->expr = strdup(expr);
+
+  for(p = query->expr; *p; )
+  {
+    struct query_step *step;
+    int recursive = CONFIG_FALSE;
+
+    if((p[0] == '.') && (p[1] == '.'))
+    {
+      recursive = CONFIG_TRUE;
+      p += 2;
+    }
+    else if(__is_query_token(*p))
+      ++p;
+
+    if(! *p)
+    {
+      /* A trailing separator is allowed, as in a lookup path. */
+      if(recursive)
+        goto fail;
+
+      break;
+    }
+
+    if(query->num_steps == capacity)
+    {
+      capacity = capacity ? capacity * 2 : 4;
+      query->steps = (struct query_step *)libconfig_realloc(
+        query->steps, capacity * sizeof(struct query_step));
+    }
+
+    step = query->steps + (query->num_steps)++;
+    memset(step, 0, sizeof(struct query_step));
+    step->recursive = recursive;
+
+    if(*p == '[')
+    {
+      p = __query_parse_brackets(p + 1, step);
+      if(! p)
+        goto fail;
+    }
+    else
+    {
+      const char *q = p;
+
+      while(*q && (*q != '[') && ! __is_query_token(*q))
+        ++q;
+
+      if(q == p)
+        goto fail;
+
+      if((q - p == 1) && (*p == '*'))
+        step->kind = QUERY_ANY;
+      else
+      {
+        step->kind = QUERY_MEMBER;
+        step->name = p;
+        step->name_len = (size_t)(q - p);
+      }
+
+      p = q;
+    }
+  }
+
+  return(query);
+
+  fail:
+
+  config_query_destroy(query);
+  return(NULL);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_query_run(const config_query_t *query, config_setting_t *setting,
+                     config_query_fn_t fn, void *user)
+{
+  struct query_run run;
+
+  if(! query || ! setting)
+    return(0);
+
+  run.query = query;
+  run.fn = fn;
+  run.user = user;
+  run.count = 0;
+  run.stopped = CONFIG_FALSE;
+
+  __query_match(&run, 0, setting);
+
+  return(run.count);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void config_query_destroy(config_query_t *query)
+{
+  if(! query)
+    return;
+
+  __delete(query->expr);
+  __delete(query->steps);
+  __delete(query);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int config_query(config_t *config, const char *expr, config_query_fn_t fn,
+                 void *user)
+{
+  config_query_t *query;
+  int count;
+
+  if(! config)
+    return(-1);
+
+  query = config_query_compile(expr);
+  if(! query)
+    return(-1);
+
+  count = config_query_run(query, config->root, fn, user);
+  config_query_destroy(query);
+
+  return(count);
+}
+
+/* ------------------------------------------------------------------------- */
@@ -21,6 +21,7 @@
 */
 
 #include "scanctx.h"
+#include "iosource.h"
 #include "strvec.h"
 #include "wincompat.h"
 #include "util.h"
@@ -53,14 +54,7 @@ const char **libconfig_scanctx_cleanup(struct scan_context *ctx)
   int i;
 
   for(i = 0; i < ctx->stack_depth; ++i)
-  {
-    struct include_stack_frame *frame = &(ctx->include_stack[i]);
-
-    if(frame->current_stream)
-      fclose(frame->current_stream);
-
-    __delete(frame->files);
-  }
+    __delete(ctx->include_stack[i].files);
 
   __delete(libconfig_strbuf_release(&(ctx->string)));
 
@@ -69,12 +63,14 @@ const char **libconfig_scanctx_cleanup(struct scan_context *ctx)
 
 /* ------------------------------------------------------------------------- */
 
-FILE *libconfig_scanctx_push_include(struct scan_context *ctx, void *prev_buffer,
-                                     const char *path, const char **error)
+char *libconfig_scanctx_push_include(struct scan_context *ctx, void *prev_buffer,
+                                     const char *path, size_t *len,
+                                     const char **error)
 {
   struct include_stack_frame *frame;
   const char **files = NULL, **f;
-  FILE *fp;
+  char *data;
+  unsigned long long start;
 
   if(ctx->stack_depth == MAX_INCLUDE_DEPTH)
   {
@@ -84,10 +80,14 @@ FILE *libconfig_scanctx_push_include(struct scan_context *ctx, void *prev_buffer
 
   *error = NULL;
 
+  start = libconfig_time_ns();
+
   if(ctx->config->include_fn)
     files = ctx->config->include_fn(ctx->config, ctx->config->include_dir,
                                     path, error);
 
+  ctx->include_ns += libconfig_time_ns() - start;
+
   if(*error || !files)
   {
     libconfig_strvec_delete(files);
@@ -107,23 +107,24 @@ FILE *libconfig_scanctx_push_include(struct scan_context *ctx, void *prev_buffer
 
   frame->files = files;
   frame->current_file = NULL;
-  frame->current_stream = NULL;
   frame->parent_buffer = prev_buffer;
   ++(ctx->stack_depth);
 
-  fp = libconfig_scanctx_next_include_file(ctx, error);
-  if(!fp)
+  data = libconfig_scanctx_next_include_file(ctx, len, error);
+  if(!data)
     (void)libconfig_scanctx_pop_include(ctx);
 
-  return(fp);
+  return(data);
 }
 
 /* ------------------------------------------------------------------------- */
 
-FILE *libconfig_scanctx_next_include_file(struct scan_context *ctx,
-                                          const char **error)
+char *libconfig_scanctx_next_include_file(struct scan_context *ctx,
+                                          size_t *len, const char **error)
 {
   struct include_stack_frame *include_frame;
+  char *data;
+  unsigned long long start;
 
   *error = NULL;
 
@@ -137,20 +138,20 @@ FILE *libconfig_scanctx_next_include_file(struct scan_context *ctx,
   else
     include_frame->current_file = include_frame->files;
 
-  if(include_frame->current_stream)
-  {
-    fclose(include_frame->current_stream);
-    include_frame->current_stream = NULL;
-  }
-
   if(!*(include_frame->current_file))
     return(NULL);
 
-  include_frame->current_stream = fopen(*(include_frame->current_file), "rt");
-  if(!include_frame->current_stream)
+  start = libconfig_time_ns();
+  data = libconfig_io_read_file(ctx->config, *(include_frame->current_file),
+                                len);
+  ctx->include_ns += libconfig_time_ns() - start;
+
+  if(data)
+    ++(ctx->files_included);
+  else
     *error = err_bad_include;
 
-  return(include_frame->current_stream);
+  return(data);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -167,12 +168,6 @@ void *libconfig_scanctx_pop_include(struct scan_context *ctx)
   __delete(frame->files);
   frame->files = NULL;
 
-  if(frame->current_stream)
-  {
-    fclose(frame->current_stream);
-    frame->current_stream = NULL;
-  }
-
   return(frame->parent_buffer);
 }
 
@@ -180,7 +175,12 @@ void *libconfig_scanctx_pop_include(struct scan_context *ctx)
 
 char *libconfig_scanctx_take_string(struct scan_context *ctx)
 {
-  char *r = libconfig_strbuf_release(&(ctx->string));
+  char *r;
+
+  if(ctx->string.length > ctx->peak_string_size)
+    ctx->peak_string_size = ctx->string.length;
+
+  r = libconfig_strbuf_release(&(ctx->string));
 
   return(r ? r : strdup(""));
 }
@@ -33,6 +33,8 @@
 
 #define MAX_INCLUDE_DEPTH 10
 
+struct fastscan; /* fwd decl */
+
 struct include_stack_frame
 {
   /*
@@ -41,7 +43,6 @@ struct include_stack_frame
    */
   const char **files;
   const char **current_file;
-  FILE *current_stream;
   void *parent_buffer;
 };
 
@@ -53,6 +54,15 @@ struct scan_context
   int stack_depth;
   strbuf_t string;
   strvec_t filenames;
+  struct fastscan *fast; /* non-NULL if the hand-written scanner is in use */
+  int timing; /* non-zero if time spent in the scanner is to be measured */
+  /* Statistics, reported through config_get_stats(). */
+  size_t bytes_scanned;
+  unsigned long tokens;
+  unsigned int files_included;
+  size_t peak_string_size;
+  unsigned long long scan_ns; /* includes include_ns */
+  unsigned long long include_ns;
 };
 
 extern void libconfig_scanctx_init(struct scan_context *ctx,
@@ -60,35 +70,39 @@ extern void libconfig_scanctx_init(struct scan_context *ctx,
 extern const char **libconfig_scanctx_cleanup(struct scan_context *ctx);
 
 /*
- * Pushes a new frame onto the include stack, and returns an open stream to the
- * first file in the include list, if any.
+ * Pushes a new frame onto the include stack, and returns the contents of the
+ * first file in the include list, if any, read through the configuration's
+ * I/O provider.
  *
  * ctx - The scan context
  * prev_buffer - The current input buffer, to be restored when this frame is
  * popped
  * path - The string argument to the @include directive, to be expanded into a
  * list of zero or more filenames using the function ctx->config->include_fn
+ * len - A pointer at which to store the length of the file's contents
  * error - A pointer at which to store a static error message, if any.
  *
- * On success, the new frame will be pushed and the stream to the first file
- * will be returned.
+ * On success, the new frame will be pushed and the contents of the first file
+ * will be returned, in a buffer which the caller must free.
  *
  * On failure, the frame will not be pushed and NULL will be returned. If
  * *error is NULL, it means there are no files in the list. Otherwise, it
  * points to an error and parsing should be aborted.
  */
-extern FILE *libconfig_scanctx_push_include(struct scan_context *ctx,
+extern char *libconfig_scanctx_push_include(struct scan_context *ctx,
                                             void *prev_buffer,
-                                            const char *path,
+                                            const char *path, size_t *len,
                                             const char **error);
 
 /*
- * Returns the next include file in the current include stack frame.
+ * Returns the contents of the next include file in the current include stack
+ * frame, as for libconfig_scanctx_push_include().
  *
  * Returns NULL on failure or if there are no more files left in the current
  * frame. If there was an error, sets *error.
  */
-extern FILE *libconfig_scanctx_next_include_file(struct scan_context *ctx,
+extern char *libconfig_scanctx_next_include_file(struct scan_context *ctx,
+                                                 size_t *len,
                                                  const char **error);
 
 /*
@@ -99,6 +113,9 @@ extern void *libconfig_scanctx_pop_include(struct scan_context *ctx);
 #define libconfig_scanctx_append_string(C, S) \
   libconfig_strbuf_append_string(&((C)->string), (S))
 
+#define libconfig_scanctx_append_chars(C, S, L) \
+  libconfig_strbuf_append_chars(&((C)->string), (S), (L))
+
 #define libconfig_scanctx_append_char(C, X) \
   libconfig_strbuf_append_char(&((C)->string), (X))
 
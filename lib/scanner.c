@@ -931,9 +931,12 @@ static const flex_int32_t yy_rule_can_match_eol[49] =
 
 #define YY_NO_INPUT /* Suppress generation of useless input() function */
 
-#line 935 "scanner.c"
+/* Count every byte consumed by a rule, for config_get_stats(). */
+#define YY_USER_ACTION yyextra->bytes_scanned += yyleng;
 
-#line 937 "scanner.c"
+#line 938 "scanner.c"
+
+#line 940 "scanner.c"
 
 #define INITIAL 0
 #define SINGLE_LINE_COMMENT 1
@@ -1210,10 +1213,10 @@ YY_DECL
 		}
 
 	{
-#line 72 "scanner.l"
+#line 75 "scanner.l"
 
 
-#line 1217 "scanner.c"
+#line 1220 "scanner.c"
 
 	while ( /*CONSTCOND*/1 )		/* loops until end-of-file is reached */
 		{
@@ -1281,100 +1284,100 @@ do_action:	/* This label is used only to access EOF actions. */
 
 case 1:
 YY_RULE_SETUP
-#line 74 "scanner.l"
+#line 77 "scanner.l"
 { BEGIN SINGLE_LINE_COMMENT; }
 	YY_BREAK
 case 2:
 /* rule 2 can match eol */
 YY_RULE_SETUP
-#line 75 "scanner.l"
+#line 78 "scanner.l"
 { BEGIN INITIAL; }
 	YY_BREAK
 case 3:
 YY_RULE_SETUP
-#line 76 "scanner.l"
+#line 79 "scanner.l"
 { /* ignore */ }
 	YY_BREAK
 case 4:
 YY_RULE_SETUP
-#line 78 "scanner.l"
+#line 81 "scanner.l"
 { BEGIN MULTI_LINE_COMMENT; }
 	YY_BREAK
 case 5:
 YY_RULE_SETUP
-#line 79 "scanner.l"
+#line 82 "scanner.l"
 { BEGIN INITIAL; }
 	YY_BREAK
 case 6:
 YY_RULE_SETUP
-#line 80 "scanner.l"
+#line 83 "scanner.l"
 { /* ignore */ }
 	YY_BREAK
 case 7:
 /* rule 7 can match eol */
 YY_RULE_SETUP
-#line 81 "scanner.l"
+#line 84 "scanner.l"
 { /* ignore */ }
 	YY_BREAK
 case 8:
 YY_RULE_SETUP
-#line 83 "scanner.l"
+#line 86 "scanner.l"
 { BEGIN STRING; }
 	YY_BREAK
 case 9:
 /* rule 9 can match eol */
 YY_RULE_SETUP
-#line 84 "scanner.l"
+#line 87 "scanner.l"
 { libconfig_scanctx_append_string(yyextra, yytext); }
 	YY_BREAK
 case 10:
 YY_RULE_SETUP
-#line 85 "scanner.l"
+#line 88 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\a'); }
 	YY_BREAK
 case 11:
 YY_RULE_SETUP
-#line 86 "scanner.l"
+#line 89 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\b'); }
 	YY_BREAK
 case 12:
 YY_RULE_SETUP
-#line 87 "scanner.l"
+#line 90 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\n'); }
 	YY_BREAK
 case 13:
 YY_RULE_SETUP
-#line 88 "scanner.l"
+#line 91 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\r'); }
 	YY_BREAK
 case 14:
 YY_RULE_SETUP
-#line 89 "scanner.l"
+#line 92 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\t'); }
 	YY_BREAK
 case 15:
 YY_RULE_SETUP
-#line 90 "scanner.l"
+#line 93 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\v'); }
 	YY_BREAK
 case 16:
 YY_RULE_SETUP
-#line 91 "scanner.l"
+#line 94 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\f'); }
 	YY_BREAK
 case 17:
 YY_RULE_SETUP
-#line 92 "scanner.l"
+#line 95 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\\'); }
 	YY_BREAK
 case 18:
 YY_RULE_SETUP
-#line 93 "scanner.l"
+#line 96 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\"'); }
 	YY_BREAK
 case 19:
 YY_RULE_SETUP
-#line 94 "scanner.l"
+#line 97 "scanner.l"
 {
                     char c = (char)(strtol(yytext + 2, NULL, 16) & 0xFF);
                     libconfig_scanctx_append_char(yyextra, c);
@@ -1382,12 +1385,12 @@ YY_RULE_SETUP
 	YY_BREAK
 case 20:
 YY_RULE_SETUP
-#line 98 "scanner.l"
+#line 101 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\\'); }
 	YY_BREAK
 case 21:
 YY_RULE_SETUP
-#line 99 "scanner.l"
+#line 102 "scanner.l"
 {
                     yylval->sval = libconfig_scanctx_take_string(yyextra);
                     BEGIN INITIAL;
@@ -1396,40 +1399,42 @@ YY_RULE_SETUP
 	YY_BREAK
 case 22:
 YY_RULE_SETUP
-#line 105 "scanner.l"
+#line 108 "scanner.l"
 { BEGIN INCLUDE; }
 	YY_BREAK
 case 23:
 /* rule 23 can match eol */
 YY_RULE_SETUP
-#line 106 "scanner.l"
+#line 109 "scanner.l"
 { libconfig_scanctx_append_string(yyextra, yytext); }
 	YY_BREAK
 case 24:
 YY_RULE_SETUP
-#line 107 "scanner.l"
+#line 110 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\\'); }
 	YY_BREAK
 case 25:
 YY_RULE_SETUP
-#line 108 "scanner.l"
+#line 111 "scanner.l"
 { libconfig_scanctx_append_char(yyextra, '\"'); }
 	YY_BREAK
 case 26:
 YY_RULE_SETUP
-#line 109 "scanner.l"
+#line 112 "scanner.l"
 {
   const char *error = NULL;
   const char *path = libconfig_scanctx_take_string(yyextra);
-  FILE *fp = libconfig_scanctx_push_include(yyextra, (void *)YY_CURRENT_BUFFER,
-                                            path, &error);
+  size_t len;
+  char *data = libconfig_scanctx_push_include(yyextra,
+                                              (void *)YY_CURRENT_BUFFER,
+                                              path, &len, &error);
   __delete(path);
 
-  if(fp)
+  if(data)
   {
-    yyin = fp;
-    yy_switch_to_buffer(yy_create_buffer(yyin, YY_BUF_SIZE, yyscanner),
-                        yyscanner);
+    (void)yy_scan_bytes(data, (int)len, yyscanner);
+    __delete(data);
+    yyset_lineno(1, yyscanner);
   }
   else if(error)
   {
@@ -1444,57 +1449,57 @@ YY_RULE_SETUP
 case 27:
 /* rule 27 can match eol */
 YY_RULE_SETUP
-#line 132 "scanner.l"
+#line 137 "scanner.l"
 { /* ignore */ }
 	YY_BREAK
 case 28:
 YY_RULE_SETUP
-#line 133 "scanner.l"
+#line 138 "scanner.l"
 { /* ignore */ }
 	YY_BREAK
 case 29:
 YY_RULE_SETUP
-#line 135 "scanner.l"
+#line 140 "scanner.l"
 { return(TOK_EQUALS); }
 	YY_BREAK
 case 30:
 YY_RULE_SETUP
-#line 136 "scanner.l"
+#line 141 "scanner.l"
 { return(TOK_COMMA); }
 	YY_BREAK
 case 31:
 YY_RULE_SETUP
-#line 137 "scanner.l"
+#line 142 "scanner.l"
 { return(TOK_GROUP_START); }
 	YY_BREAK
 case 32:
 YY_RULE_SETUP
-#line 138 "scanner.l"
+#line 143 "scanner.l"
 { return(TOK_GROUP_END); }
 	YY_BREAK
 case 33:
 YY_RULE_SETUP
-#line 139 "scanner.l"
+#line 144 "scanner.l"
 { yylval->ival = 1; return(TOK_BOOLEAN); }
 	YY_BREAK
 case 34:
 YY_RULE_SETUP
-#line 140 "scanner.l"
+#line 145 "scanner.l"
 { yylval->ival = 0; return(TOK_BOOLEAN); }
 	YY_BREAK
 case 35:
 YY_RULE_SETUP
-#line 141 "scanner.l"
+#line 146 "scanner.l"
 { yylval->sval = yytext; return(TOK_NAME); }
 	YY_BREAK
 case 36:
 YY_RULE_SETUP
-#line 142 "scanner.l"
-{ yylval->fval = atof(yytext); return(TOK_FLOAT); }
+#line 147 "scanner.l"
+{ yylval->fval = libconfig_parse_double(yytext); return(TOK_FLOAT); }
 	YY_BREAK
 case 37:
 YY_RULE_SETUP
-#line 143 "scanner.l"
+#line 148 "scanner.l"
 {
                     long long llval;
                     int is_long;
@@ -1516,7 +1521,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 38:
 YY_RULE_SETUP
-#line 161 "scanner.l"
+#line 166 "scanner.l"
 {
                     int is_long;
 
@@ -1529,7 +1534,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 39:
 YY_RULE_SETUP
-#line 170 "scanner.l"
+#line 175 "scanner.l"
 {
                     long long llval;
                     int is_long;
@@ -1551,7 +1556,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 40:
 YY_RULE_SETUP
-#line 188 "scanner.l"
+#line 193 "scanner.l"
 {
                     long long llval;
                     int is_long;
@@ -1573,7 +1578,7 @@ YY_RULE_SETUP
 	YY_BREAK
 case 41:
 YY_RULE_SETUP
-#line 206 "scanner.l"
+#line 211 "scanner.l"
 {
                     long long llval;
                     int is_long;
@@ -1596,32 +1601,32 @@ YY_RULE_SETUP
 	YY_BREAK
 case 42:
 YY_RULE_SETUP
-#line 225 "scanner.l"
+#line 230 "scanner.l"
 { return(TOK_ARRAY_START); }
 	YY_BREAK
 case 43:
 YY_RULE_SETUP
-#line 226 "scanner.l"
+#line 231 "scanner.l"
 { return(TOK_ARRAY_END); }
 	YY_BREAK
 case 44:
 YY_RULE_SETUP
-#line 227 "scanner.l"
+#line 232 "scanner.l"
 { return(TOK_LIST_START); }
 	YY_BREAK
 case 45:
 YY_RULE_SETUP
-#line 228 "scanner.l"
+#line 233 "scanner.l"
 { return(TOK_LIST_END); }
 	YY_BREAK
 case 46:
 YY_RULE_SETUP
-#line 229 "scanner.l"
+#line 234 "scanner.l"
 { return(TOK_SEMICOLON); }
 	YY_BREAK
 case 47:
 YY_RULE_SETUP
-#line 230 "scanner.l"
+#line 235 "scanner.l"
 { return(TOK_GARBAGE); }
 	YY_BREAK
 case YY_STATE_EOF(INITIAL):
@@ -1629,18 +1634,19 @@ case YY_STATE_EOF(SINGLE_LINE_COMMENT):
 case YY_STATE_EOF(MULTI_LINE_COMMENT):
 case YY_STATE_EOF(STRING):
 case YY_STATE_EOF(INCLUDE):
-#line 232 "scanner.l"
+#line 237 "scanner.l"
 {
   const char *error = NULL;
-  FILE *fp;
+  size_t len;
+  char *data;
 
-  fp = libconfig_scanctx_next_include_file(yyextra, &error);
-  if(fp)
+  data = libconfig_scanctx_next_include_file(yyextra, &len, &error);
+  if(data)
   {
-    yyin = fp;
     yy_delete_buffer(YY_CURRENT_BUFFER, yyscanner);
-    yy_switch_to_buffer(yy_create_buffer(yyin, YY_BUF_SIZE, yyscanner),
-                        yyscanner);
+    (void)yy_scan_bytes(data, (int)len, yyscanner);
+    __delete(data);
+    yyset_lineno(1, yyscanner);
   }
   else if(error)
   {
@@ -1665,10 +1671,10 @@ case YY_STATE_EOF(INCLUDE):
 	YY_BREAK
 case 48:
 YY_RULE_SETUP
-#line 265 "scanner.l"
+#line 271 "scanner.l"
 ECHO;
 	YY_BREAK
-#line 1672 "scanner.c"
+#line 1678 "scanner.c"
 
 	case YY_END_OF_BUFFER:
 		{
@@ -2797,7 +2803,7 @@ void yyfree (void * ptr , yyscan_t yyscanner)
 
 #define YYTABLES_NAME "yytables"
 
-#line 265 "scanner.l"
+#line 271 "scanner.l"
 
 
 void *libconfig_yyalloc(size_t bytes, void *yyscanner)
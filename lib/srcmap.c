@@ -0,0 +1,126 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#include "srcmap.h"
+#include "util.h"
+#include "wincompat.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SPAN_MIN_CAPACITY 64
+
+/* ------------------------------------------------------------------------- */
+
+struct config_srcmap_t *libconfig_srcmap_create(const char *text,
+                                                size_t length)
+{
+  struct config_srcmap_t *map = __new(struct config_srcmap_t);
+
+  map->text = (char *)libconfig_malloc(length + 1);
+  memcpy(map->text, text, length);
+  map->text[length] = '\0';
+  map->length = length;
+
+  return(map);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_srcmap_destroy(struct config_srcmap_t *map)
+{
+  if(! map)
+    return;
+
+  __delete(map->text);
+  __delete(map->spans);
+  __delete(map);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct srcmap_span *libconfig_srcmap_span(struct config_srcmap_t *map,
+                                          config_setting_t *setting)
+{
+  if(setting->span == 0)
+  {
+    if(map->count == map->capacity)
+    {
+      map->capacity = (map->capacity < SPAN_MIN_CAPACITY)
+        ? SPAN_MIN_CAPACITY : map->capacity * 2;
+      map->spans = (struct srcmap_span *)libconfig_realloc(
+        map->spans, map->capacity * sizeof(struct srcmap_span));
+    }
+
+    __zero(&(map->spans[map->count]));
+    setting->span = ++(map->count);
+  }
+
+  return(map->spans + setting->span - 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+const struct srcmap_span *libconfig_srcmap_find(
+  const struct config_srcmap_t *map, const config_setting_t *setting)
+{
+  if(! map || (setting->span == 0) || (setting->span > map->count))
+    return(NULL);
+
+  return(map->spans + setting->span - 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_srcmap_seal(struct config_srcmap_t *map)
+{
+  unsigned int i;
+
+  for(i = 0; i < map->count; ++i)
+    map->spans[i].dirty = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void libconfig_srcmap_touch(struct config_srcmap_t *map,
+                            const config_setting_t *setting)
+{
+  struct srcmap_span *span;
+
+  /* The ancestors of a setting whose span is already dirty have been marked
+   * along with it, so the walk can stop there.
+   */
+  for(; setting; setting = setting->parent)
+  {
+    if((setting->span == 0) || (setting->span > map->count))
+      continue;
+
+    span = map->spans + setting->span - 1;
+    if(span->dirty)
+      break;
+
+    span->dirty = 1;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
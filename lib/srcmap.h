@@ -0,0 +1,89 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+#ifndef __libconfig_srcmap_h
+#define __libconfig_srcmap_h
+
+#include <stddef.h>
+
+#include "libconfig.h"
+
+/*
+ * The text that a configuration was read from when
+ * CONFIG_OPTION_PRESERVE_FORMATTING is set, and the span of it that each
+ * setting was read from, so that settings that haven't changed since can be
+ * written out exactly as they were read.
+ */
+
+struct srcmap_span
+{
+  size_t gap;       /* end of the previous sibling, or of the open bracket */
+  size_t begin;     /* start of the name, or of the value for an element */
+  size_t value;     /* start of the value */
+  size_t inner;     /* for an aggregate, end of the open bracket */
+  size_t inner_end; /* for an aggregate, end of the last element */
+  size_t value_end; /* end of the value */
+  size_t end;       /* end of the terminator, if any, or of the value */
+  int dirty;        /* the setting has changed since the read finished */
+};
+
+struct config_srcmap_t
+{
+  char *text;
+  size_t length;
+  struct srcmap_span *spans; /* indexed by config_setting_t::span - 1 */
+  unsigned int count;
+  unsigned int capacity;
+};
+
+extern struct config_srcmap_t *libconfig_srcmap_create(const char *text,
+                                                       size_t length);
+extern void libconfig_srcmap_destroy(struct config_srcmap_t *map);
+
+/*
+ * Returns the span of 'setting', adding one if it doesn't have one yet. The
+ * span is only valid until the next one is added.
+ */
+extern struct srcmap_span *libconfig_srcmap_span(struct config_srcmap_t *map,
+                                                 config_setting_t *setting);
+
+/*
+ * Returns the span of 'setting', or NULL if it has none.
+ */
+extern const struct srcmap_span *libconfig_srcmap_find(
+  const struct config_srcmap_t *map, const config_setting_t *setting);
+
+/*
+ * Marks every span as describing its setting as it is now, once the read has
+ * finished.
+ */
+extern void libconfig_srcmap_seal(struct config_srcmap_t *map);
+
+/*
+ * Marks the spans of 'setting' and of its ancestors as no longer describing
+ * them, when 'setting' is about to change.
+ */
+extern void libconfig_srcmap_touch(struct config_srcmap_t *map,
+                                   const config_setting_t *setting);
+
+#endif /* __libconfig_srcmap_h */
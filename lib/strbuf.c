@@ -37,7 +37,12 @@ void libconfig_strbuf_ensure_capacity(strbuf_t *buf, size_t len)
   size_t newlen = buf->length + len + 1; /* add 1 for NUL */
   if(newlen > buf->capacity)
   {
-    buf->capacity = (newlen + (STRING_BLOCK_SIZE - 1)) & mask;
+    /* Grow geometrically so that long runs of appends are O(n) overall. */
+    size_t newcap = buf->capacity * 2;
+    if(newcap < newlen)
+      newcap = newlen;
+
+    buf->capacity = (newcap + (STRING_BLOCK_SIZE - 1)) & mask;
     buf->string = (char *)libconfig_realloc(buf->string, buf->capacity);
   }
 }
@@ -63,6 +68,16 @@ void libconfig_strbuf_append_string(strbuf_t *buf, const char *s)
 
 /* ------------------------------------------------------------------------- */
 
+void libconfig_strbuf_append_chars(strbuf_t *buf, const char *s, size_t len)
+{
+  libconfig_strbuf_ensure_capacity(buf, len);
+  memcpy(buf->string + buf->length, s, len);
+  buf->length += len;
+  *(buf->string + buf->length) = '\0';
+}
+
+/* ------------------------------------------------------------------------- */
+
 void libconfig_strbuf_append_char(strbuf_t *buf, char c)
 {
   libconfig_strbuf_ensure_capacity(buf, 1);
@@ -35,6 +35,8 @@ typedef struct
 
 void libconfig_strbuf_append_string(strbuf_t *buf, const char *s);
 
+void libconfig_strbuf_append_chars(strbuf_t *buf, const char *s, size_t len);
+
 void libconfig_strbuf_append_char(strbuf_t *buf, char c);
 
 char *libconfig_strbuf_release(strbuf_t *buf);
@@ -33,7 +33,8 @@ void libconfig_strvec_append(strvec_t *vec, const char *s)
 {
   if(vec->length == vec->capacity)
   {
-    vec->capacity += CHUNK_SIZE;
+    vec->capacity = (vec->capacity < CHUNK_SIZE)
+      ? CHUNK_SIZE : vec->capacity * 2;
     vec->strings = (const char **)libconfig_realloc(
         (void *)vec->strings,
         (vec->capacity + 1) * sizeof(const char *));
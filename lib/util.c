@@ -23,10 +23,17 @@
 #include "util.h"
 #include "wincompat.h"
 
-#include <errno.h>
+#include <float.h>
+#include <limits.h>
+#include <locale.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifndef LIBCONFIG_WINDOWS_OS
+#include <sys/time.h>
+#endif
 
 /* ------------------------------------------------------------------------- */
 
@@ -61,9 +68,14 @@ void libconfig_fatal_error(const char *message)
 
 /* ------------------------------------------------------------------------- */
 
+static THREAD_LOCAL unsigned long __libconfig_allocation_count = 0;
+
+/* ------------------------------------------------------------------------- */
+
 void *libconfig_malloc(size_t size)
 {
   void *ptr = malloc(size);
+  ++__libconfig_allocation_count;
   if(!ptr)
     libconfig_fatal_error(__libconfig_malloc_failure_message);
 
@@ -75,6 +87,7 @@ void *libconfig_malloc(size_t size)
 void *libconfig_calloc(size_t nmemb, size_t size)
 {
   void *ptr = calloc(nmemb, size);
+  ++__libconfig_allocation_count;
   if(!ptr)
     libconfig_fatal_error(__libconfig_malloc_failure_message);
 
@@ -86,6 +99,7 @@ void *libconfig_calloc(size_t nmemb, size_t size)
 void *libconfig_realloc(void *ptr, size_t size)
 {
   ptr = realloc(ptr, size);
+  ++__libconfig_allocation_count;
   if(!ptr)
     libconfig_fatal_error(__libconfig_malloc_failure_message);
 
@@ -94,6 +108,67 @@ void *libconfig_realloc(void *ptr, size_t size)
 
 /* ------------------------------------------------------------------------- */
 
+unsigned long libconfig_allocation_count(void)
+{
+  return(__libconfig_allocation_count);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* FNV-1a */
+unsigned int libconfig_hash_string(const char *s)
+{
+  unsigned int h = 2166136261U;
+  const unsigned char *p;
+
+  for(p = (const unsigned char *)s; *p; ++p)
+  {
+    h ^= *p;
+    h *= 16777619U;
+  }
+
+  return(h);
+}
+
+/* ------------------------------------------------------------------------- */
+
+unsigned long long libconfig_time_ns(void)
+{
+#if defined(LIBCONFIG_WINDOWS_OS)
+
+  const unsigned long long ns_per_sec = UINT64_CONST(1000000000);
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+
+  return((unsigned long long)(count.QuadPart / freq.QuadPart) * ns_per_sec
+         + (unsigned long long)(count.QuadPart % freq.QuadPart) * ns_per_sec
+         / (unsigned long long)freq.QuadPart);
+
+#elif defined(CLOCK_MONOTONIC)
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return((unsigned long long)ts.tv_sec * UINT64_CONST(1000000000)
+         + (unsigned long long)ts.tv_nsec);
+
+#else
+
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+
+  return((unsigned long long)tv.tv_sec * UINT64_CONST(1000000000)
+         + (unsigned long long)tv.tv_usec * 1000);
+
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* Returns 1 on success, 0 on failure. Sets is_long to 1 if value is a
    64-bit int, otherwise to 0.
 */
@@ -101,11 +176,44 @@ void *libconfig_realloc(void *ptr, size_t size)
 int libconfig_parse_integer(const char *s, int base, long long *val,
                             int *is_long)
 {
-  char *endptr;
-  int errsave = errno;
+  const char *p = s;
+  unsigned long long acc = 0, limit = (unsigned long long)LLONG_MAX;
+  int neg = 0, digit;
+
+  if((*p == '-') || (*p == '+'))
+  {
+    neg = (*p == '-');
+    limit += neg;
+    ++p;
+  }
+
+  for(s = p; ; ++p)
+  {
+    if((*p >= '0') && (*p <= '9'))
+      digit = *p - '0';
+    else if(((*p | 0x20) >= 'a') && ((*p | 0x20) <= 'f'))
+      digit = (*p | 0x20) - 'a' + 10;
+    else
+      break;
+
+    if(digit >= base)
+      break;
+
+    if(acc > (limit - (unsigned long long)digit) / (unsigned)base)
+      return(0);  /* out of range */
 
-  errno = 0;
-  *val = strtoll(s, &endptr, base);
+    acc = (acc * (unsigned)base) + (unsigned long long)digit;
+  }
+
+  if(p == s)
+    return(0);  /* no digits */
+
+  if(! neg)
+    *val = (long long)acc;
+  else if(acc == limit)
+    *val = LLONG_MIN;
+  else
+    *val = -(long long)acc;
 
   if((base != 10) && (*val > INT32_MAX) && (*val <= UINT32_MAX))
     *val = (long long)(int)*val;
@@ -113,20 +221,204 @@ int libconfig_parse_integer(const char *s, int base, long long *val,
   *is_long = ((*val < INT32_MIN) || (*val > INT32_MAX));
 
   /* Check for trailing L's. */
-  while(!errno && *endptr == 'L')
+  while(*p == 'L')
   {
     *is_long = 1;
-    ++endptr;
+    ++p;
+  }
+
+  return(*p == '\0');
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Slow path for libconfig_parse_double(): hands the literal to strtod(),
+   with the '.' replaced by the decimal point of the current locale.
+*/
+static double __parse_double_strtod(const char *s)
+{
+  char local[64];
+  const char *dot = strchr(s, '.');
+  const char *point = localeconv()->decimal_point;
+  size_t len, point_len;
+  char *buf;
+  double val;
+
+  if(!dot || !strcmp(point, "."))
+    return(strtod(s, NULL));
+
+  len = strlen(s);
+  point_len = strlen(point);
+  buf = (len + point_len < sizeof(local)) ? local
+    : (char *)libconfig_malloc(len + point_len);
+
+  memcpy(buf, s, (size_t)(dot - s));
+  memcpy(buf + (dot - s), point, point_len);
+  strcpy(buf + (dot - s) + point_len, dot + 1);
+
+  val = strtod(buf, NULL);
+
+  if(buf != local)
+    __delete(buf);
+
+  return(val);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Converts a floating point literal as matched by the scanner, independently
+   of the current locale. Literals with at most 19 significant digits and a
+   small decimal exponent (which covers nearly all of them in practice) are
+   converted exactly with a single IEEE multiplication or division; the rest
+   are handed to strtod(). Either way, the result is correctly rounded.
+*/
+double libconfig_parse_double(const char *s)
+{
+  static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const uint64_t max_exact = (uint64_t)1 << 53;
+  const char *p = s;
+  uint64_t mantissa = 0;
+  int neg = 0, digits = 0, sig_digits = 0, truncated = 0, exp10 = 0;
+  double val;
+
+  if((*p == '-') || (*p == '+'))
+    neg = (*p++ == '-');
+
+  for(; (*p >= '0') && (*p <= '9'); ++p, ++digits)
+  {
+    if((mantissa == 0) && (*p == '0'))
+      continue;
+
+    if(sig_digits < 19)
+    {
+      mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+      ++sig_digits;
+    }
+    else
+    {
+      truncated |= (*p != '0');
+      ++exp10;
+    }
+  }
+
+  if(*p == '.')
+  {
+    for(++p; (*p >= '0') && (*p <= '9'); ++p, ++digits)
+    {
+      if((mantissa == 0) && (*p == '0'))
+      {
+        --exp10;
+        continue;
+      }
+
+      if(sig_digits < 19)
+      {
+        mantissa = (mantissa * 10) + (uint64_t)(*p - '0');
+        ++sig_digits;
+        --exp10;
+      }
+      else
+        truncated |= (*p != '0');
+    }
+  }
+
+  if(digits == 0)
+    return(0.0);  /* no conversion, as with atof() */
+
+  if((*p == 'e') || (*p == 'E'))
+  {
+    const char *q = p + 1;
+    int exp_neg = 0, exp = 0;
+
+    if((*q == '-') || (*q == '+'))
+      exp_neg = (*q++ == '-');
+
+    if((*q >= '0') && (*q <= '9'))
+    {
+      for(; (*q >= '0') && (*q <= '9'); ++q)
+      {
+        if(exp < 100000)
+          exp = (exp * 10) + (*q - '0');
+      }
+
+      exp10 += exp_neg ? -exp : exp;
+    }
+  }
+
+  if(mantissa == 0)
+    return(neg ? -0.0 : 0.0);
+
+#if !defined(FLT_EVAL_METHOD) || (FLT_EVAL_METHOD == 0) \
+  || (FLT_EVAL_METHOD == 1)
+
+  if(!truncated && (mantissa <= max_exact))
+  {
+    /* Both operands are exact, so the single rounding step is correct. */
+    if((exp10 >= -22) && (exp10 <= 22))
+    {
+      val = (double)mantissa;
+      val = (exp10 < 0) ? val / powers_of_ten[-exp10]
+        : val * powers_of_ten[exp10];
+      return(neg ? -val : val);
+    }
+
+    /* Move excess powers of ten into the mantissa while it stays exact. */
+    if((exp10 > 22) && (exp10 <= 22 + 15))
+    {
+      for(; (exp10 > 22) && (mantissa <= max_exact / 10); --exp10)
+        mantissa *= 10;
+
+      if(exp10 == 22)
+      {
+        val = (double)mantissa * powers_of_ten[22];
+        return(neg ? -val : val);
+      }
+    }
   }
 
-  if(*endptr || errno)
+#endif
+
+#if (LDBL_MANT_DIG >= 64)
+
+  /* Up to 19 digits are exact in the extended type, as are powers of ten up
+   * to 10^27, so x below is rounded just once. Rounding it again to double
+   * gives the correctly rounded result unless x lies exactly halfway between
+   * two doubles, which is checked for.
+   */
+  if(!truncated && (exp10 >= -27) && (exp10 <= 27))
   {
-    errno = errsave;
-    return(0);  /* parse error */
+    static const long double ext_powers_of_ten[] = {
+      1e0L, 1e1L, 1e2L, 1e3L, 1e4L, 1e5L, 1e6L, 1e7L, 1e8L, 1e9L, 1e10L,
+      1e11L, 1e12L, 1e13L, 1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L,
+      1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+    };
+    long double x = (long double)mantissa, rem;
+    uint64_t bits;
+    double next;
+
+    x = (exp10 < 0) ? x / ext_powers_of_ten[-exp10]
+      : x * ext_powers_of_ten[exp10];
+    val = (double)x;
+    rem = x - (long double)val;
+
+    if(rem == 0.0L)
+      return(neg ? -val : val);
+
+    /* val is positive, so the adjacent double is one bit pattern away. */
+    memcpy(&bits, &val, sizeof(bits));
+    bits += (rem > 0.0L) ? 1 : -1;
+    memcpy(&next, &bits, sizeof(next));
+
+    if(x != ((long double)val + (long double)next) / 2)
+      return(neg ? -val : val);
   }
-  errno = errsave;
 
-  return(1);
+#endif
+
+  return(__parse_double_strtod(s));
 }
 
 /* ------------------------------------------------------------------------- */
@@ -165,6 +457,459 @@ void libconfig_format_double(double val, int precision, int sci_ok, char *buf,
 
 /* ------------------------------------------------------------------------- */
 
+/* Shortest round-trip formatting of doubles, using the Grisu2 algorithm
+   (F. Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+   Integers", PLDI 2010), followed by a check for a shorter representation.
+   The digits produced are the shortest that convert back to the same
+   double. No part of this depends on the current locale.
+*/
+
+typedef struct
+{
+  uint64_t f;
+  int e;
+} diyfp_t;
+
+typedef struct
+{
+  uint64_t f;
+  int e;
+  int k;
+} cached_power_t;
+
+#define GRISU_ALPHA (-60)
+#define CACHED_POWERS_MIN_DEC_EXP (-300)
+#define CACHED_POWERS_DEC_STEP 8
+
+/* Normalized 64-bit approximations of 10^k for k = -300, -292, ..., 324. */
+static const cached_power_t __cached_powers[] = {
+    { UINT64_CONST(0xAB70FE17C79AC6CA), -1060, -300 },
+    { UINT64_CONST(0xFF77B1FCBEBCDC4F), -1034, -292 },
+    { UINT64_CONST(0xBE5691EF416BD60C), -1007, -284 },
+    { UINT64_CONST(0x8DD01FAD907FFC3C), -980, -276 },
+    { UINT64_CONST(0xD3515C2831559A83), -954, -268 },
+    { UINT64_CONST(0x9D71AC8FADA6C9B5), -927, -260 },
+    { UINT64_CONST(0xEA9C227723EE8BCB), -901, -252 },
+    { UINT64_CONST(0xAECC49914078536D), -874, -244 },
+    { UINT64_CONST(0x823C12795DB6CE57), -847, -236 },
+    { UINT64_CONST(0xC21094364DFB5637), -821, -228 },
+    { UINT64_CONST(0x9096EA6F3848984F), -794, -220 },
+    { UINT64_CONST(0xD77485CB25823AC7), -768, -212 },
+    { UINT64_CONST(0xA086CFCD97BF97F4), -741, -204 },
+    { UINT64_CONST(0xEF340A98172AACE5), -715, -196 },
+    { UINT64_CONST(0xB23867FB2A35B28E), -688, -188 },
+    { UINT64_CONST(0x84C8D4DFD2C63F3B), -661, -180 },
+    { UINT64_CONST(0xC5DD44271AD3CDBA), -635, -172 },
+    { UINT64_CONST(0x936B9FCEBB25C996), -608, -164 },
+    { UINT64_CONST(0xDBAC6C247D62A584), -582, -156 },
+    { UINT64_CONST(0xA3AB66580D5FDAF6), -555, -148 },
+    { UINT64_CONST(0xF3E2F893DEC3F126), -529, -140 },
+    { UINT64_CONST(0xB5B5ADA8AAFF80B8), -502, -132 },
+    { UINT64_CONST(0x87625F056C7C4A8B), -475, -124 },
+    { UINT64_CONST(0xC9BCFF6034C13053), -449, -116 },
+    { UINT64_CONST(0x964E858C91BA2655), -422, -108 },
+    { UINT64_CONST(0xDFF9772470297EBD), -396, -100 },
+    { UINT64_CONST(0xA6DFBD9FB8E5B88F), -369, -92 },
+    { UINT64_CONST(0xF8A95FCF88747D94), -343, -84 },
+    { UINT64_CONST(0xB94470938FA89BCF), -316, -76 },
+    { UINT64_CONST(0x8A08F0F8BF0F156B), -289, -68 },
+    { UINT64_CONST(0xCDB02555653131B6), -263, -60 },
+    { UINT64_CONST(0x993FE2C6D07B7FAC), -236, -52 },
+    { UINT64_CONST(0xE45C10C42A2B3B06), -210, -44 },
+    { UINT64_CONST(0xAA242499697392D3), -183, -36 },
+    { UINT64_CONST(0xFD87B5F28300CA0E), -157, -28 },
+    { UINT64_CONST(0xBCE5086492111AEB), -130, -20 },
+    { UINT64_CONST(0x8CBCCC096F5088CC), -103, -12 },
+    { UINT64_CONST(0xD1B71758E219652C), -77, -4 },
+    { UINT64_CONST(0x9C40000000000000), -50, 4 },
+    { UINT64_CONST(0xE8D4A51000000000), -24, 12 },
+    { UINT64_CONST(0xAD78EBC5AC620000), 3, 20 },
+    { UINT64_CONST(0x813F3978F8940984), 30, 28 },
+    { UINT64_CONST(0xC097CE7BC90715B3), 56, 36 },
+    { UINT64_CONST(0x8F7E32CE7BEA5C70), 83, 44 },
+    { UINT64_CONST(0xD5D238A4ABE98068), 109, 52 },
+    { UINT64_CONST(0x9F4F2726179A2245), 136, 60 },
+    { UINT64_CONST(0xED63A231D4C4FB27), 162, 68 },
+    { UINT64_CONST(0xB0DE65388CC8ADA8), 189, 76 },
+    { UINT64_CONST(0x83C7088E1AAB65DB), 216, 84 },
+    { UINT64_CONST(0xC45D1DF942711D9A), 242, 92 },
+    { UINT64_CONST(0x924D692CA61BE758), 269, 100 },
+    { UINT64_CONST(0xDA01EE641A708DEA), 295, 108 },
+    { UINT64_CONST(0xA26DA3999AEF774A), 322, 116 },
+    { UINT64_CONST(0xF209787BB47D6B85), 348, 124 },
+    { UINT64_CONST(0xB454E4A179DD1877), 375, 132 },
+    { UINT64_CONST(0x865B86925B9BC5C2), 402, 140 },
+    { UINT64_CONST(0xC83553C5C8965D3D), 428, 148 },
+    { UINT64_CONST(0x952AB45CFA97A0B3), 455, 156 },
+    { UINT64_CONST(0xDE469FBD99A05FE3), 481, 164 },
+    { UINT64_CONST(0xA59BC234DB398C25), 508, 172 },
+    { UINT64_CONST(0xF6C69A72A3989F5C), 534, 180 },
+    { UINT64_CONST(0xB7DCBF5354E9BECE), 561, 188 },
+    { UINT64_CONST(0x88FCF317F22241E2), 588, 196 },
+    { UINT64_CONST(0xCC20CE9BD35C78A5), 614, 204 },
+    { UINT64_CONST(0x98165AF37B2153DF), 641, 212 },
+    { UINT64_CONST(0xE2A0B5DC971F303A), 667, 220 },
+    { UINT64_CONST(0xA8D9D1535CE3B396), 694, 228 },
+    { UINT64_CONST(0xFB9B7CD9A4A7443C), 720, 236 },
+    { UINT64_CONST(0xBB764C4CA7A44410), 747, 244 },
+    { UINT64_CONST(0x8BAB8EEFB6409C1A), 774, 252 },
+    { UINT64_CONST(0xD01FEF10A657842C), 800, 260 },
+    { UINT64_CONST(0x9B10A4E5E9913129), 827, 268 },
+    { UINT64_CONST(0xE7109BFBA19C0C9D), 853, 276 },
+    { UINT64_CONST(0xAC2820D9623BF429), 880, 284 },
+    { UINT64_CONST(0x80444B5E7AA7CF85), 907, 292 },
+    { UINT64_CONST(0xBF21E44003ACDD2D), 933, 300 },
+    { UINT64_CONST(0x8E679C2F5E44FF8F), 960, 308 },
+    { UINT64_CONST(0xD433179D9C8CB841), 986, 316 },
+    { UINT64_CONST(0x9E19DB92B4E31BA9), 1013, 324 }
+};
+
+/* ------------------------------------------------------------------------- */
+
+static diyfp_t __diyfp_mul(diyfp_t x, diyfp_t y)
+{
+  const uint64_t u_lo = x.f & 0xFFFFFFFFu, u_hi = x.f >> 32;
+  const uint64_t v_lo = y.f & 0xFFFFFFFFu, v_hi = y.f >> 32;
+  const uint64_t p0 = u_lo * v_lo, p1 = u_lo * v_hi;
+  const uint64_t p2 = u_hi * v_lo, p3 = u_hi * v_hi;
+  uint64_t q = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+  diyfp_t r;
+
+  q += (uint64_t)1 << 31; /* round */
+
+  r.f = p3 + (p2 >> 32) + (p1 >> 32) + (q >> 32);
+  r.e = x.e + y.e + 64;
+  return(r);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static diyfp_t __diyfp_normalize(diyfp_t x)
+{
+  while((x.f >> 63) == 0)
+  {
+    x.f <<= 1;
+    --x.e;
+  }
+
+  return(x);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int __find_largest_pow10(uint32_t n, uint32_t *pow10)
+{
+  static const uint32_t powers[] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+    1000000000
+  };
+  int k;
+
+  for(k = 9; (k > 0) && (n < powers[k]); --k) ;
+
+  *pow10 = powers[k];
+  return(k + 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void __grisu2_round(char *buf, int len, uint64_t dist, uint64_t delta,
+                           uint64_t rest, uint64_t ten_k)
+{
+  /* Move the last digit towards w, as long as it stays within the rounding
+     interval and gets closer.
+  */
+  while((rest < dist) && ((delta - rest) >= ten_k)
+        && (((rest + ten_k) < dist)
+            || ((dist - rest) > (rest + ten_k - dist))))
+  {
+    --buf[len - 1];
+    rest += ten_k;
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Generates the digits of a positive, finite double into buf (at least 17
+   bytes), such that the value is digits x 10^(*decimal_exponent). Returns
+   the number of digits.
+*/
+static int __grisu2(double val, char *buf, int *decimal_exponent)
+{
+  const uint64_t hidden_bit = (uint64_t)1 << 52;
+  const cached_power_t *cached;
+  diyfp_t v, m_minus, m_plus, c, w, w_minus, w_plus, one;
+  uint64_t bits, delta, dist, p2, rest;
+  uint32_t p1, pow10, d;
+  int biased_e, f, k, n, len = 0;
+
+  memcpy(&bits, &val, sizeof(bits));
+  biased_e = (int)((bits >> 52) & 0x7FF);
+  v.f = bits & (hidden_bit - 1);
+
+  if(biased_e == 0)
+  {
+    v.e = 1 - 1075;
+    m_minus.f = 2 * v.f - 1;
+    m_minus.e = v.e - 1;
+  }
+  else
+  {
+    /* The lower boundary is closer if the significand is a power of two. */
+    int lower_closer = ((v.f == 0) && (biased_e > 1));
+
+    v.f += hidden_bit;
+    v.e = biased_e - 1075;
+    m_minus.f = lower_closer ? (4 * v.f - 1) : (2 * v.f - 1);
+    m_minus.e = lower_closer ? (v.e - 2) : (v.e - 1);
+  }
+
+  m_plus.f = 2 * v.f + 1;
+  m_plus.e = v.e - 1;
+
+  m_plus = __diyfp_normalize(m_plus);
+  m_minus.f <<= (m_minus.e - m_plus.e);
+  m_minus.e = m_plus.e;
+  v = __diyfp_normalize(v);
+
+  /* Scale by a cached power of ten, bringing the binary exponent of the
+     products into [-60, -32].
+  */
+  f = GRISU_ALPHA - m_plus.e - 1;
+  k = (f * 78913) / (1 << 18) + (f > 0);
+  cached = &__cached_powers[(-CACHED_POWERS_MIN_DEC_EXP + k
+                             + (CACHED_POWERS_DEC_STEP - 1))
+                            / CACHED_POWERS_DEC_STEP];
+  c.f = cached->f;
+  c.e = cached->e;
+
+  w = __diyfp_mul(v, c);
+  w_minus = __diyfp_mul(m_minus, c);
+  w_plus = __diyfp_mul(m_plus, c);
+
+  /* Shrink the interval by one unit on each side to account for the errors
+     of the multiplications above.
+  */
+  ++w_minus.f;
+  --w_plus.f;
+
+  *decimal_exponent = -cached->k;
+
+  delta = w_plus.f - w_minus.f;
+  dist = w_plus.f - w.f;
+
+  one.e = w_plus.e;
+  one.f = (uint64_t)1 << -one.e;
+
+  p1 = (uint32_t)(w_plus.f >> -one.e);
+  p2 = w_plus.f & (one.f - 1);
+
+  /* Integral digits. */
+  for(n = __find_largest_pow10(p1, &pow10); n > 0; pow10 /= 10)
+  {
+    d = p1 / pow10;
+    p1 %= pow10;
+    buf[len++] = (char)('0' + d);
+    --n;
+
+    rest = ((uint64_t)p1 << -one.e) + p2;
+    if(rest <= delta)
+    {
+      *decimal_exponent += n;
+      __grisu2_round(buf, len, dist, delta, rest,
+                     (uint64_t)pow10 << -one.e);
+      return(len);
+    }
+  }
+
+  /* Fractional digits. */
+  for(n = 0; ; )
+  {
+    p2 *= 10;
+    d = (uint32_t)(p2 >> -one.e);
+    p2 &= one.f - 1;
+    buf[len++] = (char)('0' + d);
+    ++n;
+
+    delta *= 10;
+    dist *= 10;
+
+    if(p2 <= delta)
+      break;
+  }
+
+  *decimal_exponent -= n;
+  __grisu2_round(buf, len, dist, delta, p2, one.f);
+  return(len);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Tries to replace the n digits in buf (with decimal exponent *exp10) by n-1
+   digits that still convert back to val. Returns 1 on success. Grisu2 works
+   within a slightly narrowed rounding interval, and so very occasionally
+   misses a shorter representation (1e23 being a well known example). If
+   any shorter representation exists, one of the two (n-1)-digit neighbors
+   of buf converts back to val as well, so checking just those is enough.
+*/
+static int __shorten(double val, char *buf, int *len, int *exp10)
+{
+  char candidate[32], *p;
+  int n = *len - 1, attempt, i, x;
+
+  for(attempt = 0; attempt < 2; ++attempt)
+  {
+    /* Try rounding up first if the dropped digit is at least 5. */
+    int up = (attempt == 0) == (buf[n] >= '5');
+    int e = *exp10 + 1;
+
+    memcpy(candidate, buf, (size_t)n);
+    if(up)
+    {
+      for(i = n - 1; (i >= 0) && (candidate[i] == '9'); --i)
+        candidate[i] = '0';
+
+      if(i < 0)
+      {
+        /* 99..9 rounds up to 10^n */
+        candidate[0] = '1';
+        memset(candidate + 1, '0', (size_t)(n - 1));
+        ++e;
+      }
+      else
+        ++candidate[i];
+    }
+
+    p = candidate + n;
+    *p++ = 'e';
+    x = e;
+    if(x < 0)
+    {
+      *p++ = '-';
+      x = -x;
+    }
+    if(x >= 100)
+      *p++ = (char)('0' + x / 100);
+    if(x >= 10)
+      *p++ = (char)('0' + (x / 10) % 10);
+    *p++ = (char)('0' + x % 10);
+    *p = '\0';
+
+    if(libconfig_parse_double(candidate) == val)
+    {
+      memcpy(buf, candidate, (size_t)n);
+
+      /* Drop trailing zeros. */
+      for(; (n > 1) && (buf[n - 1] == '0'); --n)
+        ++e;
+
+      *len = n;
+      *exp10 = e;
+      return(1);
+    }
+  }
+
+  return(0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+size_t libconfig_format_double_shortest(double val, int sci_ok, char *buf)
+{
+  char digits[20];
+  char *p = buf;
+  int len, exp10, point, i;
+  uint64_t bits;
+
+  if(val != val)
+  {
+    strcpy(buf, "nan");
+    return(3);
+  }
+
+  memcpy(&bits, &val, sizeof(bits));
+  if(bits >> 63)
+  {
+    *p++ = '-';
+    val = -val;
+  }
+
+  if(val == 0.0)
+  {
+    strcpy(p, "0.0");
+    return((size_t)(p - buf) + 3);
+  }
+
+  if(val > DBL_MAX)
+  {
+    strcpy(p, "inf");
+    return((size_t)(p - buf) + 3);
+  }
+
+  len = __grisu2(val, digits, &exp10);
+  while((len > 1) && __shorten(val, digits, &len, &exp10)) ;
+
+  /* The value is 0.DDD x 10^point. */
+  point = len + exp10;
+
+  if(sci_ok && ((point < -3) || (point > 17)))
+  {
+    /* d.ddde[+-]xx, as printf("%g") would write it */
+    *p++ = digits[0];
+    if(len > 1)
+    {
+      *p++ = '.';
+      memcpy(p, digits + 1, (size_t)(len - 1));
+      p += len - 1;
+    }
+
+    exp10 = point - 1;
+    *p++ = 'e';
+    *p++ = (exp10 < 0) ? '-' : '+';
+    if(exp10 < 0)
+      exp10 = -exp10;
+
+    if(exp10 >= 100)
+      *p++ = (char)('0' + exp10 / 100);
+    *p++ = (char)('0' + (exp10 / 10) % 10);
+    *p++ = (char)('0' + exp10 % 10);
+  }
+  else if(point <= 0)
+  {
+    /* 0.000ddd */
+    *p++ = '0';
+    *p++ = '.';
+    for(i = point; i < 0; ++i)
+      *p++ = '0';
+    memcpy(p, digits, (size_t)len);
+    p += len;
+  }
+  else if(point >= len)
+  {
+    /* ddd000.0 */
+    memcpy(p, digits, (size_t)len);
+    p += len;
+    for(i = len; i < point; ++i)
+      *p++ = '0';
+    *p++ = '.';
+    *p++ = '0';
+  }
+  else
+  {
+    /* ddd.ddd */
+    memcpy(p, digits, (size_t)point);
+    p += point;
+    *p++ = '.';
+    memcpy(p, digits + point, (size_t)(len - point));
+    p += len - point;
+  }
+
+  *p = '\0';
+  return((size_t)(p - buf));
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* buf must be at least 65 bytes. Return value is pointer to most significant
    nonzero bit, or pointer to the least significant zero bit if value is 0. */
 
@@ -38,10 +38,29 @@ extern void *libconfig_realloc(void *ptr, size_t size);
 #define __delete(P) free((void *)(P))
 #define __zero(P) memset((void *)(P), 0, sizeof(*P))
 
+/* The number of allocations made by the calling thread via the functions
+ * above; used to report per-read allocation counts.
+ */
+extern unsigned long libconfig_allocation_count(void);
+
+/* A fast, non-cryptographic hash of a NUL-terminated string. */
+extern unsigned int libconfig_hash_string(const char *s);
+
+/* A monotonic timestamp, in nanoseconds. */
+extern unsigned long long libconfig_time_ns(void);
+
 extern int libconfig_parse_integer(const char *s, int base, long long *val,
                                    int *is_long);
 
+extern double libconfig_parse_double(const char *s);
+
 extern void libconfig_format_double(double val, int precision, int sci_ok,
                                     char *buf, size_t buflen);
 
+/* Large enough for any double written without an exponent. */
+#define FORMAT_DOUBLE_SHORTEST_BUFSIZE 336
+
+extern size_t libconfig_format_double_shortest(double val, int sci_ok,
+                                               char *buf);
+
 extern char *libconfig_format_bin(int64_t val, char *buf);
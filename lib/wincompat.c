@@ -57,4 +57,18 @@ int posix_fsync(int fd)
   return(0);
 }
 
+/* ------------------------------------------------------------------------- */
+
+int posix_rename(const char *from, const char *to)
+{
+  if(! MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING
+                   | MOVEFILE_WRITE_THROUGH))
+  {
+    errno = EACCES;
+    return(-1);
+  }
+
+  return(0);
+}
+
 #endif /* LIBCONFIG_WINDOWS_OS */
@@ -138,4 +138,34 @@ extern int posix_fsync(int fd);
 
 #endif /* defined(LIBCONFIG_WINDOWS_OS) && !defined(LIBCONFIG_MINGW_OS) */
 
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
+#include <fcntl.h>
+
+#ifdef LIBCONFIG_WINDOWS_OS
+
+#include <process.h>
+
+#define posix_open   _open
+#define posix_close  _close
+#define posix_getpid _getpid
+
+/* Unlike rename(), replaces the target if it exists. */
+extern int posix_rename(const char *from, const char *to);
+
+#else /* LIBCONFIG_WINDOWS_OS */
+
+#define posix_open   open
+#define posix_close  close
+#define posix_getpid getpid
+#define posix_rename rename
+
+#endif /* LIBCONFIG_WINDOWS_OS */
+
 #endif /* __wincompat_h */
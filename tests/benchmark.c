@@ -0,0 +1,780 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+/* Micro-benchmarks for libconfig. Each benchmark is run at increasing
+ * problem sizes and reports the time per element, so that super-linear
+ * behavior shows up as a growing per-element cost.
+ *
+ * Usage: libconfig_benchmark [name ...]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libconfig.h>
+
+/* ------------------------------------------------------------------------- */
+
+typedef void (*bench_fn_t)(unsigned int n);
+
+struct benchmark
+{
+  const char *name;
+  bench_fn_t func;
+  unsigned int min_n;
+  unsigned int max_n;
+};
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_list_append(unsigned int n)
+{
+  config_t cfg;
+  config_setting_t *list;
+  unsigned int i;
+
+  config_init(&cfg);
+  list = config_setting_add(config_root_setting(&cfg), "list",
+                            CONFIG_TYPE_LIST);
+
+  for(i = 0; i < n; ++i)
+    config_setting_set_int_elem(list, -1, (int)i);
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_list_append_reserved(unsigned int n)
+{
+  config_t cfg;
+  config_setting_t *list;
+  unsigned int i;
+
+  config_init(&cfg);
+  list = config_setting_add(config_root_setting(&cfg), "list",
+                            CONFIG_TYPE_LIST);
+  config_setting_reserve(list, n);
+
+  for(i = 0; i < n; ++i)
+    config_setting_set_int_elem(list, -1, (int)i);
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void parse(const char *buf, int fast)
+{
+  config_t cfg;
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, fast);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_array(unsigned int n)
+{
+  char *buf, *p;
+  unsigned int i;
+
+  buf = (char *)malloc((size_t)n * 12 + 16);
+  p = buf + sprintf(buf, "a = [");
+  for(i = 0; i < n; ++i)
+    p += sprintf(p, "%u,", i);
+  strcpy(p, "0];");
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_float_array(unsigned int n)
+{
+  char *buf, *p;
+  unsigned int i;
+  int j;
+  unsigned long long x = 88172645463325252ULL;
+
+  /* Literals with 17 significant digits, as written by "%.17g", built without
+   * printf() so that generating them doesn't dominate the timing.
+   */
+  buf = (char *)malloc((size_t)n * 20 + 16);
+  p = buf + sprintf(buf, "a = [");
+  for(i = 0; i < n; ++i)
+  {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+
+    for(j = 0; j < 17; ++j)
+    {
+      p[j + (j >= 3)] = (char)('0' + (x >> (j * 3)) % 10);
+      if(j == 0 && p[0] == '0')
+        p[0] = '1';
+    }
+    p[3] = '.';
+    p[18] = ',';
+    p += 19;
+  }
+  strcpy(p, "0.0];");
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_string(unsigned int n)
+{
+  char *buf;
+
+  buf = (char *)malloc((size_t)n + 16);
+  strcpy(buf, "s = \"");
+  memset(buf + 5, 'x', n);
+  strcpy(buf + 5 + n, "\";");
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_wide_group(unsigned int n)
+{
+  char *buf, *p;
+  unsigned int i;
+
+  buf = (char *)malloc((size_t)n * 24 + 16);
+  p = buf + sprintf(buf, "g = {");
+  for(i = 0; i < n; ++i)
+    p += sprintf(p, "k%u = %u;", i, i);
+  strcpy(p, "};");
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_array(unsigned int n)
+{
+  char *buf = make_array(n);
+
+  parse(buf, 0);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_array_fast(unsigned int n)
+{
+  char *buf = make_array(n);
+
+  parse(buf, 1);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_floats(unsigned int n)
+{
+  char *buf = make_float_array(n);
+
+  parse(buf, 0);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_floats_fast(unsigned int n)
+{
+  char *buf = make_float_array(n);
+
+  parse(buf, 1);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_string(unsigned int n)
+{
+  char *buf = make_string(n);
+
+  parse(buf, 0);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_string_fast(unsigned int n)
+{
+  char *buf = make_string(n);
+
+  parse(buf, 1);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_top_level(unsigned int n)
+{
+  char *buf, *p;
+  unsigned int i;
+
+  buf = (char *)malloc((size_t)n * 48 + 1);
+  p = buf;
+  for(i = 0; i < n; ++i)
+    p += sprintf(p, "k%u = { a = %u; b = \"v%u\"; };\n", i, i, i);
+  *p = '\0';
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_wide_group(unsigned int n)
+{
+  char *buf = make_wide_group(n);
+
+  parse(buf, 0);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_wide_group_fast(unsigned int n)
+{
+  char *buf = make_wide_group(n);
+
+  parse(buf, 1);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_top_level(unsigned int n)
+{
+  char *buf = make_top_level(n);
+
+  parse(buf, 1);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_top_level_parallel(unsigned int n)
+{
+  config_t cfg;
+  char *buf = make_top_level(n);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_PARALLEL_PARSE, 1);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+  config_destroy(&cfg);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void parse_push(const char *buf, size_t chunk)
+{
+  config_t cfg;
+  config_parser_t *parser;
+  size_t len = strlen(buf), i;
+
+  config_init(&cfg);
+  parser = config_parser_new(&cfg);
+  for(i = 0; i < len; i += chunk)
+    config_parser_feed(parser, buf + i, (len - i < chunk) ? len - i : chunk);
+  if(! config_parser_finish(parser))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+  config_parser_destroy(parser);
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_array_push(unsigned int n)
+{
+  char *buf = make_array(n);
+
+  parse_push(buf, 4096);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_parse_string_push(unsigned int n)
+{
+  char *buf = make_string(n);
+
+  /* A single token spanning many chunks. */
+  parse_push(buf, 4096);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void write_floats(unsigned int n, int round_trip)
+{
+  config_t cfg;
+  config_setting_t *array;
+  unsigned int i;
+  FILE *fp = tmpfile();
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_ROUND_TRIP_FLOATS, round_trip);
+  array = config_setting_add(config_root_setting(&cfg), "a",
+                             CONFIG_TYPE_ARRAY);
+  config_setting_reserve(array, n);
+
+  for(i = 0; i < n; ++i)
+    config_setting_set_float_elem(array, -1, (double)i / 7.0);
+
+  config_write(&cfg, fp);
+  fclose(fp);
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_floats(unsigned int n)
+{
+  write_floats(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_floats_round_trip(unsigned int n)
+{
+  write_floats(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Reads a configuration, then changes one value and writes it out again a
+ * number of times, as a program that edits its own configuration would.
+ */
+static void write_edits(unsigned int n, int preserve)
+{
+  config_t cfg;
+  char *buf = make_top_level(n);
+  FILE *fp = tmpfile();
+  int i;
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, 1);
+  config_set_option(&cfg, CONFIG_OPTION_PRESERVE_FORMATTING, preserve);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+
+  for(i = 0; i < 10; ++i)
+  {
+    config_setting_set_int(config_lookup(&cfg, "k0.a"), i);
+    rewind(fp);
+    config_write(&cfg, fp);
+  }
+
+  fclose(fp);
+  config_destroy(&cfg);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_edits(unsigned int n)
+{
+  write_edits(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_edits_preserved(unsigned int n)
+{
+  write_edits(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* As write_edits(), but with the changes appended to a journal rather than
+ * the configuration being written out after each one.
+ */
+static void bench_write_edits_journaled(unsigned int n)
+{
+  static const char *file = "benchmark_journal.cfg";
+  static const char *journal = "benchmark_journal.cfg.journal";
+  config_t cfg;
+  char *buf = make_top_level(n);
+  FILE *fp = fopen(file, "wt");
+  int i;
+
+  fputs(buf, fp);
+  fclose(fp);
+  remove(journal);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, 1);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, 1);
+  if(! config_read_file(&cfg, file))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+
+  for(i = 0; i < 10; ++i)
+    config_setting_set_int(config_lookup(&cfg, "k0.a"), i);
+
+  config_destroy(&cfg);
+  free(buf);
+  remove(file);
+  remove(journal);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Writes a configuration of n top-level groups to a file, in place or by
+ * replacing the file.
+ */
+static void write_file(unsigned int n, int atomic)
+{
+  static const char *file = "benchmark_write.cfg";
+  config_t cfg;
+  char *buf = make_top_level(n);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, 1);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+
+  config_set_option(&cfg, CONFIG_OPTION_FSYNC, 1);
+  config_set_option(&cfg, CONFIG_OPTION_ATOMIC_WRITE, atomic);
+  if(! config_write_file(&cfg, file))
+    fprintf(stderr, "write error\n");
+
+  config_destroy(&cfg);
+  free(buf);
+  remove(file);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_file(unsigned int n)
+{
+  write_file(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_write_file_atomic(unsigned int n)
+{
+  write_file(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int sum_int(config_setting_t *setting, void *user)
+{
+  *(long long *)user += config_setting_get_int(setting);
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Collects the "a" member of each of n top-level groups a number of times,
+ * by looking up each group's member in turn, or with a compiled query.
+ */
+static void collect_members(unsigned int n, int compiled)
+{
+  config_t cfg;
+  config_query_t *query = config_query_compile("*.a");
+  char *buf = make_top_level(n);
+  long long sum = 0;
+  int i;
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, 1);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+
+  for(i = 0; i < 10; ++i)
+  {
+    if(compiled)
+      config_query_run(query, config_root_setting(&cfg), sum_int, &sum);
+    else
+    {
+      config_setting_t *root = config_root_setting(&cfg);
+      int j, len = config_setting_length(root);
+      int value;
+
+      for(j = 0; j < len; ++j)
+      {
+        if(config_setting_lookup_int(config_setting_get_elem(root, j), "a",
+                                     &value))
+          sum += value;
+      }
+    }
+  }
+
+  if(sum != (long long)n * (n - 1) / 2 * 10)
+    fprintf(stderr, "wrong sum: %lld\n", sum);
+
+  config_query_destroy(query);
+  config_destroy(&cfg);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_query_loop(unsigned int n)
+{
+  collect_members(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_query_wildcard(unsigned int n)
+{
+  collect_members(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Finds 100 of n records by id, by scanning the list or with an index. */
+static void find_records(unsigned int n, int indexed)
+{
+  config_t cfg;
+  config_setting_t *list, *record;
+  config_index_t *index = NULL;
+  unsigned int i, j;
+  int found = 0, id;
+
+  config_init(&cfg);
+  list = config_setting_add(config_root_setting(&cfg), "users",
+                            CONFIG_TYPE_LIST);
+  config_setting_reserve(list, n);
+
+  for(i = 0; i < n; ++i)
+  {
+    record = config_setting_add(list, NULL, CONFIG_TYPE_GROUP);
+    config_setting_set_int(config_setting_add(record, "id", CONFIG_TYPE_INT),
+                           (int)i);
+  }
+
+  if(indexed)
+    index = config_setting_build_index(list, "id");
+
+  for(i = 0; i < 100; ++i)
+  {
+    int key = (int)(((unsigned long long)i * 7919) % n);
+
+    if(indexed)
+      found += (config_index_find_int(index, key) != NULL);
+    else
+    {
+      for(j = 0; j < n; ++j)
+      {
+        record = config_setting_get_elem(list, j);
+        if(config_setting_lookup_int(record, "id", &id) && (id == key))
+        {
+          ++found;
+          break;
+        }
+      }
+    }
+  }
+
+  if(found != 100)
+    fprintf(stderr, "found %d records\n", found);
+
+  config_index_destroy(index);
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_find_records_scan(unsigned int n)
+{
+  find_records(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_find_records_indexed(unsigned int n)
+{
+  find_records(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Looks up a member of each of n top-level groups, one path element at a
+ * time, or in the table of a frozen configuration. The walk searches the
+ * top-level group linearly, so its cost per lookup grows with n.
+ */
+static void lookup_paths(unsigned int n, int frozen)
+{
+  config_t cfg;
+  char *buf = make_top_level(n);
+  char **paths = (char **)malloc(n * sizeof(char *));
+  unsigned int i, found = 0;
+
+  for(i = 0; i < n; ++i)
+  {
+    paths[i] = (char *)malloc(16);
+    sprintf(paths[i], "k%u.b", (i * 7919) % n);
+  }
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, 1);
+  if(! config_read_string(&cfg, buf))
+    fprintf(stderr, "parse error: %s\n", config_error_text(&cfg));
+
+  if(frozen && ! config_freeze(&cfg))
+    fprintf(stderr, "freeze failed\n");
+
+  for(i = 0; i < n; ++i)
+    found += (config_lookup(&cfg, paths[i]) != NULL);
+
+  if(found != n)
+    fprintf(stderr, "found %u settings\n", found);
+
+  for(i = 0; i < n; ++i)
+    free(paths[i]);
+
+  free(paths);
+  config_destroy(&cfg);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_lookup_paths(unsigned int n)
+{
+  lookup_paths(n, 0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void bench_lookup_paths_frozen(unsigned int n)
+{
+  lookup_paths(n, 1);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static const struct benchmark benchmarks[] = {
+  { "list_append", bench_list_append, 10000, 1000000 },
+  { "list_append_reserved", bench_list_append_reserved, 10000, 1000000 },
+  { "parse_array", bench_parse_array, 10000, 1000000 },
+  { "parse_array_fast", bench_parse_array_fast, 10000, 1000000 },
+  { "parse_floats", bench_parse_floats, 10000, 1000000 },
+  { "parse_floats_fast", bench_parse_floats_fast, 10000, 1000000 },
+  { "parse_string", bench_parse_string, 100000, 10000000 },
+  { "parse_string_fast", bench_parse_string_fast, 100000, 10000000 },
+  { "parse_wide_group", bench_parse_wide_group, 10000, 1000000 },
+  { "parse_wide_group_fast", bench_parse_wide_group_fast, 10000, 1000000 },
+  { "parse_top_level", bench_parse_top_level, 10000, 1000000 },
+  { "parse_top_level_parallel", bench_parse_top_level_parallel, 10000,
+    1000000 },
+  { "parse_array_push", bench_parse_array_push, 10000, 1000000 },
+  { "parse_string_push", bench_parse_string_push, 100000, 10000000 },
+  { "write_floats", bench_write_floats, 10000, 1000000 },
+  { "write_floats_round_trip", bench_write_floats_round_trip, 10000,
+    1000000 },
+  { "write_edits", bench_write_edits, 10000, 1000000 },
+  { "write_edits_preserved", bench_write_edits_preserved, 10000, 1000000 },
+  { "write_edits_journaled", bench_write_edits_journaled, 10000, 1000000 },
+  { "write_file", bench_write_file, 10000, 1000000 },
+  { "write_file_atomic", bench_write_file_atomic, 10000, 1000000 },
+  { "query_loop", bench_query_loop, 10000, 1000000 },
+  { "query_wildcard", bench_query_wildcard, 10000, 1000000 },
+  { "find_records_scan", bench_find_records_scan, 10000, 1000000 },
+  { "find_records_indexed", bench_find_records_indexed, 10000, 1000000 },
+  { "lookup_paths", bench_lookup_paths, 1000, 10000 },
+  { "lookup_paths_frozen", bench_lookup_paths_frozen, 1000, 100000 },
+  { NULL, NULL, 0, 0 }
+};
+
+/* ------------------------------------------------------------------------- */
+
+/* Elapsed rather than processor time, so that parallel work is not counted
+ * once per thread.
+ */
+static double now(void)
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1e-9);
+#else
+  return((double)clock() / CLOCKS_PER_SEC);
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int selected(const char *name, int argc, char **argv)
+{
+  int i;
+
+  if(argc < 2)
+    return(1);
+
+  for(i = 1; i < argc; ++i)
+  {
+    if(! strcmp(argv[i], name))
+      return(1);
+  }
+
+  return(0);
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main(int argc, char **argv)
+{
+  const struct benchmark *b;
+
+  for(b = benchmarks; b->name; ++b)
+  {
+    unsigned int n;
+
+    if(! selected(b->name, argc, argv))
+      continue;
+
+    for(n = b->min_n; n <= b->max_n; n *= 10)
+    {
+      double start = now(), secs;
+
+      b->func(n);
+
+      secs = now() - start;
+      printf("%-28s n=%-10u %10.3f ms %10.1f ns/elem\n", b->name, n,
+             secs * 1e3, secs * 1e9 / n);
+    }
+  }
+
+  return(EXIT_SUCCESS);
+}
@@ -0,0 +1,344 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+
+/* Micro-benchmarks for libconfig++. Each benchmark is run at increasing
+ * problem sizes and reports the time per element of the part being measured,
+ * along with the number of calls to operator new made during it.
+ *
+ * Usage: libconfig_cxx_benchmark [name ...]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+
+#include <libconfig.h++>
+
+#if __cplusplus >= 201103L
+#include <type_traits>
+#endif
+
+using namespace libconfig;
+
+// ---------------------------------------------------------------------------
+
+static unsigned long news = 0;
+
+void *operator new(std::size_t size)
+{
+  void *ptr = std::malloc(size ? size : 1);
+
+  if(! ptr)
+    throw std::bad_alloc();
+
+  ++news;
+  return(ptr);
+}
+
+void operator delete(void *ptr) LIBCONFIGXX_NOEXCEPT
+{
+  std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t size) LIBCONFIGXX_NOEXCEPT
+{
+  (void)size;
+  operator delete(ptr);
+}
+
+// ---------------------------------------------------------------------------
+
+typedef void (*bench_fn_t)(unsigned int n);
+
+struct benchmark
+{
+  const char *name;
+  bench_fn_t func;
+  unsigned int min_n;
+  unsigned int max_n;
+};
+
+#if __cplusplus >= 201103L
+static_assert(std::is_trivially_copyable<SettingView>::value
+              && (sizeof(SettingView) == sizeof(void *)),
+              "SettingView must be a trivially copyable pointer");
+#endif
+
+// ---------------------------------------------------------------------------
+
+// Elapsed rather than processor time, as in benchmark.c.
+static double now()
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return((double)ts.tv_sec + (double)ts.tv_nsec * 1e-9);
+#else
+  return((double)clock() / CLOCKS_PER_SEC);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+
+// The part of a benchmark being measured, which excludes its setup.
+static double measured_start, measured_secs;
+static unsigned long measured_news;
+
+static void start_measuring()
+{
+  measured_news = news;
+  measured_start = now();
+}
+
+static void stop_measuring()
+{
+  measured_secs = now() - measured_start;
+  measured_news = news - measured_news;
+}
+
+// ---------------------------------------------------------------------------
+
+// Reads an array of n integers, so that no Setting objects exist yet.
+static void read_array(Config &cfg, unsigned int n)
+{
+  std::string str = "a = [";
+  char buf[16];
+
+  for(unsigned int i = 0; i < n; ++i)
+  {
+    sprintf(buf, "%u,", i);
+    str += buf;
+  }
+  str += "0];";
+
+  cfg.readString(str);
+}
+
+// ---------------------------------------------------------------------------
+
+static long long sum_setting(const Setting &array)
+{
+  long long sum = 0;
+
+  for(Setting::const_iterator it = array.begin(); it != array.end(); ++it)
+    sum += static_cast<int>(*it);
+
+  return(sum);
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_iterate_setting(unsigned int n)
+{
+  Config cfg;
+
+  read_array(cfg, n);
+
+  start_measuring();
+  sum_setting(cfg.lookup("a"));
+  stop_measuring();
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_iterate_setting_again(unsigned int n)
+{
+  Config cfg;
+
+  read_array(cfg, n);
+
+  // The first pass attaches a Setting to each element.
+  sum_setting(cfg.lookup("a"));
+
+  start_measuring();
+  sum_setting(cfg.lookup("a"));
+  stop_measuring();
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_iterate_view(unsigned int n)
+{
+  Config cfg;
+  long long sum = 0;
+
+  read_array(cfg, n);
+
+  start_measuring();
+  SettingView array = SettingView(cfg.getRoot())["a"];
+  for(SettingView::iterator it = array.begin(); it != array.end(); ++it)
+    sum += static_cast<int>(*it);
+  stop_measuring();
+
+  if(sum != sum_setting(cfg.lookup("a")))
+    printf("mismatch\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static const char *flags_config =
+  "flags = { search = { enabled = true; limit = 50; }; };";
+
+// ---------------------------------------------------------------------------
+
+static void bench_lookup_miss_throw(unsigned int n)
+{
+  Config cfg;
+  unsigned int misses = 0;
+
+  cfg.readString(flags_config);
+
+  start_measuring();
+  for(unsigned int i = 0; i < n; ++i)
+  {
+    try
+    {
+      cfg.lookup("flags.search.beta");
+    }
+    catch(const SettingNotFoundException &)
+    {
+      ++misses;
+    }
+  }
+  stop_measuring();
+
+  if(misses != n)
+    printf("mismatch\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_lookup_miss_try(unsigned int n)
+{
+  Config cfg;
+  unsigned int misses = 0;
+
+  cfg.readString(flags_config);
+
+  start_measuring();
+  for(unsigned int i = 0; i < n; ++i)
+  {
+    if(cfg.tryLookup("flags.search.beta").isNull())
+      ++misses;
+  }
+  stop_measuring();
+
+  if(misses != n)
+    printf("mismatch\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_get_miss(unsigned int n)
+{
+  Config cfg;
+  unsigned int enabled = 0;
+
+  cfg.readString(flags_config);
+
+  start_measuring();
+  for(unsigned int i = 0; i < n; ++i)
+    enabled += cfg.get<bool>("flags.search.beta", false);
+  stop_measuring();
+
+  if(enabled != 0)
+    printf("mismatch\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static void bench_get_hit(unsigned int n)
+{
+  Config cfg;
+  unsigned int limit = 0;
+
+  cfg.readString(flags_config);
+
+  start_measuring();
+  for(unsigned int i = 0; i < n; ++i)
+    limit += cfg.get<int>("flags.search.limit", 0);
+  stop_measuring();
+
+  if(limit != n * 50)
+    printf("mismatch\n");
+}
+
+// ---------------------------------------------------------------------------
+
+static const struct benchmark benchmarks[] = {
+  { "iterate_setting", bench_iterate_setting, 10000, 1000000 },
+  { "iterate_setting_again", bench_iterate_setting_again, 10000, 1000000 },
+  { "iterate_view", bench_iterate_view, 10000, 1000000 },
+  { "lookup_miss_throw", bench_lookup_miss_throw, 10000, 1000000 },
+  { "lookup_miss_try", bench_lookup_miss_try, 10000, 1000000 },
+  { "get_miss", bench_get_miss, 10000, 1000000 },
+  { "get_hit", bench_get_hit, 10000, 1000000 },
+  { NULL, NULL, 0, 0 }
+};
+
+// ---------------------------------------------------------------------------
+
+static int selected(const char *name, int argc, char **argv)
+{
+  int i;
+
+  if(argc < 2)
+    return(1);
+
+  for(i = 1; i < argc; ++i)
+  {
+    if(! strcmp(argv[i], name))
+      return(1);
+  }
+
+  return(0);
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  const struct benchmark *b;
+
+  for(b = benchmarks; b->name; ++b)
+  {
+    unsigned int n;
+
+    if(! selected(b->name, argc, argv))
+      continue;
+
+    for(n = b->min_n; n <= b->max_n; n *= 10)
+    {
+      b->func(n);
+
+      printf("%-28s n=%-10u %10.3f ms %10.1f ns/elem %10lu news\n", b->name,
+             n, measured_secs * 1e3, measured_secs * 1e9 / n, measured_news);
+    }
+  }
+
+  return(EXIT_SUCCESS);
+}
@@ -20,8 +20,10 @@
    ----------------------------------------------------------------------------
 */
 
+#include <locale.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 
 #ifdef _MSC_VER
@@ -748,6 +750,2342 @@ TT_TEST(BinaryAndHex)
 
 /* ------------------------------------------------------------------------- */
 
+TT_TEST(LargeAggregates)
+{
+  config_t cfg;
+  config_setting_t *root, *list;
+  unsigned int i, capacity, reallocs = 0;
+  const unsigned int count = 1000000;
+  const size_t strsize = 10 * 1024 * 1024;
+  const char *str;
+  char *buf;
+
+  config_init(&cfg);
+  root = config_root_setting(&cfg);
+
+  /* Appending must grow the element vector geometrically. */
+  list = config_setting_add(root, "list", CONFIG_TYPE_LIST);
+  TT_ASSERT_PTR_NOTNULL(list);
+
+  capacity = 0;
+  for(i = 0; i < count; ++i)
+  {
+    TT_ASSERT_PTR_NOTNULL(config_setting_set_int_elem(list, -1, (int)i));
+    if(list->value.list->capacity != capacity)
+    {
+      capacity = list->value.list->capacity;
+      ++reallocs;
+    }
+  }
+
+  TT_ASSERT_INT_EQ(count, config_setting_length(list));
+  TT_ASSERT_INT_EQ(count - 1, config_setting_get_int_elem(list, count - 1));
+  TT_ASSERT_INT_LE(reallocs, 32);
+
+  /* Reserving up front must avoid reallocation altogether. */
+  list = config_setting_add(root, "array", CONFIG_TYPE_ARRAY);
+  TT_ASSERT_PTR_NOTNULL(list);
+  TT_ASSERT_TRUE(config_setting_reserve(list, count));
+  capacity = list->value.list->capacity;
+  TT_ASSERT_INT_EQ(count, capacity);
+
+  for(i = 0; i < count; ++i)
+    TT_ASSERT_PTR_NOTNULL(config_setting_set_int_elem(list, -1, (int)i));
+
+  TT_ASSERT_INT_EQ(capacity, list->value.list->capacity);
+  TT_ASSERT_FALSE(config_setting_reserve(
+                    config_setting_get_elem(list, 0), 10));
+
+  /* A very long string literal. */
+  buf = (char *)malloc(strsize + 8);
+  TT_ASSERT_PTR_NOTNULL(buf);
+  strcpy(buf, "s = \"");
+  memset(buf + 5, 'x', strsize);
+  strcpy(buf + 5 + strsize, "\";");
+
+  TT_ASSERT_TRUE(config_read_string(&cfg, buf));
+  free(buf);
+
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "s", &str));
+  TT_ASSERT_INT_EQ(strsize, strlen(str));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int same_str(const char *a, const char *b)
+{
+  return((a == b) || (a && b && !strcmp(a, b)));
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int same_settings(const config_setting_t *a, const config_setting_t *b)
+{
+  int i, n;
+
+  if((a->type != b->type) || (a->format != b->format)
+     || (a->line != b->line) || !same_str(a->name, b->name)
+     || !same_str(a->file, b->file))
+    return(0);
+
+  switch(a->type)
+  {
+    case CONFIG_TYPE_INT:
+    case CONFIG_TYPE_BOOL:
+      return(a->value.ival == b->value.ival);
+
+    case CONFIG_TYPE_INT64:
+      return(a->value.llval == b->value.llval);
+
+    case CONFIG_TYPE_FLOAT:
+      return(!memcmp(&(a->value.fval), &(b->value.fval), sizeof(double)));
+
+    case CONFIG_TYPE_STRING:
+      return(same_str(a->value.sval, b->value.sval));
+
+    case CONFIG_TYPE_GROUP:
+    case CONFIG_TYPE_ARRAY:
+    case CONFIG_TYPE_LIST:
+      n = config_setting_length(a);
+      if(n != config_setting_length(b))
+        return(0);
+
+      for(i = 0; i < n; ++i)
+      {
+        if(!same_settings(config_setting_get_elem(a, i),
+                          config_setting_get_elem(b, i)))
+          return(0);
+      }
+      return(1);
+
+    default:
+      return(1);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Parses the given file, stream or string with both the flex scanner and the
+ * hand-written scanner, and checks that the outcomes are identical.
+ */
+static void compare_scanners(const char *file, const char *str)
+{
+  config_t cfg[2];
+  int i, ok[2], same;
+
+  for(i = 0; i < 2; ++i)
+  {
+    config_init(&cfg[i]);
+    config_set_include_dir(&cfg[i], "./testdata");
+    config_set_option(&cfg[i], CONFIG_OPTION_FAST_SCANNER, i);
+
+    if(file && str) /* read as a stream */
+    {
+      FILE *stream = fopen(file, "rb");
+      TT_ASSERT_PTR_NOTNULL(stream);
+      ok[i] = config_read(&cfg[i], stream);
+      fclose(stream);
+    }
+    else if(file)
+      ok[i] = config_read_file(&cfg[i], file);
+    else
+      ok[i] = config_read_string(&cfg[i], str);
+  }
+
+  if(ok[0] != ok[1])
+    same = 0;
+  else if(ok[0])
+    same = same_settings(config_root_setting(&cfg[0]),
+                         config_root_setting(&cfg[1]));
+  else
+    same = (config_error_line(&cfg[0]) == config_error_line(&cfg[1]))
+      && (config_error_type(&cfg[0]) == config_error_type(&cfg[1]))
+      && same_str(config_error_text(&cfg[0]), config_error_text(&cfg[1]))
+      && same_str(config_error_file(&cfg[0]), config_error_file(&cfg[1]));
+
+  if(!same)
+  {
+    printf("scanner mismatch on %s: %d/%d %s:%d %s / %s:%d %s\n",
+           file ? file : str, ok[0], ok[1],
+           config_error_file(&cfg[0]), config_error_line(&cfg[0]),
+           config_error_text(&cfg[0]), config_error_file(&cfg[1]),
+           config_error_line(&cfg[1]), config_error_text(&cfg[1]));
+  }
+
+  config_destroy(&cfg[0]);
+  config_destroy(&cfg[1]);
+
+  TT_ASSERT_TRUE(same);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(FastScannerConformance)
+{
+  static const char *files[] = {
+    "testdata/bad_input_0.cfg", "testdata/bad_input_1.cfg",
+    "testdata/binhex.cfg", "testdata/input_0.cfg", "testdata/input_1.cfg",
+    "testdata/input_2.cfg", "testdata/input_3.cfg", "testdata/input_4.cfg",
+    "testdata/input_5.cfg", "testdata/input_6.cfg", "testdata/more.cfg",
+    "testdata/nesting.cfg", "testdata/override_setting.cfg",
+    "testdata/strings.cfg", "../fuzz/corpus/seed", NULL
+  };
+
+  static const char *strings[] = {
+    "a = 1;", "a = .;", "a = -.e5;", "a = 1e;", "a = 1e+;", "a = 1.5e-3L;",
+    "a = 0x;", "a = 0x1FFFFFFFFFFFFFFFF;", "a = 0b102;", "a = 0q777L;",
+    "a = 99999999999;", "a = 99999999999999999999;", "a = 12LLL;",
+    "a = TRUE; b = False; truex = 1;", "a = \"\\x4\";", "a = \"\\q\\",
+    "a = \"x\" \"y\"\n\"z\";", "/* a\n*/ b\n=\n// c\n2 # d\n;",
+    "a = 1; /* unterminated\n", "a = \"unterminated\n", "a = @;",
+    "@include \"more.cfg\"\nb = 2;", "  @include \"nope.cfg\"\n",
+    "x @include \"more.cfg\"\n", "@include \"more.cfg\"", "@include \"a\\",
+    "@include \"m\\o\\\\re.cfg\"", "a = [1, 2.0];", "a = (1, \"x\", {b = 1;});",
+    "a = \"\\x41\\X4a\\a\\b\\f\\n\\r\\t\\v\\\"\\\\\";", "a =\r\n\f\v 1;",
+    NULL
+  };
+
+  static const char mutations[] = "\"\\\n/*.e-x0@#L";
+
+  const char **f, **s;
+  char *text, *p;
+  size_t len, i;
+
+  for(f = files; *f; ++f)
+  {
+    compare_scanners(*f, NULL);
+    compare_scanners(*f, "");
+  }
+
+  for(s = strings; *s; ++s)
+    compare_scanners(NULL, *s);
+
+  /* Every prefix of each input, and single-character mutations of each. */
+  for(f = files; *f; ++f)
+  {
+    text = (char *)read_file_to_string(*f);
+    len = strlen(text);
+
+    for(i = 0; i <= len; ++i)
+    {
+      char saved = text[i];
+
+      text[i] = '\0';
+      compare_scanners(NULL, text);
+      text[i] = saved;
+    }
+
+    for(i = 0; i < len; ++i)
+    {
+      char saved = text[i];
+
+      for(p = (char *)mutations; *p; ++p)
+      {
+        /* An empty include path names the include directory itself, which
+         * the flex scanner fails on fatally.
+         */
+        if((*p == '"') && (i > 0) && (text[i - 1] == '"'))
+          continue;
+
+        text[i] = *p;
+        compare_scanners(NULL, text);
+      }
+
+      text[i] = saved;
+    }
+
+    free(text);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static unsigned long long next_random(unsigned long long *state)
+{
+  /* xorshift64 */
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return(*state);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void check_floats(const char *buf, char **literals,
+                         const double *expected, int count)
+{
+  config_t cfg;
+  config_setting_t *list;
+  double actual;
+  int i;
+
+  config_init(&cfg);
+  TT_ASSERT_TRUE(config_read_string(&cfg, buf));
+  list = config_lookup(&cfg, "a");
+  TT_ASSERT_PTR_NOTNULL(list);
+  TT_ASSERT_INT_EQ(count, config_setting_length(list));
+
+  for(i = 0; i < count; ++i)
+  {
+    actual = config_setting_get_float_elem(list, i);
+    if(memcmp(&actual, &expected[i], sizeof(double)))
+      printf("mismatch for %s: %.17g\n", literals[i], actual);
+    TT_ASSERT_TRUE(!memcmp(&actual, &expected[i], sizeof(double)));
+  }
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(NumberParsing)
+{
+  static const char *locales[] = {
+    "de_DE.UTF-8", "de_DE.utf8", "de_DE", "fr_FR.UTF-8", "fr_FR", NULL
+  };
+  static const struct
+  {
+    const char *text;
+    int ok;
+    int type;
+    long long value;
+  } integers[] = {
+    { "2147483647", 1, CONFIG_TYPE_INT, 2147483647LL },
+    { "-2147483648", 1, CONFIG_TYPE_INT, -2147483647LL - 1 },
+    { "2147483648", 1, CONFIG_TYPE_INT64, 2147483648LL },
+    { "9223372036854775807", 1, CONFIG_TYPE_INT64, 9223372036854775807LL },
+    { "-9223372036854775808", 1, CONFIG_TYPE_INT64,
+      -9223372036854775807LL - 1 },
+    { "9223372036854775808", 0, 0, 0 },
+    { "-9223372036854775809", 0, 0, 0 },
+    { "+17L", 1, CONFIG_TYPE_INT64, 17 },
+    { "0xFFFFFFFF", 1, CONFIG_TYPE_INT, -1 },
+    { "0x7FFFFFFFFFFFFFFF", 1, CONFIG_TYPE_INT64, 9223372036854775807LL },
+    { "0x8000000000000000", 0, 0, 0 },
+    { "0b11111111111111111111111111111111", 1, CONFIG_TYPE_INT, -1 },
+    { "0o17777777777", 1, CONFIG_TYPE_INT, 2147483647LL },
+    { "0o777777777777777777777", 1, CONFIG_TYPE_INT64,
+      9223372036854775807LL },
+    { "0b1000000000000000000000000000000000000000000000000000000000000000",
+      0, 0, 0 },
+    { NULL, 0, 0, 0 }
+  };
+  static const char *hard_floats[] = {
+    "9007199254740993.0", "9007199254740992.9999999", "2.2250738585072011e-308",
+    "1.7976931348623157e308", "4.9e-324", "1e-400", "1e400", "-0.0", "0.",
+    "123456789012345678901234567890.0", ".000000000000000000000000000001",
+    "7.0e-10", "1448997445238699.0", NULL
+  };
+  const int count = 20000;
+  unsigned long long state = 0x9E3779B97F4A7C15ULL;
+  config_t cfg;
+  char *buf, *p, *literal, **literals;
+  const char **loc;
+  double *expected;
+  int i, j;
+
+  /* Integers at the edges of their ranges. */
+  for(i = 0; integers[i].text; ++i)
+  {
+    char text[128];
+    config_setting_t *setting;
+
+    snprintf(text, sizeof(text), "a = %s;", integers[i].text);
+    config_init(&cfg);
+    TT_ASSERT_INT_EQ(integers[i].ok, config_read_string(&cfg, text));
+    if(integers[i].ok)
+    {
+      setting = config_lookup(&cfg, "a");
+      TT_ASSERT_PTR_NOTNULL(setting);
+      TT_ASSERT_INT_EQ(integers[i].type, config_setting_type(setting));
+      TT_ASSERT_INT64_EQ(integers[i].value, config_setting_get_int64(setting));
+    }
+    config_destroy(&cfg);
+  }
+
+  /* Random doubles in several notations, and random digit strings with wide
+   * ranging exponents, must convert exactly as strtod() does.
+   */
+  literals = (char **)malloc(count * sizeof(char *));
+  expected = (double *)malloc(count * sizeof(double));
+  buf = (char *)malloc((size_t)count * 48 + 16);
+  TT_ASSERT_PTR_NOTNULL(literals);
+  TT_ASSERT_PTR_NOTNULL(expected);
+  TT_ASSERT_PTR_NOTNULL(buf);
+
+  for(i = 0; i < count; ++i)
+  {
+    unsigned long long r = next_random(&state);
+    literal = (char *)malloc(40);
+    TT_ASSERT_PTR_NOTNULL(literal);
+
+    if(i < (int)(sizeof(hard_floats) / sizeof(hard_floats[0])) - 1)
+      strcpy(literal, hard_floats[i]);
+    else if(i % 4 == 3)
+    {
+      int ndigits = 1 + (int)(r % 25);
+
+      p = literal;
+      if(r & 0x100)
+        *p++ = '-';
+      for(j = 0; j < ndigits; ++j)
+      {
+        *p++ = (char)('0' + next_random(&state) % 10);
+        if(j == ndigits / 2)
+          *p++ = '.';
+      }
+      sprintf(p, "e%d", (int)(next_random(&state) % 680) - 350);
+    }
+    else
+    {
+      double d;
+
+      do
+      {
+        r = next_random(&state);
+        memcpy(&d, &r, sizeof(d));
+      }
+      while(d != d || d - d != 0.0);  /* skip NaN and infinity */
+
+      sprintf(literal, (i % 4 == 0) ? "%.17g" : (i % 4 == 1) ? "%.15g"
+              : "%.6e", d);
+      if(!strpbrk(literal, ".e"))
+        strcat(literal, ".");
+    }
+
+    literals[i] = literal;
+  }
+
+  p = buf + sprintf(buf, "a = (");
+  for(i = 0; i < count; ++i)
+  {
+    p += sprintf(p, "%s%s", i ? "," : "", literals[i]);
+    expected[i] = strtod(literals[i], NULL);
+  }
+  strcpy(p, ");");
+
+  check_floats(buf, literals, expected, count);
+
+  /* Repeat in a locale that uses a decimal comma, if one is installed. */
+  for(loc = locales; *loc; ++loc)
+  {
+    if(setlocale(LC_NUMERIC, *loc))
+    {
+      check_floats(buf, literals, expected, count);
+      setlocale(LC_NUMERIC, "C");
+      break;
+    }
+  }
+
+  for(i = 0; i < count; ++i)
+    free(literals[i]);
+  free(literals);
+  free(expected);
+  free(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(RoundTripFloats)
+{
+  static const struct
+  {
+    double value;
+    const char *text;
+  } cases[] = {
+    { 0.1, "0.1" },
+    { 0.1 + 0.2, "0.30000000000000004" },
+    { 100.0, "100.0" },
+    { -2.5, "-2.5" },
+    { -0.0, "-0.0" },
+    { 1e23, "1e+23" },
+    { 1e-5, "1e-05" },
+    { 0.001, "0.001" },
+    { 5e-324, "5e-324" },
+    { 1.7976931348623157e308, "1.7976931348623157e+308" },
+    { 0.0, NULL }
+  };
+  const int count = 10000;
+  unsigned long long state;
+  config_t cfg;
+  config_setting_t *root, *list;
+  double value, actual;
+  char text[64];
+  const char *str;
+  int i, sci;
+
+  for(i = 0; cases[i].text; ++i)
+  {
+    config_init(&cfg);
+    config_set_option(&cfg, CONFIG_OPTION_ROUND_TRIP_FLOATS, 1);
+    config_set_option(&cfg, CONFIG_OPTION_ALLOW_SCIENTIFIC_NOTATION, 1);
+    config_setting_set_float(
+      config_setting_add(config_root_setting(&cfg), "a", CONFIG_TYPE_FLOAT),
+      cases[i].value);
+
+    remove("temp.cfg");
+    TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+    str = read_file_to_string("temp.cfg");
+    snprintf(text, sizeof(text), "a = %s;\n", cases[i].text);
+    TT_ASSERT_STR_EQ(text, str);
+    free((void *)str);
+    remove("temp.cfg");
+
+    config_destroy(&cfg);
+  }
+
+  /* Random doubles must be read back bit for bit, with and without
+   * scientific notation.
+   */
+  for(sci = 0; sci < 2; ++sci)
+  {
+    state = 0x2545F4914F6CDD1DULL;
+
+    config_init(&cfg);
+    config_set_option(&cfg, CONFIG_OPTION_ROUND_TRIP_FLOATS, 1);
+    config_set_option(&cfg, CONFIG_OPTION_ALLOW_SCIENTIFIC_NOTATION, sci);
+    root = config_root_setting(&cfg);
+    list = config_setting_add(root, "a", CONFIG_TYPE_ARRAY);
+
+    for(i = 0; i < count; ++i)
+    {
+      unsigned long long r = next_random(&state);
+
+      if(i % 2)
+        value = (double)(long long)(r % 2000000) / 1000.0;
+      else
+        memcpy(&value, &r, sizeof(value));
+
+      if((value != value) || (value - value != 0.0))
+        value = (double)i;  /* NaN or infinity */
+
+      TT_ASSERT_PTR_NOTNULL(config_setting_set_float_elem(list, -1, value));
+    }
+
+    remove("temp.cfg");
+    TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+
+    TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+    remove("temp.cfg");
+
+    list = config_lookup(&cfg, "a");
+    TT_ASSERT_PTR_NOTNULL(list);
+    TT_ASSERT_INT_EQ(count, config_setting_length(list));
+
+    state = 0x2545F4914F6CDD1DULL;
+    for(i = 0; i < count; ++i)
+    {
+      unsigned long long r = next_random(&state);
+
+      if(i % 2)
+        value = (double)(long long)(r % 2000000) / 1000.0;
+      else
+        memcpy(&value, &r, sizeof(value));
+
+      if((value != value) || (value - value != 0.0))
+        value = (double)i;
+
+      actual = config_setting_get_float_elem(list, i);
+      TT_ASSERT_TRUE(!memcmp(&value, &actual, sizeof(double)));
+    }
+
+    config_destroy(&cfg);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(Stats)
+{
+  static const char *input =
+    "a = 1;\n"
+    "b = [1.0, 2.0];\n"
+    "s = \"hello\";\n"
+    "@include \"more.cfg\"\n"
+    "g = { l = (true, 5L); };\n";
+  config_t cfg;
+  config_stats_t stats;
+  const char *more;
+  size_t more_len;
+  int fast;
+  FILE *fp;
+
+  more = read_file_to_string("./testdata/more.cfg");
+  TT_ASSERT_PTR_NOTNULL(more);
+  more_len = strlen(more);
+  free((void *)more);
+
+  for(fast = 0; fast < 2; ++fast)
+  {
+    config_init(&cfg);
+    config_set_include_dir(&cfg, "./testdata");
+    config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, fast);
+
+    TT_ASSERT_TRUE(config_read_string(&cfg, input));
+    config_get_stats(&cfg, &stats);
+
+    TT_ASSERT_INT_EQ(strlen(input) + more_len, stats.bytes_scanned);
+    TT_ASSERT_INT_EQ(33, stats.tokens);
+    TT_ASSERT_INT_EQ(0, stats.settings[CONFIG_TYPE_NONE]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_GROUP]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_INT]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_INT64]);
+    TT_ASSERT_INT_EQ(2, stats.settings[CONFIG_TYPE_FLOAT]);
+    TT_ASSERT_INT_EQ(2, stats.settings[CONFIG_TYPE_STRING]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_BOOL]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_ARRAY]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_LIST]);
+    TT_ASSERT_INT_EQ(1, stats.files_included);
+    TT_ASSERT_INT_EQ(strlen("Hello, world!"), stats.peak_string_size);
+    TT_ASSERT_TRUE(stats.allocations > 0);
+    TT_ASSERT_TRUE(stats.read_ns > 0);
+    TT_ASSERT_TRUE(stats.include_ns <= stats.read_ns);
+
+    /* The scan/parse split is only measured on request. */
+    TT_ASSERT_TRUE(stats.scan_ns == 0);
+    TT_ASSERT_TRUE(stats.parse_ns == 0);
+
+    config_set_option(&cfg, CONFIG_OPTION_PHASE_TIMING, 1);
+    TT_ASSERT_TRUE(config_read_string(&cfg, input));
+    config_get_stats(&cfg, &stats);
+    TT_ASSERT_TRUE(stats.scan_ns + stats.parse_ns + stats.include_ns
+                   == stats.read_ns);
+
+    /* A failed read still reports what was scanned up to the error. */
+    TT_ASSERT_FALSE(config_read_string(&cfg, "a = 1;\nb = ;\n"));
+    config_get_stats(&cfg, &stats);
+    TT_ASSERT_INT_EQ(7, stats.tokens);
+    TT_ASSERT_INT_EQ(0, stats.files_included);
+
+    fp = tmpfile();
+    TT_ASSERT_PTR_NOTNULL(fp);
+    config_write(&cfg, fp);
+    fclose(fp);
+    config_get_stats(&cfg, &stats);
+    TT_ASSERT_TRUE(stats.write_ns > 0);
+
+    /* Settings that are overridden aren't counted. */
+    config_set_option(&cfg, CONFIG_OPTION_ALLOW_OVERRIDES, 1);
+    TT_ASSERT_TRUE(config_read_string(&cfg, "a = 1;\na = { b = 2; };\n"));
+    config_get_stats(&cfg, &stats);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_GROUP]);
+    TT_ASSERT_INT_EQ(1, stats.settings[CONFIG_TYPE_INT]);
+
+    config_destroy(&cfg);
+  }
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *make_wide_group(unsigned int n, const char *tail)
+{
+  char *buf, *p;
+  unsigned int i;
+
+  buf = (char *)malloc((size_t)n * 24 + strlen(tail) + 16);
+  p = buf + sprintf(buf, "g = {\n");
+  for(i = 0; i < n; ++i)
+    p += sprintf(p, "k%u = %u;\n", i, i);
+  strcpy(p, tail);
+
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(WideGroups)
+{
+  const unsigned int n = 200000;
+  config_t cfg;
+  config_setting_t *group;
+  char *buf;
+  int ival;
+
+  /* Member names only have to be unique within their own group. */
+  buf = make_wide_group(n, "h = { k0 = -1; k1 = { k0 = -2; }; };\n};\n"
+                        "k0 = -3;\n");
+  config_init(&cfg);
+  TT_ASSERT_TRUE(config_read_string(&cfg, buf));
+  free(buf);
+
+  group = config_lookup(&cfg, "g");
+  TT_ASSERT_PTR_NOTNULL(group);
+  TT_ASSERT_INT_EQ(n + 1, config_setting_length(group));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.k0", &ival));
+  TT_ASSERT_INT_EQ(0, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.k199999", &ival));
+  TT_ASSERT_INT_EQ(199999, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.h.k0", &ival));
+  TT_ASSERT_INT_EQ(-1, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.h.k1.k0", &ival));
+  TT_ASSERT_INT_EQ(-2, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "k0", &ival));
+  TT_ASSERT_INT_EQ(-3, ival);
+
+  /* A duplicate at the end of a wide group is still detected. */
+  buf = make_wide_group(n, "k12345 = 0;\n};\n");
+  TT_ASSERT_FALSE(config_read_string(&cfg, buf));
+  TT_ASSERT_STR_EQ("duplicate setting name", config_error_text(&cfg));
+  TT_ASSERT_INT_EQ(n + 2, config_error_line(&cfg));
+
+  /* With overrides, the last definition wins and moves to the end. */
+  config_set_option(&cfg, CONFIG_OPTION_ALLOW_OVERRIDES, 1);
+  TT_ASSERT_TRUE(config_read_string(&cfg, buf));
+  free(buf);
+
+  group = config_lookup(&cfg, "g");
+  TT_ASSERT_PTR_NOTNULL(group);
+  TT_ASSERT_INT_EQ(n, config_setting_length(group));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.k12345", &ival));
+  TT_ASSERT_INT_EQ(0, ival);
+  TT_ASSERT_STR_EQ("k12345",
+                   config_setting_name(config_setting_get_elem(group, n - 1)));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(ReadBuffer)
+{
+  static const char *files[] = {
+    "testdata/input_0.cfg", "testdata/input_3.cfg", "testdata/strings.cfg",
+    "testdata/binhex.cfg", NULL
+  };
+  static const char *text = "a = 123; b = 4;";
+  static const char *bad = "a = 1;\nb = ;\nc = 2;\n";
+  config_t cfg, expected;
+  const char **file;
+  const char *str;
+  char *buf;
+  size_t len, consumed;
+  int ival;
+
+  config_init(&cfg);
+  config_init(&expected);
+  config_set_include_dir(&cfg, "./testdata");
+  config_set_include_dir(&expected, "./testdata");
+
+  /* The buffer is not NUL-terminated; only its first len bytes are read. */
+  for(file = files; *file; ++file)
+  {
+    str = read_file_to_string(*file);
+    TT_ASSERT_PTR_NOTNULL(str);
+    len = strlen(str);
+    buf = (char *)malloc(len);
+    memcpy(buf, str, len);
+
+    TT_ASSERT_TRUE(config_read_string(&expected, str));
+    TT_ASSERT_TRUE(config_read_buffer(&cfg, buf, len, &consumed));
+    TT_ASSERT_INT_EQ(len, consumed);
+    TT_ASSERT_TRUE(same_settings(config_root_setting(&expected),
+                                 config_root_setting(&cfg)));
+
+    free(buf);
+    free((void *)str);
+  }
+
+  TT_ASSERT_TRUE(config_read_buffer(&cfg, text, 7, &consumed));
+  TT_ASSERT_INT_EQ(7, consumed);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "a", &ival));
+  TT_ASSERT_INT_EQ(123, ival);
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "b"));
+
+  /* Input ends at the first NUL byte, as with config_read_string(). */
+  TT_ASSERT_TRUE(config_read_buffer(&cfg, "b = 4;\0\0\0garbage", 17,
+                                    &consumed));
+  TT_ASSERT_INT_EQ(6, consumed);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "b", &ival));
+  TT_ASSERT_INT_EQ(4, ival);
+
+  TT_ASSERT_TRUE(config_read_buffer(&cfg, NULL, 0, &consumed));
+  TT_ASSERT_INT_EQ(0, consumed);
+  TT_ASSERT_INT_EQ(0, config_setting_length(config_root_setting(&cfg)));
+
+  /* Included files don't count towards the bytes consumed. */
+  str = "@include \"more.cfg\"\nx = 1;";
+  TT_ASSERT_TRUE(config_read_buffer(&cfg, str, strlen(str), NULL));
+  TT_ASSERT_TRUE(config_read_buffer(&cfg, str, strlen(str), &consumed));
+  TT_ASSERT_INT_EQ(strlen(str), consumed);
+  TT_ASSERT_PTR_NOTNULL(config_lookup(&cfg, "message"));
+
+  /* On a parse error, scanning stops just after the offending token. */
+  TT_ASSERT_FALSE(config_read_buffer(&cfg, bad, strlen(bad), &consumed));
+  TT_ASSERT_INT_EQ(2, config_error_line(&cfg));
+  TT_ASSERT_INT_EQ(strchr(bad, 'b') - bad + 5, consumed);
+
+  config_destroy(&expected);
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Parses the string by feeding it to a push parser in chunks of the given
+ * size, and checks that the outcome is the same as reading it in one go.
+ */
+static void compare_push(const char *str, size_t chunk)
+{
+  config_t cfg[2];
+  config_parser_t *parser;
+  size_t len = strlen(str), i, n;
+  int ok[2], fed = CONFIG_TRUE, same;
+
+  for(i = 0; i < 2; ++i)
+  {
+    config_init(&cfg[i]);
+    config_set_include_dir(&cfg[i], "./testdata");
+    config_set_option(&cfg[i], CONFIG_OPTION_FAST_SCANNER, 1);
+  }
+
+  ok[0] = config_read_string(&cfg[0], str);
+
+  parser = config_parser_new(&cfg[1]);
+  for(i = 0; i < len; i += n)
+  {
+    n = (len - i < chunk) ? len - i : chunk;
+    if(! config_parser_feed(parser, str + i, n))
+      fed = CONFIG_FALSE;
+  }
+  ok[1] = config_parser_finish(parser);
+  config_parser_destroy(parser);
+
+  /* Once a feed has failed, so does the rest of the parse. */
+  if(! fed)
+    TT_ASSERT_FALSE(ok[1]);
+
+  if(ok[0] != ok[1])
+    same = 0;
+  else if(ok[0])
+    same = same_settings(config_root_setting(&cfg[0]),
+                         config_root_setting(&cfg[1]));
+  else
+    same = (config_error_line(&cfg[0]) == config_error_line(&cfg[1]))
+      && (config_error_type(&cfg[0]) == config_error_type(&cfg[1]))
+      && same_str(config_error_text(&cfg[0]), config_error_text(&cfg[1]))
+      && same_str(config_error_file(&cfg[0]), config_error_file(&cfg[1]));
+
+  if(!same)
+  {
+    printf("push parser mismatch on %s in chunks of %u: %d/%d %d %s / %d %s\n",
+           str, (unsigned int)chunk, ok[0], ok[1], config_error_line(&cfg[0]),
+           config_error_text(&cfg[0]), config_error_line(&cfg[1]),
+           config_error_text(&cfg[1]));
+  }
+
+  config_destroy(&cfg[0]);
+  config_destroy(&cfg[1]);
+
+  TT_ASSERT_TRUE(same);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(PushParser)
+{
+  static const char *files[] = {
+    "testdata/bad_input_0.cfg", "testdata/bad_input_1.cfg",
+    "testdata/binhex.cfg", "testdata/input_0.cfg", "testdata/input_1.cfg",
+    "testdata/input_2.cfg", "testdata/input_3.cfg", "testdata/input_4.cfg",
+    "testdata/input_5.cfg", "testdata/input_6.cfg", "testdata/more.cfg",
+    "testdata/nesting.cfg", "testdata/override_setting.cfg",
+    "testdata/strings.cfg", NULL
+  };
+
+  static const char *strings[] = {
+    "a = 1;", "a = 1e+5;", "a = 1e+x;", "a = 99999999999999999999.5;",
+    "a = 12L; b = 0x1FL; c = true; d = falsey;", "a = 1; /* x */ // y\n",
+    "a = \"x\" \"y\"\n\"z\";", "@include \"more.cfg\"\nb = 2;",
+    "  @include \"more.cfg\"\n  @includex\n", "@include \"nope.cfg\"\n",
+    "a = 1;\n@include \"more.cfg\"", "a = 1;\nb = ;\nc = 2;\n",
+    "a = 1; /* unterminated\n", "a = \"unterminated\n", NULL
+  };
+
+  static const size_t chunks[] = { 1, 2, 3, 5, 64, 100000, 0 };
+
+  const char **f, **s;
+  const size_t *chunk;
+  config_t cfg;
+  config_parser_t *parser;
+  char *text;
+  size_t len, i;
+  int ival;
+
+  for(f = files; *f; ++f)
+  {
+    text = (char *)read_file_to_string(*f);
+    TT_ASSERT_PTR_NOTNULL(text);
+    len = strlen(text);
+
+    for(chunk = chunks; *chunk; ++chunk)
+      compare_push(text, *chunk);
+
+    /* Every prefix, which stops the input at every possible point. */
+    for(i = 0; i <= len; ++i)
+    {
+      char saved = text[i];
+
+      text[i] = '\0';
+      compare_push(text, 1);
+      compare_push(text, 7);
+      text[i] = saved;
+    }
+
+    free(text);
+  }
+
+  for(s = strings; *s; ++s)
+  {
+    for(chunk = chunks; *chunk; ++chunk)
+      compare_push(*s, *chunk);
+  }
+
+  /* A parse error is reported as soon as the offending token is complete. */
+  config_init(&cfg);
+  parser = config_parser_new(&cfg);
+  TT_ASSERT_TRUE(config_parser_feed(parser, "a = 1;\nb = ", 11));
+  TT_ASSERT_FALSE(config_parser_feed(parser, ";\n  c = 2", 9));
+  TT_ASSERT_INT_EQ(2, config_error_line(&cfg));
+  TT_ASSERT_INT_EQ(CONFIG_ERR_PARSE, config_error_type(&cfg));
+  TT_ASSERT_FALSE(config_parser_feed(parser, ";", 1));
+  TT_ASSERT_FALSE(config_parser_finish(parser));
+  config_parser_destroy(parser);
+
+  /* Input ends at the first NUL byte. */
+  parser = config_parser_new(&cfg);
+  TT_ASSERT_TRUE(config_parser_feed(parser, "a = 12", 6));
+  TT_ASSERT_FALSE(config_lookup_int(&cfg, "a", &ival));
+  TT_ASSERT_TRUE(config_parser_feed(parser, "3;\0garbage", 10));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "a", &ival));
+  TT_ASSERT_INT_EQ(123, ival);
+  TT_ASSERT_TRUE(config_parser_feed(parser, "garbage", 7));
+  TT_ASSERT_TRUE(config_parser_finish(parser));
+  config_parser_destroy(parser);
+
+  /* An abandoned parse leaves what had been read. */
+  parser = config_parser_new(&cfg);
+  TT_ASSERT_TRUE(config_parser_feed(parser, "a = 1; b = {c = ", 16));
+  config_parser_destroy(parser);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "a", &ival));
+  TT_ASSERT_INT_EQ(1, ival);
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct counting_io
+{
+  config_io_t io;
+  const config_io_t *base;
+  int opens;
+  int stats;
+  int fail_reads;
+};
+
+static void *counting_open(void *ctx, const char *path)
+{
+  struct counting_io *cio = (struct counting_io *)ctx;
+
+  ++(cio->opens);
+  return(cio->base->open(cio->base->ctx, path));
+}
+
+static size_t counting_read(void *ctx, void *file, char *buf, size_t len)
+{
+  struct counting_io *cio = (struct counting_io *)ctx;
+  size_t n = cio->base->read(cio->base->ctx, file, buf, len);
+
+  return(cio->fail_reads ? CONFIG_IO_ERROR : n);
+}
+
+static void counting_close(void *ctx, void *file)
+{
+  struct counting_io *cio = (struct counting_io *)ctx;
+
+  cio->base->close(cio->base->ctx, file);
+}
+
+static int counting_stat(void *ctx, const char *path, config_io_stat_t *st)
+{
+  struct counting_io *cio = (struct counting_io *)ctx;
+
+  ++(cio->stats);
+  return(cio->base->stat(cio->base->ctx, path, st));
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(IOProvider)
+{
+  /* The files, packed into one blob. */
+  static const char blob[] =
+    "a = 1;\n@include \"sub.cfg\"\nb = 2;\n"
+    "c = 3;\n@include \"sub2.cfg\"\n"
+    "d = 4;\ne = ;\n";
+  static const size_t main_len = 33, sub_len = 27, sub2_len = 7;
+  config_t cfg;
+  config_bundle_t *bundle;
+  struct counting_io cio;
+  int i, ival;
+
+  bundle = config_bundle_new();
+  TT_ASSERT_TRUE(config_bundle_add(bundle, "main.cfg", blob, main_len));
+  TT_ASSERT_TRUE(config_bundle_add(bundle, "conf/sub.cfg", blob + main_len,
+                                   sub_len));
+  TT_ASSERT_TRUE(config_bundle_add(bundle, "conf/sub2.cfg",
+                                   blob + main_len + sub_len, sub2_len));
+
+  /* Includes are served from the bundle, with either scanner. */
+  for(i = 0; i < 2; ++i)
+  {
+    config_init(&cfg);
+    config_set_option(&cfg, CONFIG_OPTION_FAST_SCANNER, i);
+    config_set_include_dir(&cfg, "conf");
+    TT_ASSERT_PTR_NOTNULL(config_get_io(&cfg));
+    config_set_io(&cfg, config_bundle_io(bundle));
+    TT_ASSERT_PTR_EQ(config_bundle_io(bundle), config_get_io(&cfg));
+
+    TT_ASSERT_TRUE(config_read_file(&cfg, "main.cfg"));
+    TT_ASSERT_TRUE(config_lookup_int(&cfg, "a", &ival));
+    TT_ASSERT_INT_EQ(1, ival);
+    TT_ASSERT_TRUE(config_lookup_int(&cfg, "b", &ival));
+    TT_ASSERT_INT_EQ(2, ival);
+    TT_ASSERT_TRUE(config_lookup_int(&cfg, "c", &ival));
+    TT_ASSERT_INT_EQ(3, ival);
+    TT_ASSERT_TRUE(config_lookup_int(&cfg, "d", &ival));
+    TT_ASSERT_INT_EQ(4, ival);
+    TT_ASSERT_STR_EQ("conf/sub2.cfg", config_setting_source_file(
+                       config_lookup(&cfg, "d")));
+
+    /* Errors in included files are reported against them. */
+    TT_ASSERT_TRUE(config_bundle_add(bundle, "conf/sub2.cfg",
+                                     blob + main_len + sub_len,
+                                     sub2_len + 6));
+    TT_ASSERT_FALSE(config_read_file(&cfg, "main.cfg"));
+    TT_ASSERT_STR_EQ("conf/sub2.cfg", config_error_file(&cfg));
+    TT_ASSERT_INT_EQ(2, config_error_line(&cfg));
+    TT_ASSERT_INT_EQ(CONFIG_ERR_PARSE, config_error_type(&cfg));
+    TT_ASSERT_TRUE(config_bundle_add(bundle, "conf/sub2.cfg",
+                                     blob + main_len + sub_len, sub2_len));
+
+    TT_ASSERT_FALSE(config_read_file(&cfg, "missing.cfg"));
+    TT_ASSERT_INT_EQ(CONFIG_ERR_FILE_IO, config_error_type(&cfg));
+
+    TT_ASSERT_FALSE(config_read_string(&cfg, "@include \"missing.cfg\"\n"));
+    TT_ASSERT_STR_EQ("cannot open include file", config_error_text(&cfg));
+
+    /* Strings don't go through the provider, except for their includes. */
+    TT_ASSERT_TRUE(config_read_string(&cfg, "@include \"sub.cfg\"\n"));
+    TT_ASSERT_TRUE(config_lookup_int(&cfg, "d", &ival));
+
+    config_set_io(&cfg, NULL);
+    TT_ASSERT_FALSE(config_read_file(&cfg, "main.cfg"));
+    config_destroy(&cfg);
+  }
+
+  config_bundle_destroy(bundle);
+
+  /* A provider can wrap the default one; each file is opened once. */
+  config_init(&cfg);
+  memset(&cio, 0, sizeof(cio));
+  cio.base = config_get_io(&cfg);
+  cio.io.open = counting_open;
+  cio.io.read = counting_read;
+  cio.io.close = counting_close;
+  cio.io.stat = counting_stat;
+  cio.io.ctx = &cio;
+  config_set_io(&cfg, &cio.io);
+  config_set_include_dir(&cfg, "./testdata");
+
+  TT_ASSERT_TRUE(config_read_file(&cfg, "testdata/input_5.cfg"));
+  TT_ASSERT_INT_EQ(2, cio.opens);
+  TT_ASSERT_INT_EQ(2, cio.stats);
+
+  /* Directories can't be read. */
+  TT_ASSERT_FALSE(config_read_file(&cfg, "testdata"));
+  TT_ASSERT_INT_EQ(CONFIG_ERR_FILE_IO, config_error_type(&cfg));
+  TT_ASSERT_INT_EQ(2, cio.opens);
+
+  /* Nor can files whose reads fail, even after some data was read. */
+  cio.fail_reads = 1;
+  TT_ASSERT_FALSE(config_read_file(&cfg, "testdata/input_5.cfg"));
+  TT_ASSERT_INT_EQ(CONFIG_ERR_FILE_IO, config_error_type(&cfg));
+  TT_ASSERT_FALSE(config_read_string(&cfg, "@include \"more.cfg\"\n"));
+  TT_ASSERT_STR_EQ("cannot open include file", config_error_text(&cfg));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Reads the string and returns the names of the root's members, separated by
+ * spaces, or the error text.
+ */
+static const char *read_member_names(config_t *cfg, const char *str)
+{
+  static char names[256];
+  config_setting_t *root;
+  int i;
+
+  if(! config_read_string(cfg, str))
+    return(config_error_text(cfg));
+
+  root = config_root_setting(cfg);
+  names[0] = '\0';
+  for(i = 0; i < config_setting_length(root); ++i)
+  {
+    if(i > 0)
+      strcat(names, " ");
+    strcat(names, config_setting_name(config_setting_get_elem(root, i)));
+  }
+
+  return(names);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(GlobIncludes)
+{
+  config_t cfg;
+  FILE *fp;
+  int cached;
+
+  config_init(&cfg);
+  config_set_include_dir(&cfg, "./testdata");
+
+  /* Off by default, so that paths are taken literally. */
+  TT_ASSERT_STR_EQ("cannot open include file",
+                   read_member_names(&cfg, "@include \"conf.d/*.cfg\"\n"));
+
+  config_set_option(&cfg, CONFIG_OPTION_GLOB_INCLUDES, CONFIG_TRUE);
+
+  for(cached = 0; cached < 2; ++cached)
+  {
+    config_set_option(&cfg, CONFIG_OPTION_CACHE_INCLUDE_LISTINGS, cached);
+
+    /* Regular files only, in sorted order, skipping hidden ones. */
+    TT_ASSERT_STR_EQ("a b",
+                     read_member_names(&cfg, "@include \"conf.d/*.cfg\"\n"));
+    TT_ASSERT_STR_EQ("a b readme",
+                     read_member_names(&cfg, "@include \"conf.d/\"\n"));
+    TT_ASSERT_STR_EQ("b", read_member_names(&cfg,
+                                            "@include \"conf.d/?0-*\"\n"));
+    TT_ASSERT_STR_EQ("a readme", read_member_names(
+                       &cfg, "@include \"conf.d/[!1]*[gt]\"\n"));
+    TT_ASSERT_STR_EQ("a b", read_member_names(
+                       &cfg, "@include \"conf.d/[0-9][0-9]-[a-b].cfg\"\n"));
+    TT_ASSERT_STR_EQ("hidden", read_member_names(
+                       &cfg, "@include \"conf.d/.*\"\n"));
+    TT_ASSERT_STR_EQ("inner", read_member_names(
+                       &cfg, "@include \"conf.d/sub.cfg/*\"\n"));
+    TT_ASSERT_STR_EQ("inner", read_member_names(
+                       &cfg, "@include \"conf.d/sub.cfg/inner.cfg\"\n"));
+
+    /* A pattern that matches nothing includes nothing. */
+    TT_ASSERT_STR_EQ("x", read_member_names(
+                       &cfg, "@include \"conf.d/*.none\"\nx = 1;\n"));
+    TT_ASSERT_STR_EQ("x", read_member_names(
+                       &cfg, "@include \"missing.d/*.cfg\"\nx = 1;\n"));
+
+    /* Changes to the directory are seen by the next read. */
+    fp = fopen("testdata/conf.d/50-new.cfg", "w");
+    TT_ASSERT_PTR_NOTNULL(fp);
+    fputs("new = 1;\n", fp);
+    fclose(fp);
+    TT_ASSERT_STR_EQ("a b new",
+                     read_member_names(&cfg, "@include \"conf.d/*.cfg\"\n"));
+    remove("testdata/conf.d/50-new.cfg");
+    TT_ASSERT_STR_EQ("a b",
+                     read_member_names(&cfg, "@include \"conf.d/*.cfg\"\n"));
+  }
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+/* Generates a config of n top-level settings, large enough to be split into
+ * several chunks, with strings and comments that contain separators, quotes
+ * and brackets. If 'bad' is not negative, setting number 'bad' is invalid.
+ */
+static char *make_parallel_input(int n, int bad, const char *tail)
+{
+  char *buf = (char *)malloc((size_t)n * 80 + strlen(tail) + 1), *p = buf;
+  int i;
+
+  for(i = 0; i < n; ++i)
+  {
+    if(i == bad)
+    {
+      p += sprintf(p, "bad%d = ;\n", i);
+      continue;
+    }
+
+    switch(i % 6)
+    {
+      case 0:
+        p += sprintf(p, "s%d = \"a;b\\\"c{\" \"d}, \\\\\";\n", i);
+        break;
+      case 1:
+        p += sprintf(p, "g%d = { x = [1, 2]; y = (\"z;\", { w = %d; }); }\n",
+                     i, i);
+        break;
+      case 2:
+        p += sprintf(p, "# comment; \"{\ni%d = %d,\n", i, i);
+        break;
+      case 3:
+        p += sprintf(p, "/* multi;\n line \" } */ f%d = 1.5e3;\n", i);
+        break;
+      case 4:
+        p += sprintf(p, "// c;\nl%d = %dL; ", i, i);
+        break;
+      default:
+        p += sprintf(p, "m%d = \"multi\nline; (string\";\n", i);
+        break;
+    }
+  }
+
+  strcpy(p, tail);
+  return(buf);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void compare_parallel(const char *str, int overrides)
+{
+  config_t cfg[2];
+  config_stats_t stats[2];
+  int ok[2], same, i;
+
+  for(i = 0; i < 2; ++i)
+  {
+    config_init(&cfg[i]);
+    config_set_include_dir(&cfg[i], "./testdata");
+    config_set_option(&cfg[i], CONFIG_OPTION_ALLOW_OVERRIDES, overrides);
+    config_set_option(&cfg[i], CONFIG_OPTION_PARALLEL_PARSE, i);
+    config_set_parse_threads(&cfg[i], 4);
+    ok[i] = config_read_string(&cfg[i], str);
+    config_get_stats(&cfg[i], &stats[i]);
+  }
+
+  if(ok[0] != ok[1])
+    same = 0;
+  else if(ok[0])
+    same = same_settings(config_root_setting(&cfg[0]),
+                         config_root_setting(&cfg[1]))
+      && (stats[0].tokens == stats[1].tokens)
+      && (stats[0].bytes_scanned == stats[1].bytes_scanned)
+      && !memcmp(stats[0].settings, stats[1].settings,
+                 sizeof(stats[0].settings));
+  else
+    same = (config_error_line(&cfg[0]) == config_error_line(&cfg[1]))
+      && (config_error_type(&cfg[0]) == config_error_type(&cfg[1]))
+      && same_str(config_error_text(&cfg[0]), config_error_text(&cfg[1]));
+
+  config_destroy(&cfg[0]);
+  config_destroy(&cfg[1]);
+
+  TT_ASSERT_TRUE(same);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(ParallelParse)
+{
+  static const int n = 40000;
+  config_t cfg;
+  char *text;
+  int ival;
+
+  text = make_parallel_input(n, -1, "");
+  TT_ASSERT_TRUE(strlen(text) > 1024 * 1024);
+  compare_parallel(text, CONFIG_FALSE);
+
+  /* Line numbers continue across chunks. */
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_PARALLEL_PARSE, CONFIG_TRUE);
+  config_set_parse_threads(&cfg, 4);
+  TT_ASSERT_TRUE(config_read_string(&cfg, text));
+  TT_ASSERT_INT_EQ(n, config_setting_length(config_root_setting(&cfg)));
+  TT_ASSERT_INT_EQ(60000, config_setting_source_line(
+                     config_lookup(&cfg, "f39999")));
+  config_destroy(&cfg);
+  free(text);
+
+  /* A setting in the last chunk that duplicates one in the first. */
+  text = make_parallel_input(n, -1, "s0 = 5; i2 = 7;\n");
+  compare_parallel(text, CONFIG_FALSE);
+  compare_parallel(text, CONFIG_TRUE);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_PARALLEL_PARSE, CONFIG_TRUE);
+  config_set_option(&cfg, CONFIG_OPTION_ALLOW_OVERRIDES, CONFIG_TRUE);
+  config_set_parse_threads(&cfg, 4);
+  TT_ASSERT_TRUE(config_read_string(&cfg, text));
+  TT_ASSERT_INT_EQ(n, config_setting_length(config_root_setting(&cfg)));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "i2", &ival));
+  TT_ASSERT_INT_EQ(7, ival);
+  TT_ASSERT_STR_EQ("i2", config_setting_name(
+                     config_setting_get_elem(config_root_setting(&cfg),
+                                             n - 1)));
+  config_destroy(&cfg);
+  free(text);
+
+  /* Errors early, in the middle and at the end of the input. */
+  text = make_parallel_input(n, 1, "");
+  compare_parallel(text, CONFIG_FALSE);
+  free(text);
+  text = make_parallel_input(n, n / 2, "");
+  compare_parallel(text, CONFIG_FALSE);
+  free(text);
+  text = make_parallel_input(n, -1, "x = \"unterminated;\n");
+  compare_parallel(text, CONFIG_FALSE);
+  free(text);
+
+  /* An include is expanded in order by a sequential read. */
+  text = make_parallel_input(n, -1, "@include \"more.cfg\"\n");
+  compare_parallel(text, CONFIG_FALSE);
+  free(text);
+
+  /* Small inputs are read sequentially. */
+  compare_parallel("a = 1; b = 2;", CONFIG_FALSE);
+  compare_parallel("a = 1; a = 2;", CONFIG_FALSE);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(LengthDelimitedLookups)
+{
+  config_t cfg;
+  int ok;
+  const config_setting_t *setting, *group;
+  const char *buf = "group.list.[12].value/group.alpha_beta";
+
+  config_init(&cfg);
+  ok = config_read_string(&cfg,
+                          "group = { alpha = 1; alpha_beta = 2;\n"
+                          "  list = ( 0, 1, { value = 3; } ); };");
+  TT_ASSERT_TRUE(ok);
+
+  /* A path that is a prefix of a longer buffer. */
+  setting = config_lookup_n(&cfg, buf, 11);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_INT_EQ(CONFIG_TYPE_LIST, config_setting_type(setting));
+
+  group = config_lookup_const_n(&cfg, buf, 5);
+  TT_ASSERT_PTR_NOTNULL(group);
+  TT_ASSERT_PTR_EQ(config_lookup(&cfg, "group"), group);
+
+  /* Names and indices are not read past the end of the path. */
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, buf, 14));
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, buf, 15));
+  TT_ASSERT_PTR_NULL(config_setting_lookup_n(group, "list.[2]", 7));
+  setting = config_setting_lookup_n(group, "list.[2].value.", 14);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_INT_EQ(3, config_setting_get_int(setting));
+
+  setting = config_setting_lookup_const_n(group, buf + 28, 5);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_INT_EQ(1, config_setting_get_int(setting));
+  setting = config_lookup_n(&cfg, buf + 22, 16);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_INT_EQ(2, config_setting_get_int(setting));
+
+  /* An empty path, or one with an embedded NUL, matches nothing. */
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, buf, 0));
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, "group\0.alpha", 12));
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, "group.alpha\0", 12));
+
+  /* As with strtol(), an index needs at least one digit. */
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "group.list.[ ]"));
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "group.list.[-]"));
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "group.list.[+]"));
+  TT_ASSERT_PTR_NULL(config_lookup_n(&cfg, "group.list.[-]", 13));
+  setting = config_lookup(&cfg, "group.list.[ +1]");
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_INT_EQ(1, config_setting_get_int(setting));
+
+  setting = config_setting_get_member_n(group, "alpha_beta", 5);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_STR_EQ("alpha", config_setting_name(setting));
+  setting = config_setting_get_member_n(group, "alpha_beta!", 10);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_STR_EQ("alpha_beta", config_setting_name(setting));
+  TT_ASSERT_PTR_NULL(config_setting_get_member_n(group, "alph", 4));
+  TT_ASSERT_PTR_NULL(config_setting_get_member_n(group, "alpha\0", 6));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(SettingHashes)
+{
+  config_t cfg1, cfg2;
+  config_setting_t *root1, *root2, *setting, *group;
+  unsigned long long root_hash, group_hash, other_hash;
+  const char *text =
+    "a = { b = [ 1, 2, 3 ]; c = \"text\"; d = ( 1.5, true, 7L ); };\n"
+    "e = { f = 1; };\n";
+
+  config_init(&cfg1);
+  config_init(&cfg2);
+  TT_ASSERT_TRUE(config_read_string(&cfg1, text));
+  TT_ASSERT_TRUE(config_read_string(&cfg2, text));
+  root1 = config_root_setting(&cfg1);
+  root2 = config_root_setting(&cfg2);
+
+  TT_ASSERT_TRUE(config_setting_hash(root1) == config_setting_hash(root2));
+  TT_ASSERT_TRUE(config_setting_equal(root1, root2));
+
+  /* A change invalidates the hashes of the setting's ancestors only. */
+  root_hash = config_setting_hash(root1);
+  group_hash = config_setting_hash(config_lookup(&cfg1, "a"));
+  other_hash = config_setting_hash(config_lookup(&cfg1, "e"));
+  setting = config_lookup(&cfg1, "a.b.[1]");
+  config_setting_set_int(setting, 5);
+  TT_ASSERT_PTR_NOTNULL(config_lookup(&cfg1, "e"));
+  TT_ASSERT_TRUE(config_lookup(&cfg1, "e")->hash == other_hash);
+  TT_ASSERT_TRUE(config_setting_hash(root1) != root_hash);
+  TT_ASSERT_TRUE(config_setting_hash(config_lookup(&cfg1, "a"))
+                 != group_hash);
+  TT_ASSERT_FALSE(config_setting_equal(root1, root2));
+  TT_ASSERT_TRUE(config_setting_equal(config_lookup(&cfg1, "e"),
+                                      config_lookup(&cfg2, "e")));
+
+  config_setting_set_int(setting, 2);
+  TT_ASSERT_TRUE(config_setting_hash(root1) == root_hash);
+  TT_ASSERT_TRUE(config_setting_equal(root1, root2));
+
+  /* A set that fails changes nothing, and keeps the cached hashes. */
+  TT_ASSERT_FALSE(config_setting_set_int(config_lookup(&cfg1, "a.c"), 1));
+  TT_ASSERT_FALSE(config_setting_set_int64(config_lookup(&cfg1, "a.c"), 1));
+  TT_ASSERT_FALSE(config_setting_set_float(config_lookup(&cfg1, "a.c"), 1));
+  TT_ASSERT_TRUE(root1->hash == root_hash);
+
+  /* Additions and removals. */
+  group = config_lookup(&cfg2, "e");
+  setting = config_setting_add(group, "g", CONFIG_TYPE_STRING);
+  TT_ASSERT_FALSE(config_setting_equal(root1, root2));
+  config_setting_set_string(setting, "x");
+  TT_ASSERT_FALSE(config_setting_equal(root1, root2));
+  TT_ASSERT_TRUE(config_setting_remove(group, "g"));
+  TT_ASSERT_TRUE(config_setting_equal(root1, root2));
+  TT_ASSERT_TRUE(config_setting_remove_elem(config_lookup(&cfg2, "a.d"), 2));
+  TT_ASSERT_FALSE(config_setting_equal(root1, root2));
+  config_setting_set_int64_elem(config_lookup(&cfg2, "a.d"), -1, 7);
+  TT_ASSERT_TRUE(config_setting_equal(root1, root2));
+
+  /* Values compare by type as well as value; member names and order
+   * matter, but not the names of the settings being compared.
+   */
+  TT_ASSERT_FALSE(config_setting_equal(config_lookup(&cfg1, "a.b.[0]"),
+                                       config_lookup(&cfg1, "a.d.[2]")));
+  TT_ASSERT_TRUE(config_setting_equal(config_lookup(&cfg1, "a.b.[0]"),
+                                      config_lookup(&cfg1, "e.f")));
+
+  config_clear(&cfg2);
+  TT_ASSERT_TRUE(config_read_string(&cfg2,
+                                    "a = { c = \"text\"; b = [ 1, 2, 3 ];"
+                                    " d = ( 1.5, true, 7L ); };\n"
+                                    "e = { f = 1; };\n"));
+  TT_ASSERT_FALSE(config_setting_equal(config_root_setting(&cfg1),
+                                       config_root_setting(&cfg2)));
+  TT_ASSERT_TRUE(config_setting_equal(config_lookup(&cfg1, "a.b"),
+                                      config_lookup(&cfg2, "a.b")));
+  setting = config_setting_add(config_root_setting(&cfg2), "x",
+                               CONFIG_TYPE_GROUP);
+  TT_ASSERT_TRUE(config_setting_equal(setting, config_lookup(&cfg2, "x")));
+  TT_ASSERT_FALSE(config_setting_equal(setting, config_lookup(&cfg2, "e")));
+
+  config_destroy(&cfg1);
+  config_destroy(&cfg2);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(Overlay)
+{
+  config_t defaults, region, host;
+  config_overlay_t *overlay;
+  const config_setting_t *setting;
+  int ival;
+  long long llval;
+  double fval;
+  const char *str;
+
+  config_init(&defaults);
+  config_init(&region);
+  config_init(&host);
+  TT_ASSERT_TRUE(config_read_string(&defaults,
+                                    "db = { host = \"localhost\"; port = 5432;"
+                                    " pool = 4; timeout = 1.5; };\n"
+                                    "debug = false;\n"));
+  TT_ASSERT_TRUE(config_read_string(&region,
+                                    "db = { host = \"db.eu\"; pool = 16; };\n"
+                                    "quota = 10000000000L;\n"));
+  TT_ASSERT_TRUE(config_read_string(&host, "db = { pool = 32; };\n"));
+
+  overlay = config_overlay_new();
+  TT_ASSERT_PTR_NULL(config_overlay_lookup(overlay, "db.host"));
+  TT_ASSERT_TRUE(config_overlay_push(overlay, &defaults));
+  TT_ASSERT_TRUE(config_overlay_push(overlay, &region));
+  TT_ASSERT_TRUE(config_overlay_push(overlay, &host));
+
+  /* Each path resolves to the topmost layer that has it. */
+  TT_ASSERT_TRUE(config_overlay_lookup_int(overlay, "db.pool", &ival));
+  TT_ASSERT_INT_EQ(32, ival);
+  TT_ASSERT_TRUE(config_overlay_lookup_string(overlay, "db.host", &str));
+  TT_ASSERT_STR_EQ("db.eu", str);
+  TT_ASSERT_TRUE(config_overlay_lookup_int(overlay, "db.port", &ival));
+  TT_ASSERT_INT_EQ(5432, ival);
+  TT_ASSERT_TRUE(config_overlay_lookup_float(overlay, "db.timeout", &fval));
+  TT_ASSERT_TRUE(fval == 1.5);
+  TT_ASSERT_TRUE(config_overlay_lookup_int64(overlay, "quota", &llval));
+  TT_ASSERT_TRUE(llval == 10000000000LL);
+  TT_ASSERT_TRUE(config_overlay_lookup_bool(overlay, "debug", &ival));
+  TT_ASSERT_FALSE(ival);
+  TT_ASSERT_FALSE(config_overlay_lookup_int(overlay, "db.host", &ival));
+  TT_ASSERT_FALSE(config_overlay_lookup_int(overlay, "db.missing", &ival));
+
+  setting = config_overlay_lookup(overlay, "db");
+  TT_ASSERT_PTR_EQ(config_lookup(&host, "db"), setting);
+  setting = config_overlay_lookup(overlay, "db.port");
+  TT_ASSERT_PTR_EQ(config_lookup(&defaults, "db.port"), setting);
+
+  /* Results are remembered until the overlay is flushed. */
+  TT_ASSERT_PTR_EQ(setting, config_overlay_lookup(overlay, "db.port"));
+  config_setting_set_int(config_setting_add(config_lookup(&host, "db"),
+                                            "port", CONFIG_TYPE_INT), 6543);
+  TT_ASSERT_TRUE(config_overlay_lookup_int(overlay, "db.port", &ival));
+  TT_ASSERT_INT_EQ(5432, ival);
+  TT_ASSERT_PTR_NULL(config_overlay_lookup(overlay, "db.missing"));
+  config_overlay_flush(overlay);
+  TT_ASSERT_TRUE(config_overlay_lookup_int(overlay, "db.port", &ival));
+  TT_ASSERT_INT_EQ(6543, ival);
+
+  config_overlay_destroy(overlay);
+  config_destroy(&defaults);
+  config_destroy(&region);
+  config_destroy(&host);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(MergeOverrides)
+{
+  config_t cfg;
+  config_setting_t *group, *inner, *scalar;
+  int ival;
+  const char *str;
+
+  /* The overrides in this file replace whole subtrees when they are not
+   * merged; merging keeps the members that a repeated group omits.
+   */
+  config_init(&cfg);
+  config_set_options(&cfg, CONFIG_OPTION_MERGE_OVERRIDES);
+  config_set_include_dir(&cfg, "./testdata");
+  TT_ASSERT_TRUE(config_read_file(&cfg, "testdata/override_setting.cfg"));
+
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "group.message", &str));
+  TT_ASSERT_STR_EQ("overridden", str);
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "group.inner.name", &str));
+  TT_ASSERT_STR_EQ("overridden", str);
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "group.inner.none", &str));
+  TT_ASSERT_STR_EQ("none", str);
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "group.inner.other", &str));
+  TT_ASSERT_STR_EQ("other", str);
+  TT_ASSERT_INT_EQ(3, config_setting_length(config_lookup(&cfg,
+                                                          "group.inner")));
+  TT_ASSERT_INT_EQ(1, config_setting_length(config_lookup(&cfg,
+                                                          "group.array")));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "group.array.[0]", &ival));
+  TT_ASSERT_INT_EQ(3, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "int", &ival));
+  TT_ASSERT_INT_EQ(2, ival);
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "string", &str));
+  TT_ASSERT_STR_EQ("overridden", str);
+  config_destroy(&cfg);
+
+  /* Repeated groups are updated in place; new members go at the end. */
+  config_init(&cfg);
+  config_set_options(&cfg, CONFIG_OPTION_MERGE_OVERRIDES);
+  TT_ASSERT_TRUE(config_read_string(
+                   &cfg,
+                   "g = { a = 1; b = { c = \"x\"; d = [1, 2]; }; };\n"
+                   "g = { b = { c = \"y\"; e = 2.5; }; f = true; };\n"
+                   "g = { a = 3; b = { d = [4]; }; };\n"));
+  group = config_lookup(&cfg, "g");
+  TT_ASSERT_INT_EQ(3, config_setting_length(group));
+  TT_ASSERT_STR_EQ("a", config_setting_name(
+                     config_setting_get_elem(group, 0)));
+  TT_ASSERT_STR_EQ("f", config_setting_name(
+                     config_setting_get_elem(group, 2)));
+  TT_ASSERT_INT_EQ(3, config_setting_source_line(
+                     config_setting_get_elem(group, 0)));
+  inner = config_lookup(&cfg, "g.b");
+  TT_ASSERT_INT_EQ(3, config_setting_length(inner));
+  TT_ASSERT_TRUE(config_lookup_string(&cfg, "g.b.c", &str));
+  TT_ASSERT_STR_EQ("y", str);
+  TT_ASSERT_INT_EQ(1, config_setting_length(config_lookup(&cfg, "g.b.d")));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.b.d.[0]", &ival));
+  TT_ASSERT_INT_EQ(4, ival);
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.a", &ival));
+  TT_ASSERT_INT_EQ(3, ival);
+
+  /* A duplicate within the repeated group is still merged. */
+  TT_ASSERT_TRUE(config_read_string(&cfg, "g = { a = 1; a = 2; };"));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "g.a", &ival));
+  TT_ASSERT_INT_EQ(2, ival);
+  TT_ASSERT_INT_EQ(1, config_setting_length(config_lookup(&cfg, "g")));
+
+  /* A value of a different type replaces the previous setting. */
+  TT_ASSERT_TRUE(config_read_string(
+                   &cfg, "a = { x = 1; }; b = 1; c = \"s\";\n"
+                   "a = 2; b = { y = 2; }; c = 3L; b = { z = 3; };\n"));
+  TT_ASSERT_INT_EQ(CONFIG_TYPE_INT,
+                   config_setting_type(config_lookup(&cfg, "a")));
+  TT_ASSERT_INT_EQ(CONFIG_TYPE_INT64,
+                   config_setting_type(config_lookup(&cfg, "c")));
+  TT_ASSERT_INT_EQ(2, config_setting_length(config_lookup(&cfg, "b")));
+  TT_ASSERT_STR_EQ("c", config_setting_name(
+                     config_setting_get_elem(config_root_setting(&cfg), 2)));
+
+  /* Scalars are updated in place, keeping their position. */
+  TT_ASSERT_TRUE(config_read_string(&cfg, "s = \"a\"; t = 0x10; s = \"b\";"));
+  scalar = config_setting_get_elem(config_root_setting(&cfg), 0);
+  TT_ASSERT_STR_EQ("s", config_setting_name(scalar));
+  TT_ASSERT_STR_EQ("b", config_setting_get_string(scalar));
+  TT_ASSERT_INT_EQ(2, config_setting_length(config_root_setting(&cfg)));
+
+  /* Lists and arrays are replaced, or appended to. */
+  TT_ASSERT_TRUE(config_read_string(&cfg,
+                                    "a = [1, 2]; l = (1, \"x\");\n"
+                                    "a = [3]; l = ({ k = 1; });\n"));
+  TT_ASSERT_INT_EQ(1, config_setting_length(config_lookup(&cfg, "a")));
+  TT_ASSERT_INT_EQ(1, config_setting_length(config_lookup(&cfg, "l")));
+
+  config_set_option(&cfg, CONFIG_OPTION_MERGE_APPEND, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_string(&cfg,
+                                    "a = [1, 2]; l = (1, \"x\");\n"
+                                    "a = [3]; l = ({ k = 1; });\n"));
+  TT_ASSERT_INT_EQ(3, config_setting_length(config_lookup(&cfg, "a")));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "a.[2]", &ival));
+  TT_ASSERT_INT_EQ(3, ival);
+  TT_ASSERT_INT_EQ(3, config_setting_length(config_lookup(&cfg, "l")));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "l.[2].k", &ival));
+  TT_ASSERT_INT_EQ(1, ival);
+
+  /* Appended elements must still match the array's element type. */
+  TT_ASSERT_FALSE(config_read_string(&cfg, "a = [1]; a = [\"x\"];"));
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static char *write_to_string(const config_t *cfg)
+{
+  FILE *fp = tmpfile();
+  long len;
+  char *text;
+
+  config_write(cfg, fp);
+  len = ftell(fp);
+  rewind(fp);
+  text = (char *)malloc((size_t)len + 1);
+  text[fread(text, 1, (size_t)len, fp)] = '\0';
+  fclose(fp);
+
+  return(text);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(PreserveFormatting)
+{
+  static const char *files[] = {
+    "testdata/input_0.cfg", "testdata/input_1.cfg", "testdata/input_2.cfg",
+    "testdata/input_3.cfg", "testdata/input_4.cfg", "testdata/input_6.cfg",
+    "testdata/nesting.cfg", "testdata/strings.cfg", "testdata/binhex.cfg",
+    NULL
+  };
+  static const char *text =
+    "# comment\n"
+    "a = 1;  // one\n"
+    "g:\n{\n"
+    "  s = \"x\"; /* keep */\n"
+    "  arr = [ 1, 2,  3 ];\n"
+    "  l = ( 1, \"two\" );\n"
+    "  h = 0x10;\n"
+    "};\n"
+    "b = 2.5;\n";
+  const char **file;
+  config_t cfg;
+  config_setting_t *setting;
+  char *out;
+
+  /* Unchanged files are written back byte for byte. */
+  for(file = files; *file; ++file)
+  {
+    config_init(&cfg);
+    config_set_option(&cfg, CONFIG_OPTION_PRESERVE_FORMATTING, CONFIG_TRUE);
+    TT_ASSERT_TRUE(config_read_file(&cfg, *file));
+    remove("temp.cfg");
+    TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+    TT_ASSERT_TXTFILE_EQ("temp.cfg", *file);
+    remove("temp.cfg");
+    config_destroy(&cfg);
+  }
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_PRESERVE_FORMATTING, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_string(&cfg, text));
+
+  /* Only the values that change are rewritten. */
+  config_setting_set_int(config_lookup(&cfg, "a"), 10);
+  config_setting_set_format(config_lookup(&cfg, "g.h"),
+                            CONFIG_FORMAT_DEFAULT);
+  out = write_to_string(&cfg);
+  TT_ASSERT_STR_EQ("# comment\n"
+                   "a = 10;  // one\n"
+                   "g:\n{\n"
+                   "  s = \"x\"; /* keep */\n"
+                   "  arr = [ 1, 2,  3 ];\n"
+                   "  l = ( 1, \"two\" );\n"
+                   "  h = 16;\n"
+                   "};\n"
+                   "b = 2.5;\n", out);
+  free(out);
+
+  /* Removed settings take the text before them with them; added ones are
+   * written after the last setting of their parent.
+   */
+  setting = config_lookup(&cfg, "g.arr");
+  config_setting_remove_elem(setting, 0);
+  config_setting_set_int_elem(setting, -1, 4);
+  config_setting_remove(config_lookup(&cfg, "g"), "s");
+  config_setting_set_string_elem(config_lookup(&cfg, "g.l"), 1, "2");
+  setting = config_setting_add(config_lookup(&cfg, "g"), "t",
+                               CONFIG_TYPE_BOOL);
+  config_setting_set_bool(setting, CONFIG_TRUE);
+  config_setting_remove(config_root_setting(&cfg), "b");
+  out = write_to_string(&cfg);
+  TT_ASSERT_STR_EQ("# comment\n"
+                   "a = 10;  // one\n"
+                   "g:\n{\n"
+                   "  arr = [ 2,  3, 4 ];\n"
+                   "  l = ( 1, \"2\" );\n"
+                   "  h = 16;\n"
+                   "  t = true;\n"
+                   "};\n", out);
+  free(out);
+
+  /* A setting whose type changes is rewritten in full. */
+  setting = config_setting_get_member(config_root_setting(&cfg), "a");
+  TT_ASSERT_TRUE(config_setting_remove(config_root_setting(&cfg), "a"));
+  setting = config_setting_add(config_lookup(&cfg, "g"), "arr2",
+                               CONFIG_TYPE_ARRAY);
+  config_setting_set_int_elem(setting, -1, 7);
+  config_setting_remove_elem(config_lookup(&cfg, "g.arr"), 0);
+  config_setting_remove_elem(config_lookup(&cfg, "g.arr"), 0);
+  out = write_to_string(&cfg);
+  TT_ASSERT_STR_EQ("# comment\n"
+                   "g:\n{\n"
+                   "  arr = [ 4];\n"
+                   "  l = ( 1, \"2\" );\n"
+                   "  h = 16;\n"
+                   "  t = true;\n"
+                   "  arr2 = [ 7 ];\n"
+                   "};\n", out);
+  free(out);
+
+  /* Reading again discards the text of the previous read. */
+  TT_ASSERT_TRUE(config_read_string(&cfg, "x = 1; # one\n"));
+  config_setting_set_int(config_lookup(&cfg, "x"), 2);
+  out = write_to_string(&cfg);
+  TT_ASSERT_STR_EQ("x = 2; # one\n", out);
+  free(out);
+
+  /* A change of format is written even if the content has been hashed
+   * since, which the format doesn't take part in.
+   */
+  TT_ASSERT_TRUE(config_read_string(&cfg, "a = 10;\n"));
+  config_setting_set_format(config_lookup(&cfg, "a"), CONFIG_FORMAT_HEX);
+  (void)config_setting_hash(config_root_setting(&cfg));
+  out = write_to_string(&cfg);
+  TT_ASSERT_STR_EQ("a = 0xA;\n", out);
+  free(out);
+  config_destroy(&cfg);
+
+  /* Configurations with includes are written as usual. */
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_PRESERVE_FORMATTING, CONFIG_TRUE);
+  config_set_include_dir(&cfg, "./testdata");
+  TT_ASSERT_TRUE(config_read_file(&cfg, "testdata/input_5.cfg"));
+  remove("temp.cfg");
+  TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+  TT_ASSERT_TXTFILE_EQ("temp.cfg", "testdata/output_5.cfg");
+  remove("temp.cfg");
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+static void write_string_to_file(const char *file, const char *text)
+{
+  FILE *fp = fopen(file, "wb");
+
+  TT_ASSERT_PTR_NOTNULL(fp);
+  fputs(text, fp);
+  fclose(fp);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(Journal)
+{
+  static const char *text = "a = 1;\ng = { s = \"x\"; l = ( 1, 2, 3 ); };\n";
+  config_t cfg, cfg2;
+  config_setting_t *root, *setting, *list;
+  const char *str, *journal;
+  char header[64], *torn;
+  int i;
+
+  remove("temp.cfg.journal");
+  write_string_to_file("temp.cfg", text);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+  root = config_root_setting(&cfg);
+
+  /* Changes go to the journal, and the file is left alone. */
+  TT_ASSERT_TRUE(config_setting_set_int(config_lookup(&cfg, "a"), 5));
+  TT_ASSERT_TRUE(config_setting_set_format(config_lookup(&cfg, "a"),
+                                           CONFIG_FORMAT_HEX));
+  TT_ASSERT_TRUE(config_setting_set_string(config_lookup(&cfg, "g.s"),
+                                           "two\nlines \"quoted\""));
+  TT_ASSERT_TRUE(config_setting_remove_elem(config_lookup(&cfg, "g.l"), 0));
+  setting = config_setting_add(config_lookup(&cfg, "g.l"), NULL,
+                               CONFIG_TYPE_GROUP);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_PTR_NOTNULL(config_setting_add(setting, "f", CONFIG_TYPE_FLOAT));
+  TT_ASSERT_TRUE(config_setting_set_float(config_lookup(&cfg, "g.l.[2].f"),
+                                          0.1));
+  list = config_setting_add(root, "arr", CONFIG_TYPE_ARRAY);
+  TT_ASSERT_PTR_NOTNULL(config_setting_set_int64_elem(list, -1, -1234567890123LL));
+  TT_ASSERT_PTR_NOTNULL(config_setting_add(root, "b", CONFIG_TYPE_BOOL));
+  TT_ASSERT_TRUE(config_setting_set_bool(config_lookup(&cfg, "b"), 1));
+  TT_ASSERT_TRUE(config_setting_add(root, "gone", CONFIG_TYPE_INT) != NULL);
+  TT_ASSERT_TRUE(config_setting_remove(root, "gone"));
+
+  str = read_file_to_string("temp.cfg");
+  TT_ASSERT_STR_EQ(text, str);
+  free((void *)str);
+
+  /* Reading the file replays the journal. */
+  config_init(&cfg2);
+  config_set_option(&cfg2, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg2, "temp.cfg"));
+  TT_ASSERT_TRUE(config_setting_equal(root, config_root_setting(&cfg2)));
+  TT_ASSERT_INT_EQ(CONFIG_FORMAT_HEX,
+                   config_setting_get_format(config_lookup(&cfg2, "a")));
+  TT_ASSERT_TRUE(config_setting_get_float(config_lookup(&cfg2, "g.l.[2].f"))
+                 == 0.1);
+  config_destroy(&cfg2);
+
+  /* A record that was cut short is dropped. */
+  journal = read_file_to_string("temp.cfg.journal");
+  torn = (char *)malloc(strlen(journal) + 16);
+  strcpy(torn, journal);
+  strcat(torn, "S 1:a i 7");
+  write_string_to_file("temp.cfg.journal", torn);
+  free(torn);
+
+  config_init(&cfg2);
+  config_set_option(&cfg2, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg2, "temp.cfg"));
+  TT_ASSERT_INT_EQ(5, config_setting_get_int(config_lookup(&cfg2, "a")));
+  str = read_file_to_string("temp.cfg.journal");
+  TT_ASSERT_STR_EQ(journal, str);
+  free((void *)str);
+  config_destroy(&cfg2);
+
+  /* Compaction writes the file and empties the journal. */
+  TT_ASSERT_TRUE(config_journal_compact(&cfg));
+  str = read_file_to_string("temp.cfg.journal");
+  TT_ASSERT_INT_EQ(19, strlen(str)); /* "J <16 hex digits>\n" */
+  strcpy(header, str);
+  free((void *)str);
+
+  config_init(&cfg2);
+  TT_ASSERT_TRUE(config_read_file(&cfg2, "temp.cfg"));
+  TT_ASSERT_TRUE(config_setting_equal(root, config_root_setting(&cfg2)));
+  config_destroy(&cfg2);
+
+  /* A journal left over from before the file was written is ignored. */
+  write_string_to_file("temp.cfg.journal", journal);
+  free((void *)journal);
+
+  config_init(&cfg2);
+  config_set_option(&cfg2, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg2, "temp.cfg"));
+  TT_ASSERT_TRUE(config_setting_equal(root, config_root_setting(&cfg2)));
+  str = read_file_to_string("temp.cfg.journal");
+  TT_ASSERT_STR_EQ(header, str);
+  free((void *)str);
+  config_destroy(&cfg2);
+
+  /* The journal is compacted whenever it grows past the limit. */
+  config_set_journal_limit(&cfg, 256);
+  for(i = 0; i < 100; ++i)
+    TT_ASSERT_TRUE(config_setting_set_int(config_lookup(&cfg, "a"), i));
+
+  str = read_file_to_string("temp.cfg.journal");
+  TT_ASSERT_TRUE(strlen(str) <= 256);
+  free((void *)str);
+
+  config_init(&cfg2);
+  config_set_option(&cfg2, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg2, "temp.cfg"));
+  TT_ASSERT_INT_EQ(99, config_setting_get_int(config_lookup(&cfg2, "a")));
+  config_destroy(&cfg2);
+  config_destroy(&cfg);
+
+  /* The first change can be an addition to the root, whose path is empty. */
+  write_string_to_file("temp.cfg", "a = 1;\n");
+  remove("temp.cfg.journal");
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+  setting = config_setting_add(config_root_setting(&cfg), "b",
+                               CONFIG_TYPE_INT);
+  TT_ASSERT_PTR_NOTNULL(setting);
+  TT_ASSERT_TRUE(config_setting_set_int(setting, 2));
+  config_destroy(&cfg);
+
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+  TT_ASSERT_TRUE(config_lookup_int(&cfg, "b", &i));
+  TT_ASSERT_INT_EQ(2, i);
+  config_destroy(&cfg);
+
+  /* A removal that takes the journal past the limit is compacted into the
+   * file without the removed setting.
+   */
+  write_string_to_file("temp.cfg", "a = 1;\nb = 2;\n");
+  remove("temp.cfg.journal");
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+  config_set_journal_limit(&cfg, 20);
+  TT_ASSERT_TRUE(config_setting_remove(config_root_setting(&cfg), "b"));
+  str = read_file_to_string("temp.cfg");
+  TT_ASSERT_STR_EQ("a = 1;\n", str);
+  free((void *)str);
+  TT_ASSERT_TRUE(config_setting_remove_elem(config_root_setting(&cfg), 0));
+  str = read_file_to_string("temp.cfg");
+  TT_ASSERT_STR_EQ("", str);
+  free((void *)str);
+  config_destroy(&cfg);
+
+  /* A record that doesn't apply fails the read. */
+  config_init(&cfg);
+  config_set_option(&cfg, CONFIG_OPTION_JOURNAL, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_read_file(&cfg, "temp.cfg"));
+  TT_ASSERT_TRUE(config_journal_compact(&cfg));
+  str = read_file_to_string("temp.cfg.journal");
+  strcpy(header, str);
+  strcat(header, "S 7:missing i 1\n");
+  free((void *)str);
+  write_string_to_file("temp.cfg.journal", header);
+  TT_ASSERT_FALSE(config_read_file(&cfg, "temp.cfg"));
+  TT_ASSERT_INT_EQ(CONFIG_ERR_PARSE, config_error_type(&cfg));
+  TT_ASSERT_INT_EQ(2, config_error_line(&cfg));
+  config_destroy(&cfg);
+
+  remove("temp.cfg");
+  remove("temp.cfg.journal");
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(AtomicWrite)
+{
+  config_t cfg;
+  struct stat stbuf;
+
+  config_init(&cfg);
+  config_set_include_dir(&cfg, "./testdata");
+  TT_ASSERT_TRUE(config_read_file(&cfg, "testdata/input_0.cfg"));
+
+  /* The output is the same as that of a write in place. */
+  remove("temp.cfg");
+  remove("temp2.cfg");
+  TT_ASSERT_TRUE(config_write_file(&cfg, "temp2.cfg"));
+  config_set_option(&cfg, CONFIG_OPTION_ATOMIC_WRITE, CONFIG_TRUE);
+  TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+  TT_ASSERT_TXTFILE_EQ("temp.cfg", "temp2.cfg");
+
+  /* Replacing a file keeps its permissions. */
+#ifndef _WIN32
+  TT_ASSERT_INT_EQ(0, chmod("temp.cfg", 0600));
+  TT_ASSERT_TRUE(config_write_file(&cfg, "temp.cfg"));
+  TT_ASSERT_INT_EQ(0, stat("temp.cfg", &stbuf));
+  TT_ASSERT_INT_EQ(0600, stbuf.st_mode & 0777);
+#else
+  (void)stbuf;
+#endif
+  TT_ASSERT_TXTFILE_EQ("temp.cfg", "temp2.cfg");
+
+  TT_ASSERT_FALSE(config_write_file(&cfg, "nonexistent/temp.cfg"));
+  TT_ASSERT_INT_EQ(CONFIG_ERR_FILE_IO, config_error_type(&cfg));
+
+  remove("temp.cfg");
+  remove("temp2.cfg");
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#define DEEP_NESTING 1000000
+
+struct walk_counts
+{
+  unsigned int entered;
+  unsigned int left;
+  unsigned int max_depth;
+  unsigned int stop_at;
+};
+
+static int walk_enter(config_setting_t *setting, unsigned int depth,
+                      void *user)
+{
+  struct walk_counts *counts = (struct walk_counts *)user;
+  const char *name = config_setting_name(setting);
+
+  if(++counts->entered == counts->stop_at)
+    return(CONFIG_WALK_STOP);
+
+  if(depth > counts->max_depth)
+    counts->max_depth = depth;
+
+  if(name && !strcmp(name, "skipped"))
+    return(CONFIG_WALK_SKIP);
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+static int walk_leave(config_setting_t *setting, unsigned int depth,
+                      void *user)
+{
+  struct walk_counts *counts = (struct walk_counts *)user;
+
+  (void)setting;
+  (void)depth;
+  ++counts->left;
+
+  return(CONFIG_WALK_CONTINUE);
+}
+
+TT_TEST(DeepNesting)
+{
+  config_t cfg;
+  config_setting_t *root, *setting;
+  struct walk_counts counts;
+  unsigned int i;
+  char buf[16];
+  FILE *fp;
+
+  config_init(&cfg);
+  root = config_root_setting(&cfg);
+  setting = config_setting_add(root, "skipped", CONFIG_TYPE_GROUP);
+  config_setting_set_int(config_setting_add(setting, "x", CONFIG_TYPE_INT), 1);
+
+  setting = config_setting_add(root, "deep", CONFIG_TYPE_LIST);
+  for(i = 1; i < DEEP_NESTING; ++i)
+    setting = config_setting_add(setting, NULL, CONFIG_TYPE_LIST);
+  TT_ASSERT_PTR_NOTNULL(config_setting_set_int_elem(setting, -1, 7));
+
+  /* Every setting is visited once, in both orders, apart from the members
+   * of the skipped group.
+   */
+  memset(&counts, 0, sizeof(counts));
+  TT_ASSERT_TRUE(config_walk(root, walk_enter, walk_leave, &counts));
+  TT_ASSERT_INT_EQ(DEEP_NESTING + 3, counts.entered);
+  TT_ASSERT_INT_EQ(DEEP_NESTING + 3, counts.left);
+  TT_ASSERT_INT_EQ(DEEP_NESTING + 1, counts.max_depth);
+
+  memset(&counts, 0, sizeof(counts));
+  counts.stop_at = 1000;
+  TT_ASSERT_FALSE(config_walk(root, walk_enter, walk_leave, &counts));
+  TT_ASSERT_INT_EQ(1000, counts.entered);
+  TT_ASSERT_INT_EQ(1, counts.left);
+
+  /* The writer doesn't recurse either. */
+  fp = tmpfile();
+  TT_ASSERT_PTR_NOTNULL(fp);
+  config_write(&cfg, fp);
+  TT_ASSERT_INT_EQ(4 * DEEP_NESTING + 35, ftell(fp));
+  fseek(fp, -9, SEEK_END);
+  TT_ASSERT_PTR_NOTNULL(fgets(buf, sizeof(buf), fp));
+  TT_ASSERT_STR_EQ(") ) ) );\n", buf);
+  fclose(fp);
+
+  /* Nor do hashing and comparison. */
+  setting = config_setting_add(root, "deep2", CONFIG_TYPE_LIST);
+  for(i = 1; i < DEEP_NESTING; ++i)
+    setting = config_setting_add(setting, NULL, CONFIG_TYPE_LIST);
+  TT_ASSERT_PTR_NOTNULL(config_setting_set_int_elem(setting, -1, 7));
+  TT_ASSERT_TRUE(config_setting_hash(config_lookup(&cfg, "deep"))
+                 == config_setting_hash(config_lookup(&cfg, "deep2")));
+  TT_ASSERT_TRUE(config_setting_equal(config_lookup(&cfg, "deep"),
+                                      config_lookup(&cfg, "deep2")));
+  TT_ASSERT_PTR_NOTNULL(config_setting_set_int_elem(setting, 0, 8));
+  TT_ASSERT_FALSE(config_setting_equal(config_lookup(&cfg, "deep"),
+                                       config_lookup(&cfg, "deep2")));
+  TT_ASSERT_TRUE(config_setting_remove(root, "deep2"));
+
+  /* Nor does destroying a setting. */
+  TT_ASSERT_TRUE(config_setting_remove(root, "deep"));
+  TT_ASSERT_INT_EQ(1, config_setting_length(root));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+struct query_results
+{
+  int values[16];
+  int count;
+  int limit;
+};
+
+static int collect_int(config_setting_t *setting, void *user)
+{
+  struct query_results *results = (struct query_results *)user;
+
+  results->values[results->count++] = config_setting_get_int(setting);
+
+  return((results->count == results->limit)
+         ? CONFIG_WALK_STOP : CONFIG_WALK_CONTINUE);
+}
+
+#define RUN_QUERY(C, E, R)                                  \
+  (memset(&(R), 0, sizeof(R)), config_query((C), (E), collect_int, &(R)))
+
+TT_TEST(Query)
+{
+  config_t cfg;
+  config_query_t *query;
+  struct query_results results;
+
+  config_init(&cfg);
+  TT_ASSERT_TRUE(config_read_string(&cfg,
+                                    "servers = {\n"
+                                    "  alpha = { port = 80; timeout = 5; };\n"
+                                    "  beta = { port = 81; };\n"
+                                    "  gamma = { host = \"db\"; };\n"
+                                    "};\n"
+                                    "pools = (\n"
+                                    "  { members = [ 1, 2, 3, 4, 5, 6 ];"
+                                    " timeout = 10; },\n"
+                                    "  { members = [ 7, 8 ]; }\n"
+                                    ");\n"
+                                    "timeout = 1;\n"));
+
+  TT_ASSERT_INT_EQ(2, RUN_QUERY(&cfg, "servers.*.port", results));
+  TT_ASSERT_INT_EQ(80, results.values[0]);
+  TT_ASSERT_INT_EQ(81, results.values[1]);
+
+  TT_ASSERT_INT_EQ(6, RUN_QUERY(&cfg, "pools[*].members[0:4]", results));
+  TT_ASSERT_INT_EQ(4, results.values[3]);
+  TT_ASSERT_INT_EQ(7, results.values[4]);
+  TT_ASSERT_INT_EQ(8, results.values[5]);
+
+  /* A setting's members come before those of the settings below it. */
+  TT_ASSERT_INT_EQ(3, RUN_QUERY(&cfg, "..timeout", results));
+  TT_ASSERT_INT_EQ(1, results.values[0]);
+  TT_ASSERT_INT_EQ(5, results.values[1]);
+  TT_ASSERT_INT_EQ(10, results.values[2]);
+
+  TT_ASSERT_INT_EQ(1, RUN_QUERY(&cfg, "pools.[-1].members.[-1]", results));
+  TT_ASSERT_INT_EQ(8, results.values[0]);
+  TT_ASSERT_INT_EQ(3, RUN_QUERY(&cfg, "pools[1:]..[ * ]", results));
+  TT_ASSERT_INT_EQ(3, RUN_QUERY(&cfg, "pools[0].members[-3:]", results));
+  TT_ASSERT_INT_EQ(4, results.values[0]);
+  TT_ASSERT_INT_EQ(1, RUN_QUERY(&cfg, "servers/alpha:port", results));
+  TT_ASSERT_INT_EQ(0, RUN_QUERY(&cfg, "servers.delta.port", results));
+  TT_ASSERT_INT_EQ(0, RUN_QUERY(&cfg, "pools[2:9]", results));
+
+  /* The callback can end the query early. */
+  memset(&results, 0, sizeof(results));
+  results.limit = 2;
+  TT_ASSERT_INT_EQ(2, config_query(&cfg, "..members[*]", collect_int,
+                                   &results));
+
+  TT_ASSERT_INT_EQ(-1, config_query(&cfg, "servers..", NULL, NULL));
+  TT_ASSERT_INT_EQ(-1, config_query(&cfg, "pools[]", NULL, NULL));
+  TT_ASSERT_INT_EQ(-1, config_query(&cfg, "pools[x]", NULL, NULL));
+  TT_ASSERT_INT_EQ(-1, config_query(&cfg, "pools[0", NULL, NULL));
+  TT_ASSERT_INT_EQ(-1, config_query(&cfg, "pools[0:1:2]", NULL, NULL));
+
+  /* A compiled query can be run on any setting. */
+  query = config_query_compile("*.port");
+  TT_ASSERT_PTR_NOTNULL(query);
+  TT_ASSERT_INT_EQ(2, config_query_run(query,
+                                       config_lookup(&cfg, "servers"),
+                                       NULL, NULL));
+  TT_ASSERT_INT_EQ(0, config_query_run(query, config_root_setting(&cfg),
+                                       NULL, NULL));
+  config_query_destroy(query);
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(RecordIndex)
+{
+  config_t cfg;
+  config_setting_t *users, *record;
+  config_index_t *by_id, *by_name;
+  const char *str;
+  int ival;
+
+  config_init(&cfg);
+  TT_ASSERT_TRUE(config_read_string(&cfg,
+                                    "users = (\n"
+                                    "  { id = 17; name = \"ann\"; },\n"
+                                    "  { id = 4294967296L; name = \"bob\"; },\n"
+                                    "  { id = 23; name = \"ann\"; },\n"
+                                    "  { name = \"cat\"; },\n"
+                                    "  42\n"
+                                    ");\n"));
+  users = config_lookup(&cfg, "users");
+
+  by_id = config_setting_build_index(users, "id");
+  by_name = config_setting_build_index(users, "name");
+  TT_ASSERT_PTR_NOTNULL(by_id);
+  TT_ASSERT_PTR_NOTNULL(by_name);
+  TT_ASSERT_PTR_NULL(config_setting_build_index(
+                       config_lookup(&cfg, "users.[0].id"), "id"));
+
+  record = config_index_find_int(by_id, 17);
+  TT_ASSERT_PTR_EQ(config_setting_get_elem(users, 0), record);
+  record = config_index_find_int(by_id, 4294967296LL);
+  TT_ASSERT_PTR_EQ(config_setting_get_elem(users, 1), record);
+  TT_ASSERT_PTR_NULL(config_index_find_int(by_id, 42));
+  TT_ASSERT_PTR_NULL(config_index_find_string(by_id, "17"));
+
+  /* The first of several records with the same key is found. */
+  record = config_index_find_string(by_name, "ann");
+  TT_ASSERT_TRUE(config_setting_lookup_int(record, "id", &ival));
+  TT_ASSERT_INT_EQ(17, ival);
+  TT_ASSERT_PTR_EQ(config_setting_get_elem(users, 3),
+                   config_index_find_string(by_name, "cat"));
+
+  /* A change to the configuration is seen by the next lookup. */
+  config_setting_set_int(config_lookup(&cfg, "users.[2].id"), 99);
+  TT_ASSERT_PTR_EQ(config_setting_get_elem(users, 2),
+                   config_index_find_int(by_id, 99));
+  TT_ASSERT_PTR_NULL(config_index_find_int(by_id, 23));
+
+  TT_ASSERT_TRUE(config_setting_remove_elem(users, 0));
+  record = config_index_find_string(by_name, "ann");
+  TT_ASSERT_TRUE(config_setting_lookup_int(record, "id", &ival));
+  TT_ASSERT_INT_EQ(99, ival);
+  TT_ASSERT_PTR_NULL(config_index_find_int(by_id, 17));
+
+  record = config_setting_add(users, NULL, CONFIG_TYPE_GROUP);
+  config_setting_set_string(config_setting_add(record, "name",
+                                               CONFIG_TYPE_STRING), "dan");
+  TT_ASSERT_PTR_EQ(record, config_index_find_string(by_name, "dan"));
+  TT_ASSERT_TRUE(config_setting_lookup_string(
+                   config_index_find_string(by_name, "bob"), "name", &str));
+  TT_ASSERT_STR_EQ("bob", str);
+
+  config_index_destroy(by_id);
+  config_index_destroy(by_name);
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
+TT_TEST(FrozenLookups)
+{
+  static const char *paths[] = {
+    "servers", "servers.alpha", "servers.alpha.port", "pools.[0]",
+    "pools.[1].members.[1]", "pools[1].members[1]", "servers/alpha:port",
+    "pools.[2]", "servers.delta", "servers.alpha.port.x", ".servers", "",
+    NULL
+  };
+  const config_setting_t *expected[sizeof(paths) / sizeof(paths[0])];
+  config_t cfg;
+  config_setting_t *setting;
+  char path[400];
+  int i;
+
+  config_init(&cfg);
+  TT_ASSERT_TRUE(config_read_string(&cfg,
+                                    "servers = {\n"
+                                    "  alpha = { port = 80; };\n"
+                                    "  beta = { port = 81; };\n"
+                                    "};\n"
+                                    "pools = (\n"
+                                    "  { members = [ 1, 2, 3 ]; },\n"
+                                    "  { members = [ 7, 8 ]; }\n"
+                                    ");\n"));
+
+  /* Lookups find the same settings once the configuration is frozen,
+   * whatever the spelling of the path.
+   */
+  for(i = 0; paths[i]; ++i)
+    expected[i] = config_lookup(&cfg, paths[i]);
+
+  TT_ASSERT_TRUE(config_freeze(&cfg));
+  TT_ASSERT_PTR_NOTNULL(cfg.frozen);
+
+  for(i = 0; paths[i]; ++i)
+    TT_ASSERT_PTR_EQ(expected[i], config_lookup(&cfg, paths[i]));
+
+  TT_ASSERT_PTR_EQ(expected[2], config_lookup_n(&cfg, "servers.alpha.portx",
+                                                18));
+
+  /* A change unfreezes the configuration. */
+  TT_ASSERT_TRUE(config_setting_remove(config_lookup(&cfg, "servers"),
+                                       "alpha"));
+  TT_ASSERT_PTR_NULL(cfg.frozen);
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "servers.alpha.port"));
+
+  /* Paths too long for the table are still found. */
+  setting = config_lookup(&cfg, "servers.beta");
+  strcpy(path, "servers.beta");
+  for(i = 0; i < 30; ++i)
+  {
+    setting = config_setting_add(setting, "abcdefghij", CONFIG_TYPE_GROUP);
+    strcat(path, ".abcdefghij");
+  }
+
+  TT_ASSERT_TRUE(config_freeze(&cfg));
+  TT_ASSERT_PTR_EQ(setting, config_lookup(&cfg, path));
+  TT_ASSERT_PTR_EQ(config_setting_get_elem(config_lookup(&cfg, "pools"), 1),
+                   config_lookup(&cfg, "pools.[1]"));
+
+  config_clear(&cfg);
+  TT_ASSERT_PTR_NULL(cfg.frozen);
+  TT_ASSERT_TRUE(config_freeze(&cfg));
+  TT_ASSERT_PTR_NULL(config_lookup(&cfg, "pools"));
+
+  config_destroy(&cfg);
+}
+
+/* ------------------------------------------------------------------------- */
+
 int main(int argc, char **argv)
 {
   int failures;
@@ -769,6 +3107,28 @@ int main(int argc, char **argv)
   TT_SUITE_TEST(LibConfigTests, SettingLookups);
   TT_SUITE_TEST(LibConfigTests, ReadStream);
   TT_SUITE_TEST(LibConfigTests, BinaryAndHex);
+  TT_SUITE_TEST(LibConfigTests, LargeAggregates);
+  TT_SUITE_TEST(LibConfigTests, FastScannerConformance);
+  TT_SUITE_TEST(LibConfigTests, NumberParsing);
+  TT_SUITE_TEST(LibConfigTests, RoundTripFloats);
+  TT_SUITE_TEST(LibConfigTests, Stats);
+  TT_SUITE_TEST(LibConfigTests, WideGroups);
+  TT_SUITE_TEST(LibConfigTests, ReadBuffer);
+  TT_SUITE_TEST(LibConfigTests, PushParser);
+  TT_SUITE_TEST(LibConfigTests, IOProvider);
+  TT_SUITE_TEST(LibConfigTests, GlobIncludes);
+  TT_SUITE_TEST(LibConfigTests, ParallelParse);
+  TT_SUITE_TEST(LibConfigTests, LengthDelimitedLookups);
+  TT_SUITE_TEST(LibConfigTests, SettingHashes);
+  TT_SUITE_TEST(LibConfigTests, Overlay);
+  TT_SUITE_TEST(LibConfigTests, MergeOverrides);
+  TT_SUITE_TEST(LibConfigTests, PreserveFormatting);
+  TT_SUITE_TEST(LibConfigTests, Journal);
+  TT_SUITE_TEST(LibConfigTests, AtomicWrite);
+  TT_SUITE_TEST(LibConfigTests, DeepNesting);
+  TT_SUITE_TEST(LibConfigTests, Query);
+  TT_SUITE_TEST(LibConfigTests, RecordIndex);
+  TT_SUITE_TEST(LibConfigTests, FrozenLookups);
   TT_SUITE_RUN(LibConfigTests);
   failures = TT_SUITE_NUM_FAILURES(LibConfigTests);
   TT_SUITE_END(LibConfigTests);
@@ -0,0 +1,378 @@
+/* ----------------------------------------------------------------------------
+   libconfig - A library for processing structured configuration files
+   Copyright (C) 2005-2025  Mark A Lindner
+
+   This file is part of libconfig.
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Lesser General Public License
+   as published by the Free Software Foundation; either version 2.1 of
+   the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Lesser General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public
+   License along with this library; if not, see
+   <http://www.gnu.org/licenses/>.
+   ----------------------------------------------------------------------------
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include <libconfig.h++>
+#include <tinytest.h>
+
+using namespace libconfig;
+
+// ---------------------------------------------------------------------------
+
+// A Config that resolves every @include to testdata/more.cfg, and counts the
+// includes that it resolves, so that a test can tell which object a
+// configuration's include hook calls.
+
+class RedirectConfig : public Config
+{
+  public:
+
+  RedirectConfig()
+    : includes(0) { }
+
+#if __cplusplus >= 201103L
+  RedirectConfig(RedirectConfig &&other) noexcept
+    : Config(std::move(other)), includes(0) { }
+
+  RedirectConfig& operator=(RedirectConfig &&other) noexcept
+  {
+    Config::operator=(std::move(other));
+    return(*this);
+  }
+#endif
+
+  virtual const char **evaluateIncludePath(const char *path,
+                                           const char **error)
+  {
+    (void)path;
+    (void)error;
+
+    const char **files = static_cast<const char **>(
+      std::malloc(2 * sizeof(const char *)));
+    files[0] = ::strdup("testdata/more.cfg");
+    files[1] = NULL;
+
+    ++includes;
+    return(files);
+  }
+
+  int includes;
+};
+
+// ---------------------------------------------------------------------------
+
+static const char *include_text = "@include \"anything.cfg\"\n";
+
+// ---------------------------------------------------------------------------
+
+TT_TEST(Swap)
+{
+  RedirectConfig a, b;
+
+  a.readString("x = 1;");
+  b.readString("y = 2;");
+  Setting &x = a.lookup("x");
+
+  a.swap(b);
+
+  TT_ASSERT_TRUE(a.exists("y"));
+  TT_ASSERT_FALSE(a.exists("x"));
+  TT_ASSERT_PTR_EQ(&b.lookup("x"), &x);
+
+  // The setting's wrapper is destroyed through b's destructor hook.
+  b.getRoot().remove("x");
+  TT_ASSERT_FALSE(b.exists("x"));
+
+  // Each object resolves the includes of the configuration it now holds.
+  a.readString(include_text);
+  TT_ASSERT_INT_EQ(a.includes, 1);
+  TT_ASSERT_INT_EQ(b.includes, 0);
+  TT_ASSERT_STR_EQ(a.lookup("message").c_str(), "Hello, world!");
+
+  b.readString(include_text);
+  TT_ASSERT_INT_EQ(b.includes, 1);
+
+  a.readString("x = 1;");
+  swap(a, b);
+  TT_ASSERT_TRUE(b.exists("x"));
+  TT_ASSERT_TRUE(a.exists("message"));
+}
+
+// ---------------------------------------------------------------------------
+
+#if __cplusplus >= 201103L
+
+TT_TEST(Move)
+{
+  RedirectConfig a;
+
+  a.setOption(Config::OptionAutoConvert, true);
+  a.readString("x = 1;");
+  Setting &x = a.lookup("x");
+
+  RedirectConfig b(std::move(a));
+
+  // The settings, and their wrappers, move with the configuration.
+  TT_ASSERT_PTR_EQ(&b.lookup("x"), &x);
+  TT_ASSERT_TRUE(b.getAutoConvert());
+
+  // The moved-from object is left with an empty configuration of its own.
+  TT_ASSERT_FALSE(a.exists("x"));
+  TT_ASSERT_FALSE(a.getAutoConvert());
+  a.readString(include_text);
+  TT_ASSERT_INT_EQ(a.includes, 1);
+  TT_ASSERT_TRUE(a.exists("message"));
+
+  // Includes read after the move are resolved by the new owner.
+  b.readString(include_text);
+  TT_ASSERT_INT_EQ(b.includes, 1);
+  TT_ASSERT_INT_EQ(a.includes, 1);
+  TT_ASSERT_STR_EQ(b.lookup("message").c_str(), "Hello, world!");
+
+  // Move assignment hands the assigned-to object's configuration to other.
+  RedirectConfig c;
+  c.readString("z = 3;");
+  Setting &z = c.lookup("z");
+
+  c = std::move(b);
+  TT_ASSERT_TRUE(c.exists("message"));
+  TT_ASSERT_PTR_EQ(&b.lookup("z"), &z);
+
+  c.readString(include_text);
+  TT_ASSERT_INT_EQ(c.includes, 1);
+  b.readString(include_text);
+  TT_ASSERT_INT_EQ(b.includes, 2);
+
+  // The wrappers are destroyed through the new owner's destructor hook.
+  b.readString("w = 4;");
+  b.lookup("w");
+  b.clear();
+  TT_ASSERT_FALSE(b.exists("w"));
+
+  // Moving out of c again leaves it empty, and both are destroyed as usual.
+  RedirectConfig d(std::move(c));
+  TT_ASSERT_TRUE(d.exists("message"));
+  TT_ASSERT_FALSE(c.exists("message"));
+}
+
+#endif // __cplusplus >= 201103L
+
+// ---------------------------------------------------------------------------
+
+static const char *view_text =
+  "a = 1;\n"
+  "g = { x = 2; l = ( 3, { y = 4; } ); e = (); };\n"
+  "s = \"str\";\n";
+
+// ---------------------------------------------------------------------------
+
+TT_TEST(SettingViews)
+{
+  Config cfg;
+  cfg.readString(view_text);
+
+  SettingView root(cfg.getRoot());
+  TT_ASSERT_TRUE(root.isRoot());
+  TT_ASSERT_INT_EQ(root.getLength(), 3);
+
+  // The elements of an aggregate are visited in order.
+  std::string names;
+  for(SettingView::iterator it = root.begin(); it != root.end(); ++it)
+    names += it->getName();
+  TT_ASSERT_STR_EQ(names.c_str(), "ags");
+
+  SettingView::iterator it = root.begin();
+  TT_ASSERT_INT_EQ(root.end() - it, 3);
+  TT_ASSERT_STR_EQ(it[2].getName(), "s");
+  TT_ASSERT_STR_EQ((*(it + 1)).getName(), "g");
+  it += 2;
+  --it;
+  TT_ASSERT_TRUE(*it == root["g"]);
+  TT_ASSERT_TRUE(it < root.end());
+
+  // An empty aggregate has no elements.
+  SettingView e = root.lookup("g.e");
+  TT_ASSERT_TRUE(e.begin() == e.end());
+
+  // The settings below an aggregate are visited depth first, each before its
+  // own elements.
+  static const char *paths[] = { "a", "g", "g.x", "g.l", "g.l.[0]",
+                                 "g.l.[1]", "g.l.[1].y", "g.e", "s" };
+  static const unsigned int depths[] = { 1, 1, 2, 2, 3, 3, 4, 2, 1 };
+  unsigned int n = 0;
+
+  SettingViewDescendants all = root.descendants();
+  for(SettingViewRecursiveIterator ri = all.begin(); ri != all.end(); ++ri)
+  {
+    TT_ASSERT_TRUE(n < sizeof(depths) / sizeof(depths[0]));
+    TT_ASSERT_STR_EQ(ri->getPath().c_str(), paths[n]);
+    TT_ASSERT_UINT_EQ(ri.depth(), depths[n]);
+    ++n;
+  }
+  TT_ASSERT_UINT_EQ(n, 9);
+
+  // Depths are relative to the aggregate that the iteration starts from.
+  SettingViewRecursiveIterator ri = root["g"]["l"].descendants().begin();
+  TT_ASSERT_STR_EQ(ri->getPath().c_str(), "g.l.[0]");
+  TT_ASSERT_UINT_EQ(ri.depth(), 1);
+  ++ri;
+  ++ri;
+  TT_ASSERT_STR_EQ(ri->getPath().c_str(), "g.l.[1].y");
+  TT_ASSERT_UINT_EQ(ri.depth(), 2);
+  ++ri;
+  TT_ASSERT_TRUE(ri == SettingViewRecursiveIterator());
+  TT_ASSERT_TRUE(e.descendants().begin() == e.descendants().end());
+
+  // Parents lead back to the root, which has none.
+  SettingView y = root.lookup("g.l.[1].y");
+  TT_ASSERT_FALSE(y.isRoot());
+  TT_ASSERT_TRUE(y.getParent() == root["g"]["l"][1]);
+  TT_ASSERT_TRUE(y.getParent().getParent().getParent() == root["g"]);
+  TT_ASSERT_TRUE(root["g"].getParent() == root);
+  TT_ASSERT_TRUE(root["g"].getParent().isRoot());
+
+  bool thrown = false;
+  try
+  {
+    root.getParent();
+  }
+  catch(const SettingNotFoundException &)
+  {
+    thrown = true;
+  }
+  TT_ASSERT_TRUE(thrown);
+
+  // Lookups through a view are relative to it.
+  SettingView g = root["g"];
+  TT_ASSERT_INT_EQ(static_cast<int>(g.lookup("l.[1].y")), 4);
+  TT_ASSERT_INT_EQ(static_cast<int>(g["x"]), 2);
+  TT_ASSERT_TRUE(g.exists("l"));
+  TT_ASSERT_FALSE(g.exists("a"));
+  TT_ASSERT_TRUE(g.tryLookup("a").isNull());
+  TT_ASSERT_TRUE(g.tryLookup("l.[0]") == root.lookup("g.l.[0]"));
+
+  int value = 0;
+  TT_ASSERT_TRUE(g.lookupValue("x", value));
+  TT_ASSERT_INT_EQ(value, 2);
+  TT_ASSERT_FALSE(g.lookupValue("l", value));
+
+  std::string str;
+  TT_ASSERT_TRUE(root.lookupValue("s", str));
+  TT_ASSERT_STR_EQ(str.c_str(), "str");
+
+  // Only a group can be looked up by name.
+  TT_ASSERT_TRUE(g["l"].tryLookup("y").isNull());
+  TT_ASSERT_TRUE(SettingView().tryLookup("a").isNull());
+
+  thrown = false;
+  try
+  {
+    g.lookup("missing");
+  }
+  catch(const SettingNotFoundException &)
+  {
+    thrown = true;
+  }
+  TT_ASSERT_TRUE(thrown);
+
+  // A view and the Setting it was made from refer to the same setting.
+  TT_ASSERT_PTR_EQ(&g.getSetting(), &cfg.lookup("g"));
+}
+
+// ---------------------------------------------------------------------------
+
+TT_TEST(TryLookupAndGet)
+{
+  Config cfg;
+  cfg.readString("i = 5; big = 10000000000L; f = 1.5; s = \"text\";"
+                 "g = { n = 7; };");
+
+  // A missing path gives a null view or the default, and doesn't throw.
+  TT_ASSERT_TRUE(cfg.tryLookup("missing").isNull());
+  TT_ASSERT_TRUE(cfg.tryLookup("g.missing.n").isNull());
+  TT_ASSERT_INT_EQ(cfg.get("missing", 3), 3);
+  TT_ASSERT_INT_EQ(cfg.lookup("g").get("missing", 3), 3);
+
+  int i = 0;
+  TT_ASSERT_FALSE(cfg.tryLookup("missing").getValue(i));
+  TT_ASSERT_INT_EQ(i, 0);
+
+  // So does a value of the wrong type, which is left unchanged.
+  std::string str = "unchanged";
+  TT_ASSERT_FALSE(cfg.tryLookup("i").getValue(str));
+  TT_ASSERT_STR_EQ(str.c_str(), "unchanged");
+  TT_ASSERT_FALSE(cfg.tryLookup("s").getValue(i));
+  TT_ASSERT_INT_EQ(cfg.get("s", 3), 3);
+  TT_ASSERT_INT_EQ(cfg.get("g", 3), 3);
+  TT_ASSERT_STR_EQ(cfg.get<std::string>("i", "none").c_str(), "none");
+
+  // An int widens to a 64-bit integer, but a 64-bit integer that doesn't fit
+  // isn't narrowed to an int.
+  TT_ASSERT_INT64_EQ(cfg.get("i", 0LL), 5LL);
+  TT_ASSERT_INT64_EQ(cfg.get("big", 0LL), 10000000000LL);
+  TT_ASSERT_INT_EQ(cfg.get("big", 3), 3);
+
+  // Conversions between integers and floats need AutoConvert.
+  TT_ASSERT_DOUBLE_EQ(cfg.get("i", 0.0), 0.0);
+  TT_ASSERT_INT_EQ(cfg.get("f", 3), 3);
+
+  cfg.setAutoConvert(true);
+  TT_ASSERT_DOUBLE_EQ(cfg.get("i", 0.0), 5.0);
+  TT_ASSERT_DOUBLE_EQ(cfg.get("i", 0.0f), 5.0);
+  TT_ASSERT_DOUBLE_EQ(cfg.get("big", 0.0), 10000000000.0);
+  TT_ASSERT_INT_EQ(cfg.get("f", 3), 1);
+  TT_ASSERT_INT_EQ(cfg.get("s", 3), 3);
+
+  // Paths and values can be given as strings.
+  const std::string path = "g.n";
+  TT_ASSERT_INT_EQ(static_cast<int>(cfg.tryLookup(path)), 7);
+  TT_ASSERT_INT_EQ(cfg.get(path, 0), 7);
+  TT_ASSERT_INT_EQ(static_cast<int>(cfg.tryLookup("g.n.x", 3)), 7);
+  TT_ASSERT_STR_EQ(cfg.get("s", std::string()).c_str(), "text");
+  TT_ASSERT_STR_EQ(cfg.get<std::string>(std::string("s"), "").c_str(),
+                   "text");
+  TT_ASSERT_STR_EQ(cfg.get<const char *>("s", NULL), "text");
+
+#if __cplusplus >= 201703L
+  TT_ASSERT_INT_EQ(*cfg.get<int>(std::string_view("g.n.x", 3)), 7);
+  TT_ASSERT_FALSE(cfg.get<int>("missing").has_value());
+  TT_ASSERT_FALSE(cfg.get<int>("s").has_value());
+  TT_ASSERT_STR_EQ(cfg.get<std::string>("s")->c_str(), "text");
+#endif
+}
+
+// ---------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  int failures;
+
+  TT_SUITE_START(LibConfigCxxTests);
+  TT_SUITE_TEST(LibConfigCxxTests, Swap);
+#if __cplusplus >= 201103L
+  TT_SUITE_TEST(LibConfigCxxTests, Move);
+#endif
+  TT_SUITE_TEST(LibConfigCxxTests, SettingViews);
+  TT_SUITE_TEST(LibConfigCxxTests, TryLookupAndGet);
+  TT_SUITE_RUN(LibConfigCxxTests);
+  failures = TT_SUITE_NUM_FAILURES(LibConfigCxxTests);
+  TT_SUITE_END(LibConfigCxxTests);
+
+  if(failures)
+    return EXIT_FAILURE;
+
+  return EXIT_SUCCESS;
+}
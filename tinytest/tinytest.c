@@ -631,10 +631,8 @@ tt_bool_t tt_file_exists(const char *file)
   return(access(file, F_OK) == 0);
 }
 
-#ifdef _MSC_VER
-
-/* All of this extra code is because MSVC doesn't support the C99 standard.
-   Sigh.
+/* All of this extra code is because MSVC doesn't support the C99 standard,
+   and C++ doesn't have compound literals. Sigh.
 */
 
 /*
@@ -726,6 +724,4 @@ void tt_test_ptr(const char *file, int line, const char *aexpr, tt_op_t op,
   tt_expect(file, line, aexpr, op, bexpr, aval, bval, fatal);
 }
 
-#endif /* defined(WIN32) || defined(WIN64) */
-
 /* end of source file */
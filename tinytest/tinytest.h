@@ -27,6 +27,10 @@
 #include <string.h>
 #include <stdlib.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef int tt_bool_t;
 
 #define TT_TRUE (1)
@@ -104,7 +108,7 @@ extern void tt_fail(const char *file, int line, const char *message, ...);
 
 extern tt_bool_t tt_file_exists(const char *file);
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_int(const char *file, int line, const char *aexpr,
                         tt_op_t op, const char *bexpr, int a, int b,
@@ -159,7 +163,7 @@ extern void tt_test_int(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_INT_GE(A, B)                  \
   TT_TEST_INT_((A), TT_OP_INT_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_uint(const char *file, int line, const char *aexpr,
                          tt_op_t op, const char *bexpr, unsigned int a,
@@ -214,7 +218,7 @@ extern void tt_test_uint(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_UINT_GE(A, B)                  \
   TT_TEST_UINT_((A), TT_OP_UINT_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_int64(const char *file, int line, const char *aexpr,
                           tt_op_t op, const char *bexpr, long long a,
@@ -269,7 +273,7 @@ extern void tt_test_int64(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_INT64_GE(A, B)                      \
   TT_TEST_INT64_((A), TT_OP_INT64_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_uint64(const char *file, int line, const char *aexpr,
                            tt_op_t op, const char *bexpr,
@@ -325,7 +329,7 @@ extern void tt_test_uint64(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_UINT64_GE(A, B)                       \
   TT_TEST_UINT64_((A), TT_OP_UINT64_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_double(const char *file, int line, const char *aexpr,
                            tt_op_t op, const char *bexpr, double a,
@@ -380,7 +384,7 @@ extern void tt_test_double(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_DOUBLE_GE(A, B)                       \
   TT_TEST_DOUBLE_((A), TT_OP_DOUBLE_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_str(const char *file, int line, const char *aexpr,
                         tt_op_t op, const char *bexpr, const char *a,
@@ -435,7 +439,7 @@ extern void tt_test_str(const char *file, int line, const char *aexpr,
 #define TT_ASSERT_STR_GE(A, B)                  \
   TT_TEST_STR_((A), TT_OP_STR_GE, (B), TT_TRUE)
 
-#ifdef _MSC_VER
+#if defined(_MSC_VER) || defined(__cplusplus)
 
 extern void tt_test_ptr(const char *file, int line, const char *aexpr,
                         tt_op_t op, const char *bexpr, const void *a,
@@ -535,4 +539,8 @@ extern void tt_test_ptr(const char *file, int line, const char *aexpr,
 #define TT_SUITE_NUM_FAILURES(S)                \
   __suite__ ## S->num_failures
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // __tinytest_h